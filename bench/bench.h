@@ -0,0 +1,65 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_BENCH_H
+#define REDIS_BENCH_H
+
+// For steady_clock
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rd {
+namespace bench {
+
+struct Case {
+  std::string name;
+  std::function<void()> fn;
+};
+
+inline std::vector<Case> &registry() {
+  static std::vector<Case> cases;
+  return cases;
+}
+
+struct Registrar {
+  Registrar(const char *name, std::function<void()> fn) {
+    registry().push_back({name, std::move(fn)});
+  }
+};
+
+// Keeps the optimizer from discarding a computed value.
+template<class T>
+inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs fn(i) for i in [0, n) and prints the mean cost of one call.
+template<class Fn>
+double measure(const char *label, size_t n, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; i++) {
+    fn(i);
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  double ns = elapsed.count() / static_cast<double>(n ? n : 1);
+  std::printf("  %-40s %12.2f ns/op\n", label, ns);
+  return ns;
+}
+
+}  // namespace bench
+}  // namespace rd
+
+#define RD_BENCH_CONCAT_(a, b) a##b
+#define RD_BENCH_CONCAT(a, b) RD_BENCH_CONCAT_(a, b)
+#define BENCHMARK(group, name)                                        \
+  static void group##_##name();                                       \
+  static rd::bench::Registrar RD_BENCH_CONCAT(group##_##name, _reg)(  \
+      #group "." #name, group##_##name);                              \
+  static void group##_##name()
+
+#endif //REDIS_BENCH_H
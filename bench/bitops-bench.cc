@@ -0,0 +1,118 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <cstring>
+#include <random>
+#include <string>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const size_t kMB = 1024 * 1024;
+const size_t kSizes[] = {1 * kMB, 16 * kMB, 128 * kMB, 512 * kMB};
+// Every measurement walks about this many bytes in total.
+const size_t kBytesPerCase = 1024 * kMB;
+
+const char *levelName(rd::simd::Level level) {
+  switch (level) {
+    case rd::simd::Level::kScalar: return "scalar";
+    case rd::simd::Level::kSSE2: return "sse2";
+    default: return "avx2";
+  }
+}
+const rd::simd::Level kLevels[] = {
+    rd::simd::Level::kScalar, rd::simd::Level::kSSE2, rd::simd::Level::kAVX2};
+
+rd::String randomBitmap(size_t n, unsigned seed) {
+  std::mt19937_64 gen(seed);
+  rd::String s;
+  s.resize(n);
+  for (size_t i = 0; i + 8 <= n; i += 8) {
+    uint64_t word = gen();
+    memcpy(s.begin() + i, &word, sizeof(word));
+  }
+  return s;
+}
+
+std::string sizeLabel(const char *name, const char *level, size_t n) {
+  return std::string(name) + " " + level + " " + std::to_string(n / kMB) +
+      " MB";
+}
+
+void throughput(size_t n, double ns) {
+  std::printf("  %-40s %12.2f GB/s\n", "  throughput", n / ns);
+}
+
+// The byte-at-a-time table loop BITCOUNT would otherwise be.
+size_t byteLoopCount(const char *s, size_t n) {
+  static unsigned char table[256];
+  if (table[255] == 0) {
+    for (int i = 0; i < 256; i++) {
+      table[i] = static_cast<unsigned char>(__builtin_popcount(i));
+    }
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += table[static_cast<unsigned char>(s[i])];
+  }
+  return count;
+}
+}
+
+BENCHMARK(bitops, bitcount) {
+  rd::simd::Level best = rd::simd::level();
+  for (size_t n : kSizes) {
+    rd::String bitmap = randomBitmap(n, 1);
+    size_t rounds = kBytesPerCase / n;
+    std::string label = sizeLabel("byte loop", "table", n);
+    throughput(n, rd::bench::measure(label.c_str(), rounds, [&](size_t) {
+      rd::bench::doNotOptimize(byteLoopCount(bitmap.data(), n));
+    }));
+    for (rd::simd::Level level : kLevels) {
+      if (!rd::simd::setLevel(level)) { continue; }
+      label = sizeLabel("bitCount", levelName(level), n);
+      throughput(n, rd::bench::measure(label.c_str(), rounds, [&](size_t) {
+        rd::bench::doNotOptimize(rd::bitCount(bitmap));
+      }));
+    }
+    rd::simd::setLevel(best);
+    label = sizeLabel("bitCount range 1/4..3/4", levelName(best), n);
+    auto from = static_cast<long long>(n / 4), to = from * 3;
+    throughput(n / 2, rd::bench::measure(label.c_str(), rounds, [&](size_t) {
+      rd::bench::doNotOptimize(rd::bitCount(bitmap, from, to));
+    }));
+  }
+}
+
+BENCHMARK(bitops, bitop) {
+  rd::simd::Level best = rd::simd::level();
+  for (size_t n : kSizes) {
+    rd::String a = randomBitmap(n, 1), b = randomBitmap(n, 2), dest;
+    // dest keeps its buffer across calls; the first round pays the page
+    // faults.
+    size_t rounds = kBytesPerCase / n / 2 + 1;
+    for (rd::simd::Level level : kLevels) {
+      if (!rd::simd::setLevel(level)) { continue; }
+      std::string label = sizeLabel("bitOp AND a b", levelName(level), n);
+      throughput(2 * n, rd::bench::measure(label.c_str(), rounds,
+                                           [&](size_t) {
+        rd::bitOp(rd::BitOp::kAnd, dest, {a, b});
+        rd::bench::doNotOptimize(dest.data());
+      }));
+    }
+    rd::simd::setLevel(best);
+  }
+}
+
+BENCHMARK(bitops, bitpos) {
+  for (size_t n : {1 * kMB, 128 * kMB}) {
+    rd::String bitmap;
+    rd::setBit(bitmap, n * 8 - 1, 1);
+    std::string label = sizeLabel("bitPos 1 (last bit)", "words", n);
+    throughput(n, rd::bench::measure(label.c_str(), kBytesPerCase / n,
+                                     [&](size_t) {
+      rd::bench::doNotOptimize(rd::bitPos(bitmap, 1));
+    }));
+  }
+}
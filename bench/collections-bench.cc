@@ -0,0 +1,83 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const int kObjects = 100000;
+const size_t kRounds = 2000000;
+const char *kFields[] = {"name", "email", "created"};
+const char *kValues[] = {"alice", "alice@example.com", "1700000000"};
+
+// Thresholds of 0: every collection converts on its first insert.
+rd::EncodingConfig nodesOnly() {
+  rd::EncodingConfig config;
+  config.hash_max_listpack_entries = config.hash_max_listpack_value = 0;
+  config.set_max_intset_entries = 0;
+  config.zset_max_listpack_entries = config.zset_max_listpack_value = 0;
+  config.list_max_listpack_entries = config.list_max_listpack_value = 0;
+  return config;
+}
+
+// Bytes of usedMemory() per object for kObjects collections of three
+// elements each, built by fill, with the default thresholds and with
+// nodesOnly(). sizeof(T) counts too, as a keyspace would hold it.
+template<class T, class Fill>
+void bytesPerObject(const char *label, Fill fill) {
+  double bytes[2];
+  for (int forced = 0; forced < 2; forced++) {
+    rd::EncodingConfig saved = rd::encodingConfig();
+    if (forced) { rd::encodingConfig() = nodesOnly(); }
+    size_t base = rd::usedMemory();
+    {
+      std::vector<T> objects(kObjects);
+      for (T &object : objects) { fill(object); }
+      bytes[forced] = static_cast<double>(rd::usedMemory() - base) / kObjects
+          + sizeof(T);
+    }
+    rd::encodingConfig() = saved;
+  }
+  std::printf("  %-24s %8.0f B/object compact  %8.0f B/object nodes\n",
+              label, bytes[0], bytes[1]);
+}
+}  // namespace
+
+// Memory of small collections in their compact encoding against the one
+// they convert to. usedMemory() counts requested bytes, so malloc's own
+// per-allocation overhead, which hits the node encodings hardest, comes
+// on top.
+BENCHMARK(collections, memory) {
+  bytesPerObject<rd::HashType>("hash, 3 fields", [](rd::HashType &hash) {
+    for (int i = 0; i < 3; i++) { hash.set(kFields[i], kValues[i]); }
+  });
+  bytesPerObject<rd::SetType>("set, 3 integers", [](rd::SetType &set) {
+    for (const char *member : {"1001", "1002", "1003"}) { set.add(member); }
+  });
+  bytesPerObject<rd::ZSetType>("zset, 3 members", [](rd::ZSetType &zset) {
+    for (int i = 0; i < 3; i++) { zset.add(kFields[i], i * 1.5); }
+  });
+  bytesPerObject<rd::ListType>("list, 3 elements", [](rd::ListType &list) {
+    for (const char *value : kValues) { list.pushBack(value); }
+  });
+}
+
+// Field lookups in a three-field hash in either encoding.
+BENCHMARK(collections, hget) {
+  rd::HashType compact, nodes;
+  rd::EncodingConfig saved = rd::encodingConfig();
+  for (int i = 0; i < 3; i++) { compact.set(kFields[i], kValues[i]); }
+  rd::encodingConfig() = nodesOnly();
+  for (int i = 0; i < 3; i++) { nodes.set(kFields[i], kValues[i]); }
+  rd::encodingConfig() = saved;
+  rd::String value;
+  rd::bench::measure("HashType::get, listpack", kRounds, [&](size_t i) {
+    rd::bench::doNotOptimize(compact.get(kFields[i % 3], &value));
+  });
+  rd::bench::measure("HashType::get, dict", kRounds, [&](size_t i) {
+    rd::bench::doNotOptimize(nodes.get(kFields[i % 3], &value));
+  });
+}
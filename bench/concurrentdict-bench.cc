@@ -0,0 +1,82 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For steady_clock
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const int kKeys = 1000000;
+const size_t kOps = 4000000;
+const int kThreadCounts[] = {1, 2, 4, 8, 16, 32, 64};
+
+// Splits kOps between threads running op(thread, i) and prints the
+// aggregate throughput.
+template<class Op>
+void throughput(const char *label, int threads, Op op) {
+  std::vector<std::thread> workers;
+  size_t per_thread = kOps / threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&op, t, per_thread] {
+      for (size_t i = 0; i < per_thread; i++) { op(t, i); }
+    });
+  }
+  for (std::thread &worker : workers) { worker.join(); }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::printf("  %-28s %2d threads %10.2f Mops/s\n", label, threads,
+              per_thread * threads / elapsed.count() / 1e6);
+}
+
+// A key scattered over [0, kKeys) by thread and op index.
+int keyOf(int thread, size_t i) {
+  return static_cast<int>((i * 2654435761ULL + thread * 40503ULL) % kKeys);
+}
+}
+
+// 95% lookups and 5% overwrites of 1M int keys from 1 to 64 threads:
+// one Dict behind a mutex against a 64-shard ConcurrentDict.
+BENCHMARK(concurrentdict, throughput) {
+  rd::Dict<int, int> global;
+  std::mutex global_lock;
+  rd::ConcurrentDict<int, int> sharded;
+  for (int i = 0; i < kKeys; i++) {
+    global.add(i, i);
+    sharded.add(i, i);
+  }
+  global.rehashMilliseconds(1000);
+  sharded.cron(1000);
+  for (int threads : kThreadCounts) {
+    throughput("Dict + mutex", threads, [&](int t, size_t i) {
+      std::lock_guard<std::mutex> lock(global_lock);
+      if (i % 20 == 0) {
+        global.replace(keyOf(t, i), 0);
+      } else {
+        rd::bench::doNotOptimize(global.get(keyOf(t, i))->value);
+      }
+    });
+    throughput("ConcurrentDict", threads, [&](int t, size_t i) {
+      if (i % 20 == 0) {
+        sharded.replace(keyOf(t, i), 0);
+      } else {
+        int value;
+        sharded.get(keyOf(t, i), &value);
+        rd::bench::doNotOptimize(value);
+      }
+    });
+    throughput("ConcurrentDict getMany x16", threads, [&](int t, size_t i) {
+      if (i % 16 != 0) { return; }
+      int keys[16], values[16];
+      bool found[16];
+      for (int j = 0; j < 16; j++) { keys[j] = keyOf(t, i + j); }
+      sharded.getMany(keys, 16, values, found);
+      rd::bench::doNotOptimize(values[0]);
+    });
+  }
+}
@@ -0,0 +1,352 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For sort
+#include <algorithm>
+// For steady_clock
+#include <chrono>
+// For getenv
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const int kKeys = 100000;
+const size_t kRounds = 1000000;
+}
+
+BENCHMARK(dict, variant) {
+  rd::Dict<rd::Var, rd::Var> vars;
+  rd::Dict<int, int> ints;
+  for (int i = 0; i < kKeys; i++) {
+    vars.add(rd::Var(i), rd::Var(i));
+    ints.add(i, i);
+  }
+  vars.rehashMilliseconds(1000);
+  ints.rehashMilliseconds(1000);
+  rd::bench::measure("Dict<Var, Var>::get", kRounds, [&](size_t i) {
+    rd::bench::doNotOptimize(vars.get(rd::Var(static_cast<int>(i % kKeys))));
+  });
+  rd::bench::measure("Dict<int, int>::get", kRounds, [&](size_t i) {
+    rd::bench::doNotOptimize(ints.get(static_cast<int>(i % kKeys)));
+  });
+}
+
+BENCHMARK(dict, strings) {
+  rd::Dict<rd::String, int> strings;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kKeys; i++) {
+    keys.push_back("key:" + std::to_string(i) + ":with-some-tail");
+    strings.add(rd::String(keys.back().c_str()), i);
+  }
+  strings.rehashMilliseconds(1000);
+  rd::bench::measure("get(String(raw)) (temporary key)", kRounds,
+                     [&](size_t i) {
+    const std::string &key = keys[i % kKeys];
+    rd::bench::doNotOptimize(
+        strings.get(rd::String(key.data(), key.size())));
+  });
+  rd::bench::measure("get(StringView(raw)) (heterogeneous)", kRounds,
+                     [&](size_t i) {
+    const std::string &key = keys[i % kKeys];
+    rd::bench::doNotOptimize(
+        strings.get(rd::StringView(key.data(), key.size())));
+  });
+}
+
+BENCHMARK(dict, churn) {
+  const int n = 1000000;
+  rd::Dict<int, int> ints;
+  rd::bench::measure("add 1M ints", n, [&](size_t i) {
+    ints.add(static_cast<int>(i), 0);
+  });
+  rd::bench::measure("remove 1M ints", n, [&](size_t i) {
+    ints.remove(static_cast<int>(i));
+  });
+  // Keeps ~64k live entries while old ones are freed and new ones made.
+  rd::bench::measure("add + remove, 64k live", n, [&](size_t i) {
+    ints.add(static_cast<int>(i), 0);
+    if (i >= 65536) { ints.remove(static_cast<int>(i - 65536)); }
+  });
+  std::pmr::monotonic_buffer_resource arena;
+  rd::Dict<int, int> bulk(&arena);
+  rd::bench::measure("add 1M ints, monotonic arena", n, [&](size_t i) {
+    bulk.add(static_cast<int>(i), 0);
+  });
+}
+
+namespace {
+
+// Counts the bytes a dict holds, for the memory-per-key figures.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t bytes = 0;
+
+ private:
+  void *do_allocate(size_t n, size_t align) override {
+    bytes += n;
+    return std::pmr::new_delete_resource()->allocate(n, align);
+  }
+  void do_deallocate(void *p, size_t n, size_t align) override {
+    bytes -= n;
+    std::pmr::new_delete_resource()->deallocate(p, n, align);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+// Times one engine with n keys, key(i) giving a probe for the i-th. The
+// memory figure counts the tables and entries, not what keys point to.
+template<class D, class KeyOf>
+void compareEngine(const char *engine, int n, KeyOf key) {
+  CountingResource counter;
+  D dict(&counter);
+  std::string prefix = std::string(engine) + " " + std::to_string(n) + " ";
+  // Lookups hop around the table instead of following insertion order.
+  auto scatter = [n](size_t i) {
+    return static_cast<int>(i * 2654435761ULL % static_cast<size_t>(n));
+  };
+  rd::bench::measure((prefix + "add").c_str(), n, [&](size_t i) {
+    dict.add(typename D::key_type(key(static_cast<int>(i))), 0);
+  });
+  dict.rehashMilliseconds(100000);
+  std::printf("  %-40s %12.2f B/key\n", (prefix + "memory").c_str(),
+              static_cast<double>(counter.bytes) / n);
+  rd::bench::measure((prefix + "get hit").c_str(), n, [&](size_t i) {
+    rd::bench::doNotOptimize(dict.get(key(scatter(i))));
+  });
+  rd::bench::measure((prefix + "get miss").c_str(), n, [&](size_t i) {
+    rd::bench::doNotOptimize(dict.get(key(n + scatter(i))));
+  });
+  rd::bench::measure((prefix + "remove").c_str(), n, [&](size_t i) {
+    dict.remove(key(scatter(i)));
+  });
+}
+
+}  // namespace
+
+// Dict against SwissDict from 1K to 10M keys. Set RD_BENCH_100M to add
+// a 100M-key round, which needs about 6 GB. std::hash<int> is the
+// identity, so consecutive ints fill Dict's buckets one each, its best
+// case; string keys hash like real keyspace names.
+BENCHMARK(dict, engines) {
+  std::vector<int> sizes = {1000, 100000, 10000000};
+  if (std::getenv("RD_BENCH_100M") != nullptr) { sizes.push_back(100000000); }
+  auto id = [](int i) { return i; };
+  for (int n : sizes) {
+    compareEngine<rd::Dict<int, int>>("chained int", n, id);
+    compareEngine<rd::SwissDict<int, int>>("swiss int", n, id);
+  }
+  // key:<i> in a static buffer: lookups and removes allocate nothing.
+  auto name = [](int i) {
+    static char buf[32];
+    return rd::StringView(buf, snprintf(buf, sizeof(buf), "key:%d", i));
+  };
+  for (int n : {1000, 100000, 1000000}) {
+    compareEngine<rd::Dict<rd::String, int>>("chained string", n, name);
+    compareEngine<rd::SwissDict<rd::String, int>>("swiss string", n, name);
+  }
+}
+
+// MGET-style lookups of random keys in a table far larger than the LLC.
+BENCHMARK(dict, getmany) {
+  const int n = 10000000;
+  const size_t kBatch = 64;
+  rd::Dict<int, int> ints;
+  for (int i = 0; i < n; i++) { ints.add(i, i); }
+  ints.rehashMilliseconds(100000);
+  std::vector<int> keys(kRounds);
+  for (size_t i = 0; i < kRounds; i++) {
+    keys[i] = static_cast<int>(i * 2654435761ULL % (2 * n));
+  }
+  rd::bench::measure("get, one key at a time", kRounds, [&](size_t i) {
+    rd::bench::doNotOptimize(ints.get(keys[i]));
+  });
+  std::vector<rd::Dict<int, int>::pointer> out(kBatch);
+  rd::bench::measure("getMany, 64 keys per call", kRounds, [&](size_t i) {
+    if (i % kBatch == 0) {
+      ints.getMany(&keys[i], kBatch, out.data());
+      rd::bench::doNotOptimize(out[0]);
+    }
+  });
+}
+
+namespace {
+
+// Fills d until a resize starts, then times moving every entry across.
+template<class D>
+void timeRehash(const char *label) {
+  D strings;
+  char buf[32];
+  for (int i = 0; !strings.isRehashing() || strings.size() < (1 << 20); i++) {
+    int len = snprintf(buf, sizeof(buf), "key:%d:with-some-tail", i);
+    strings.add(rd::String(buf, len), i);
+  }
+  rd::bench::measure(label, strings.size(), [&](size_t i) {
+    if (i == 0) { strings.rehashMilliseconds(100000); }
+  });
+}
+
+}  // namespace
+
+// Rehash cost per entry of 1M string keys, hashes cached or recomputed.
+BENCHMARK(dict, rehash) {
+  timeRehash<rd::Dict<rd::String, int, std::hash<rd::String>,
+                      std::equal_to<>, false>>("rehash, hashing keys");
+  timeRehash<rd::Dict<rd::String, int>>("rehash, cached hashes");
+}
+
+namespace {
+
+// Times ops one by one across the resize of a 4M-bucket table, a lookup
+// per op and an insert every fourth, and prints latency percentiles.
+void resizeLatency(const char *label, rd::RehashMode mode, size_t cron) {
+  const int n = (1 << 22) - 1;
+  const size_t kOps = 2000000;
+  rd::Dict<int, int> ints;
+  for (int i = 0; i < n; i++) { ints.add(i, i); }
+  ints.rehashMilliseconds(100000);
+  ints.setRehashMode(mode);
+  std::vector<double> ns(kOps);
+  int next = n;
+  size_t rehash_ops = 0;
+  for (size_t i = 0; i < kOps; i++) {
+    auto start = std::chrono::steady_clock::now();
+    if (i % 4 == 0) {
+      ints.add(next++, 0);
+    } else {
+      rd::bench::doNotOptimize(
+          ints.get(static_cast<int>(i * 2654435761ULL % n)));
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    ns[i] = elapsed.count();
+    if (ints.isRehashing()) { rehash_ops = i + 1; }
+    if (cron != 0 && i % cron == 0) { ints.rehashMicroseconds(1000); }
+  }
+  std::sort(ns.begin(), ns.end());
+  std::printf("  %-24s p50 %6.0f  p99 %6.0f  p99.9 %8.0f  max %10.0f ns, "
+              "rehash over %zu ops\n", label, ns[kOps / 2],
+              ns[kOps * 99 / 100], ns[kOps * 999 / 1000], ns.back(),
+              rehash_ops);
+}
+
+}  // namespace
+
+// Per-op latency while a 4M-entry dict doubles, by who moves buckets.
+// The cron variant spends 1 ms rehashing every 1000 ops, between ops.
+BENCHMARK(dict, resizelatency) {
+  resizeLatency("on access", rd::RehashMode::kOnAccess, 0);
+  resizeLatency("cron, 1 ms / 1000 ops", rd::RehashMode::kCron, 1000);
+  resizeLatency("helper thread", rd::RehashMode::kThread, 0);
+}
+
+// Sampling cost on a dense 1M-entry table and on the same table with
+// 99% of its entries removed.
+BENCHMARK(dict, sample) {
+  const int n = 1000000;
+  rd::Dict<int, int> ints;
+  for (int i = 0; i < n; i++) { ints.add(i, i); }
+  ints.rehashMilliseconds(1000);
+  rd::Dict<int, int>::pointer out[16];
+  rd::bench::measure("sampleEntries(16), dense", kRounds, [&](size_t) {
+    rd::bench::doNotOptimize(ints.sampleEntries(16, out));
+  });
+  rd::bench::measure("randomEntry, dense", kRounds, [&](size_t) {
+    rd::bench::doNotOptimize(ints.randomEntry());
+  });
+  for (int i = 0; i < n; i++) {
+    if (i % 100 != 0) { ints.remove(i); }
+  }
+  size_t got = 0;
+  rd::bench::measure("sampleEntries(16), 1% full", kRounds, [&](size_t) {
+    got += ints.sampleEntries(16, out);
+  });
+  std::printf("  %-40s %12.2f entries\n", "  mean sample size, 1% full",
+              static_cast<double>(got) / kRounds);
+  rd::bench::measure("randomEntry, 1% full (shrinks)", kRounds, [&](size_t) {
+    rd::bench::doNotOptimize(ints.randomEntry());
+  });
+}
+
+// A full sweep summing values, with scan and with scanParallel on 1 to
+// 16 threads, over 10M keys; set RD_BENCH_50M for 50M, about 3 GB. The
+// speedup is bounded by the cores of the machine and its memory
+// bandwidth: the sweep is one cache miss per bucket and per entry.
+BENCHMARK(dict, parallelscan) {
+  const int n = std::getenv("RD_BENCH_50M") != nullptr ? 50000000 : 10000000;
+  rd::Dict<int, int> ints;
+  for (int i = 0; i < n; i++) { ints.add(i, i); }
+  ints.rehashMilliseconds(100000);
+  auto report = [&](const std::string &label, double ms, long long sum) {
+    std::printf("  %-24s %8.0f ms  %8.1f M keys/s  (sum %lld)\n",
+                label.c_str(), ms, n / ms / 1000, sum);
+  };
+  auto start = std::chrono::steady_clock::now();
+  long long sum = 0;
+  rd::size_type cursor = 0;
+  do {
+    cursor = ints.scan(cursor, [&](rd::Dict<int, int>::pointer entry) {
+      sum += entry->value;
+    });
+  } while (cursor != 0);
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  report("scan", elapsed.count(), sum);
+  for (rd::size_type threads : {1, 2, 4, 16}) {
+    // One padded slot per worker: no false sharing between them.
+    struct alignas(64) Slot { long long sum = 0; };
+    std::vector<Slot> sums(threads);
+    start = std::chrono::steady_clock::now();
+    ints.scanParallel(threads, [&](rd::Dict<int, int>::pointer entry,
+                                   rd::size_type worker) {
+      sums[worker].sum += entry->value;
+    });
+    elapsed = std::chrono::steady_clock::now() - start;
+    sum = 0;
+    for (const Slot &slot : sums) { sum += slot.sum; }
+    report("scanParallel, " + std::to_string(threads) + " threads",
+           elapsed.count(), sum);
+  }
+}
+
+// Loading 10M unique keys into a fresh dict, as a restart does: add()
+// from kInitialSize, resizing and rehashing its way up, against
+// reserve() and addUnique(). Set RD_BENCH_80M for 80M keys, about 5 GB.
+BENCHMARK(dict, bulkload) {
+  const int n = std::getenv("RD_BENCH_80M") != nullptr ? 80000000 : 10000000;
+  auto report = [&](const char *label, double ms) {
+    std::printf("  %-24s %8.0f ms  %8.1f M keys/s\n", label, ms,
+                n / ms / 1000);
+  };
+  {
+    auto start = std::chrono::steady_clock::now();
+    rd::Dict<int, int> ints;
+    for (int i = 0; i < n; i++) { ints.add(i, i); }
+    ints.rehashMilliseconds(100000);
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    report("add", elapsed.count());
+  }
+  {
+    auto start = std::chrono::steady_clock::now();
+    rd::Dict<int, int> ints;
+    for (int i = 0; i < n; i++) { ints.addUnique(i, i); }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    report("addUnique", elapsed.count());
+  }
+  {
+    auto start = std::chrono::steady_clock::now();
+    rd::Dict<int, int> ints;
+    ints.reserve(n);
+    for (int i = 0; i < n; i++) { ints.addUnique(i, i); }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    report("reserve + addUnique", elapsed.count());
+  }
+}
@@ -0,0 +1,82 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+
+const int kKeys = 1000000;
+const size_t kRounds = 2000000;
+
+rd::String keyOf(int i) {
+  return rd::String(("key:" + std::to_string(i)).c_str());
+}
+
+void fill(rd::Db &db) {
+  std::string text(100, 'v');
+  for (int i = 0; i < kKeys; i++) {
+    db.set(keyOf(i).view(),
+           rd::Object::createString(rd::String(text.data(), text.size())));
+  }
+}
+
+// Drops maxmemory by a quarter of the keyspace's memory at once and calls
+// performEvictions until it is back under, timing each call.
+void overshoot(const char *label, size_t time_limit_us) {
+  rd::Db db;
+  size_t base = rd::usedMemory();
+  fill(db);
+  rd::MaxmemoryConfig config;
+  config.policy = rd::MaxmemoryPolicy::kAllKeysLru;
+  config.eviction_time_limit_us = time_limit_us;
+  config.maxmemory = rd::usedMemory() - (rd::usedMemory() - base) / 4;
+  db.setMaxmemory(config);
+  size_t calls = 0, keys = db.size();
+  double total = 0, longest = 0;
+  rd::EvictResult result;
+  do {
+    auto start = std::chrono::steady_clock::now();
+    result = db.performEvictions();
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    total += elapsed.count();
+    longest = std::max(longest, elapsed.count());
+    calls++;
+  } while (result == rd::EvictResult::kRunning);
+  keys -= db.size();
+  std::printf("  %-24s %zu keys in %zu calls, %8.0f us total, "
+              "longest call %8.0f us, %6.0f ns/key\n", label, keys, calls,
+              total, longest, total * 1000 / keys);
+}
+
+}  // namespace
+
+// Working off a large overshoot in one go versus in 500 us slices.
+BENCHMARK(evict, overshoot) {
+  overshoot("unbounded", 1000000000);
+  overshoot("500 us per call", 500);
+}
+
+// What a lookup pays to record the access, by policy.
+BENCHMARK(evict, lookup) {
+  rd::Db db;
+  fill(db);
+  rd::MaxmemoryConfig config;
+  const rd::MaxmemoryPolicy policies[] = {
+      rd::MaxmemoryPolicy::kAllKeysLru, rd::MaxmemoryPolicy::kAllKeysLfu};
+  const char *labels[] = {"lookup, LRU clock", "lookup, LFU counter"};
+  std::vector<rd::String> keys;
+  for (int i = 0; i < 1024; i++) { keys.push_back(keyOf(i * 977)); }
+  for (int p = 0; p < 2; p++) {
+    config.policy = policies[p];
+    db.setMaxmemory(config);
+    rd::bench::measure(labels[p], kRounds, [&](size_t i) {
+      rd::bench::doNotOptimize(db.lookup(keys[i % 1024].view()));
+    });
+  }
+}
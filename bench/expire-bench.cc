@@ -0,0 +1,67 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+
+const int kSessions = 1000000;
+
+rd::String keyOf(const char *prefix, int i) {
+  return rd::String((prefix + std::to_string(i)).c_str());
+}
+
+// 1M persistent keys and 1M session keys expiring over the next second,
+// then a server-like loop: a slow cycle every 100 ms tick, a fast cycle
+// every millisecond in between. Prints how long the sessions took to be
+// reclaimed and what the cycles cost; skipped fast cycles count towards
+// the latency percentiles.
+void sessions(const char *label, rd::size_type effort) {
+  rd::Db db;
+  long long now = rd::mstime();
+  for (int i = 0; i < kSessions; i++) {
+    db.set(keyOf("user:", i).view(), rd::Object::createInt(i));
+    db.set(keyOf("session:", i).view(), rd::Object::createInt(i));
+    db.setExpire(keyOf("session:", i).view(), now + i % 1000);
+  }
+  rd::ExpireConfig config;
+  config.effort = effort;
+  db.setExpireConfig(config);
+  using namespace std::chrono;
+  auto start = steady_clock::now(), tick = start;
+  std::vector<double> us;
+  while (!db.expires().empty()) {
+    auto cycle = steady_clock::now();
+    if (cycle - tick >= milliseconds(100)) {
+      tick = cycle;
+      db.activeExpireCycle(rd::ExpireCycle::kSlow);
+    } else {
+      db.activeExpireCycle(rd::ExpireCycle::kFast);
+    }
+    duration<double, std::micro> elapsed = steady_clock::now() - cycle;
+    us.push_back(elapsed.count());
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  duration<double, std::milli> total = steady_clock::now() - start;
+  const rd::ExpireStats &stats = db.expireStats();
+  std::sort(us.begin(), us.end());
+  std::printf("  %-10s reclaimed in %5.0f ms, %4zu cycles, %4zu capped, "
+              "p99 %6.0f us, max %6.0f us, %5.0f ns/key\n", label,
+              total.count(), stats.cycles, stats.time_cap_reached,
+              us[us.size() * 99 / 100], us.back(),
+              stats.cycle_us * 1000.0 / stats.expired_keys);
+}
+
+}  // namespace
+
+BENCHMARK(expire, sessions) {
+  sessions("effort 1", 1);
+  sessions("effort 10", 10);
+}
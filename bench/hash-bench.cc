@@ -0,0 +1,51 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <string>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const size_t kRounds = 2000000;
+const size_t kKeyLengths[] = {3, 8, 16, 32, 64, 256, 1024};
+
+template<class Fn>
+void perLength(const char *name, Fn fn) {
+  for (size_t len : kKeyLengths) {
+    std::string key(len, 'k');
+    std::string label = std::string(name) + " len=" + std::to_string(len);
+    double ns = rd::bench::measure(label.c_str(), kRounds, [&](size_t i) {
+      key[0] = static_cast<char>(i);
+      rd::bench::doNotOptimize(fn(key.data(), key.size()));
+    });
+    std::printf("  %-40s %12.2f GB/s\n", "  throughput", len / ns);
+  }
+}
+}
+
+BENCHMARK(hash, families) {
+  perLength("std::_Hash_impl (old)", [](const char *s, size_t n) {
+    return std::_Hash_impl::hash(s, n);
+  });
+  perLength("SipHash-2-4", [](const char *s, size_t n) {
+    return rd::sipHash<2, 4>(s, n, rd::hashSeed());
+  });
+  perLength("SipHash-1-2", [](const char *s, size_t n) {
+    return rd::SipHash12::hash(s, n);
+  });
+  perLength("WyHash", [](const char *s, size_t n) {
+    return rd::WyHash::hash(s, n);
+  });
+}
+
+BENCHMARK(hash, cached) {
+  rd::HashedString key(std::string(64, 'k').c_str());
+  rd::String raw(key.str());
+  rd::bench::measure("std::hash<String> len=64", kRounds, [&](size_t) {
+    rd::bench::doNotOptimize(std::hash<rd::String>()(raw));
+  });
+  rd::bench::measure("std::hash<HashedString> len=64", kRounds, [&](size_t) {
+    rd::bench::doNotOptimize(std::hash<rd::HashedString>()(key));
+  });
+}
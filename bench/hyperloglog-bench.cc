@@ -0,0 +1,94 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const size_t kRounds = 1000000;
+
+const char *levelName(rd::simd::Level level) {
+  switch (level) {
+    case rd::simd::Level::kScalar: return "scalar";
+    case rd::simd::Level::kSSE2: return "sse2";
+    default: return "avx2";
+  }
+}
+const rd::simd::Level kLevels[] = {
+    rd::simd::Level::kScalar, rd::simd::Level::kAVX2};
+
+std::vector<std::string> elements(size_t from, size_t n) {
+  std::vector<std::string> out;
+  for (size_t i = from; i < from + n; i++) {
+    out.push_back("user:" + std::to_string(i));
+  }
+  return out;
+}
+
+rd::String counter(size_t from, size_t n) {
+  rd::String hll;
+  for (const std::string &e : elements(from, n)) {
+    rd::pfAdd(hll, {e.c_str()});
+  }
+  return hll;
+}
+}
+
+BENCHMARK(hyperloglog, pfadd) {
+  std::vector<std::string> keys = elements(0, kRounds);
+  rd::String sparse;
+  rd::bench::measure("pfAdd sparse (first 200 elements)", 200, [&](size_t i) {
+    rd::pfAdd(sparse, {keys[i].c_str()});
+  });
+  rd::String dense = counter(kRounds, 100000);
+  rd::bench::measure("pfAdd dense", kRounds, [&](size_t i) {
+    rd::pfAdd(dense, {keys[i].c_str()});
+  });
+  std::printf("  %-40s %12zu bytes\n", "dense counter size", dense.size());
+}
+
+BENCHMARK(hyperloglog, pfcount) {
+  rd::String dense = counter(0, 100000);
+  rd::String sparse = counter(0, 500);
+  uint64_t card;
+  rd::bench::measure("pfCount cached", kRounds, [&](size_t) {
+    rd::pfCount(dense, &card);
+    rd::bench::doNotOptimize(card);
+  });
+  // The union path never uses the cache, so it shows the full estimate.
+  rd::String empty;
+  rd::bench::measure("pfCount union of 1 dense", kRounds / 100, [&](size_t) {
+    rd::pfCount({dense, empty}, &card);
+    rd::bench::doNotOptimize(card);
+  });
+  rd::bench::measure("pfCount union of 1 sparse", kRounds / 100,
+                     [&](size_t) {
+    rd::pfCount({sparse, empty}, &card);
+    rd::bench::doNotOptimize(card);
+  });
+}
+
+BENCHMARK(hyperloglog, pfmerge) {
+  rd::simd::Level best = rd::simd::level();
+  rd::String a = counter(0, 100000), b = counter(50000, 100000);
+  for (rd::simd::Level level : kLevels) {
+    if (!rd::simd::setLevel(level)) { continue; }
+    std::string label = std::string("pfCount union of 2 dense ") +
+        levelName(level);
+    rd::bench::measure(label.c_str(), kRounds / 100, [&](size_t) {
+      uint64_t card;
+      rd::pfCount({a, b}, &card);
+      rd::bench::doNotOptimize(card);
+    });
+    label = std::string("pfMerge 2 dense ") + levelName(level);
+    rd::bench::measure(label.c_str(), kRounds / 100, [&](size_t) {
+      rd::String dest;
+      rd::pfMerge(dest, {a, b});
+      rd::bench::doNotOptimize(dest.data());
+    });
+  }
+  rd::simd::setLevel(best);
+}
@@ -0,0 +1,151 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const size_t kLookups = 2000000;
+
+const char *levelName(rd::simd::Level level) {
+  switch (level) {
+    case rd::simd::Level::kScalar: return "scalar";
+    case rd::simd::Level::kSSE2: return "sse2";
+    default: return "avx2";
+  }
+}
+const rd::simd::Level kLevels[] = {
+    rd::simd::Level::kScalar, rd::simd::Level::kSSE2, rd::simd::Level::kAVX2};
+
+// n values in [0, range) shifted left by shift. Two sets of n drawn from
+// a range of 4n share about a fifth of their members, like tags over one
+// id space.
+std::vector<long long> randomIds(size_t n, size_t range, int shift,
+                                 unsigned seed) {
+  std::mt19937_64 gen(seed);
+  std::vector<long long> ids(n);
+  for (auto &id : ids) { id = static_cast<long long>(gen() % range) << shift; }
+  return ids;
+}
+
+// The members of ids as a Dict-encoded set, as SetType holds them past
+// set_max_intset_entries.
+std::unique_ptr<rd::SetType::dict_type> dictOf(
+    const std::vector<long long> &ids) {
+  auto dict = std::make_unique<rd::SetType::dict_type>();
+  char buf[rd::kLongStrSize];
+  for (long long id : ids) {
+    dict->add(rd::String(buf, rd::ll2string(buf, sizeof(buf), id)), true);
+  }
+  return dict;
+}
+
+// SINTER over Dict-encoded sets: every member of the smaller looked up in
+// the larger.
+size_t dictIntersect(rd::SetType::dict_type &small,
+                     rd::SetType::dict_type &large) {
+  size_t n = 0;
+  for (auto &entry : small) {
+    n += large.get(rd::StringView(entry.key)) != large.end();
+  }
+  return n;
+}
+
+void intersectCase(const char *name, size_t na, size_t nb, int shift) {
+  size_t range = 4 * (na > nb ? na : nb);
+  auto ids_a = randomIds(na, range, shift, 1);
+  auto ids_b = randomIds(nb, range, shift, 2);
+  rd::IntSet a(ids_a.data(), ids_a.size()), b(ids_b.data(), ids_b.size());
+  auto dict_a = dictOf(ids_a), dict_b = dictOf(ids_b);
+  size_t rounds = 20000000 / (na + nb) + 1;
+  std::printf("  %s: %zu and %zu members, %zu in common\n", name, a.size(),
+              b.size(), rd::IntSet::intersect(a, b).size());
+  std::string label = "dict probe";
+  rd::bench::measure(label.c_str(), rounds, [&](size_t) {
+    rd::bench::doNotOptimize(dictIntersect(*dict_a, *dict_b));
+  });
+  rd::simd::Level best = rd::simd::level();
+  for (rd::simd::Level level : kLevels) {
+    if (!rd::simd::setLevel(level)) { continue; }
+    label = std::string("IntSet::intersect ") + levelName(level);
+    rd::bench::measure(label.c_str(), rounds, [&](size_t) {
+      rd::bench::doNotOptimize(rd::IntSet::intersect(a, b).size());
+    });
+  }
+  rd::simd::setLevel(best);
+}
+}  // namespace
+
+// Membership in a 100K-member set of 32-bit ids, per lookup.
+BENCHMARK(intset, contains) {
+  auto ids = randomIds(100000, 400000, 0, 1);
+  rd::IntSet is(ids.data(), ids.size());
+  auto dict = dictOf(ids);
+  std::mt19937_64 gen(3);
+  std::vector<long long> keys(4096);
+  for (auto &key : keys) { key = static_cast<long long>(gen() % 400000); }
+  std::vector<rd::String> strings;
+  char buf[rd::kLongStrSize];
+  for (long long key : keys) {
+    strings.emplace_back(buf, rd::ll2string(buf, sizeof(buf), key));
+  }
+  rd::bench::measure("Dict::get", kLookups, [&](size_t i) {
+    rd::bench::doNotOptimize(dict->get(rd::StringView(strings[i % 4096])) !=
+                             dict->end());
+  });
+  rd::simd::Level best = rd::simd::level();
+  for (rd::simd::Level level : kLevels) {
+    if (!rd::simd::setLevel(level)) { continue; }
+    std::string label = std::string("IntSet::contains ") + levelName(level);
+    rd::bench::measure(label.c_str(), kLookups, [&](size_t i) {
+      rd::bench::doNotOptimize(is.contains(keys[i % 4096]));
+    });
+  }
+  rd::simd::setLevel(best);
+}
+
+// SINTER of similar sizes, where the merge runs in vector registers, and
+// of skewed sizes, where it gallops.
+BENCHMARK(intset, intersect) {
+  intersectCase("int32, similar", 100000, 100000, 0);
+  intersectCase("int32, similar", 1000000, 1000000, 0);
+  intersectCase("int64, similar", 100000, 100000, 33);
+  intersectCase("int32, skewed", 1000, 1000000, 0);
+  // Galloping against walking the large set: the merge kernel at 1:1000.
+  auto ids_a = randomIds(1000, 4000000, 0, 1);
+  auto ids_b = randomIds(1000000, 4000000, 0, 2);
+  rd::IntSet a(ids_a.data(), ids_a.size()), b(ids_b.data(), ids_b.size());
+  std::vector<int32_t> va, vb, out(a.size());
+  for (rd::size_type i = 0; i < a.size(); i++) { va.push_back(a.get(i)); }
+  for (rd::size_type i = 0; i < b.size(); i++) { vb.push_back(b.get(i)); }
+  rd::bench::measure("merge kernel, skewed", 200, [&](size_t) {
+    rd::bench::doNotOptimize(rd::simd::kernels().intersect32(
+        va.data(), va.size(), vb.data(), vb.size(), out.data()));
+  });
+}
+
+// SUNION and SDIFF of 100K-member sets.
+BENCHMARK(intset, algebra) {
+  auto ids_a = randomIds(100000, 400000, 0, 1);
+  auto ids_b = randomIds(100000, 400000, 0, 2);
+  rd::IntSet a(ids_a.data(), ids_a.size()), b(ids_b.data(), ids_b.size());
+  rd::bench::measure("IntSet::unite", 500, [&](size_t) {
+    rd::bench::doNotOptimize(rd::IntSet::unite(a, b).size());
+  });
+  rd::bench::measure("IntSet::difference", 500, [&](size_t) {
+    rd::bench::doNotOptimize(rd::IntSet::difference(a, b).size());
+  });
+  auto ids_c = randomIds(1000, 400000, 0, 3);
+  rd::IntSet c(ids_c.data(), ids_c.size());
+  rd::bench::measure("IntSet::difference, 100K minus 1K", 5000, [&](size_t) {
+    rd::bench::doNotOptimize(rd::IntSet::difference(a, c).size());
+  });
+  rd::bench::measure("IntSet::difference, 1K minus 100K", 5000, [&](size_t) {
+    rd::bench::doNotOptimize(rd::IntSet::difference(c, a).size());
+  });
+}
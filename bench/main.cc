@@ -0,0 +1,18 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <cstring>
+#include "bench.h"
+
+// Usage: redis_bench [filter]
+// Runs every registered benchmark whose name contains filter.
+int main(int argc, char **argv) {
+  const char *filter = argc > 1 ? argv[1] : "";
+  for (const rd::bench::Case &c : rd::bench::registry()) {
+    if (strstr(c.name.c_str(), filter) == nullptr) { continue; }
+    std::printf("%s\n", c.name.c_str());
+    c.fn();
+  }
+  return 0;
+}
@@ -0,0 +1,43 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <string>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const size_t kRounds = 2000000;
+}
+
+BENCHMARK(object, incr) {
+  rd::String text("100000");
+  rd::bench::measure("INCR on String (parse + format)", kRounds,
+                     [&](size_t) {
+    long long value;
+    rd::string2ll(text.data(), text.size(), &value);
+    char buf[rd::kLongStrSize];
+    size_t len = rd::ll2string(buf, sizeof(buf), value + 1);
+    text.assign(buf, len);
+  });
+  rd::Object *obj = rd::Object::createInt(100000);
+  rd::bench::measure("INCR on int-encoded Object", kRounds, [&](size_t) {
+    rd::Object::incrBy(obj, 1);
+  });
+  rd::bench::doNotOptimize(obj);
+  obj->decrRef();
+}
+
+BENCHMARK(object, create) {
+  rd::bench::measure("createString(\"1234\") (shared pool)", kRounds,
+                     [&](size_t) {
+    rd::Object *obj = rd::Object::createString("1234");
+    rd::bench::doNotOptimize(obj);
+    obj->decrRef();
+  });
+  rd::bench::measure("createString(\"123456\")", kRounds, [&](size_t) {
+    rd::Object *obj = rd::Object::createString("123456");
+    rd::bench::doNotOptimize(obj);
+    obj->decrRef();
+  });
+}
@@ -0,0 +1,152 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "redis.h"
+
+namespace {
+const size_t kRounds = 1000000;
+const size_t kKeyLengths[] = {3, 8, 16, 22, 32, 64};
+}
+
+BENCHMARK(sds, construct) {
+  for (size_t len : kKeyLengths) {
+    std::string raw(len, 'k');
+    std::string label = "String(const char *) len=" + std::to_string(len);
+    rd::bench::measure(label.c_str(), kRounds, [&](size_t) {
+      rd::String s(raw.c_str());
+      rd::bench::doNotOptimize(s.data());
+    });
+  }
+}
+
+BENCHMARK(sds, copy) {
+  for (size_t len : kKeyLengths) {
+    rd::String origin(std::string(len, 'k').c_str());
+    std::string label = "String(const String &) len=" + std::to_string(len);
+    rd::bench::measure(label.c_str(), kRounds, [&](size_t) {
+      rd::String s(origin);
+      rd::bench::doNotOptimize(s.data());
+    });
+  }
+}
+
+BENCHMARK(sds, append) {
+  rd::String piece("abc");
+  rd::bench::measure("append 3 bytes x 8", kRounds, [&](size_t) {
+    rd::String s;
+    for (int i = 0; i < 8; i++) { s += piece; }
+    rd::bench::doNotOptimize(s.data());
+  });
+}
+
+BENCHMARK(sds, footprint) {
+  std::printf("  %-40s %12zu bytes\n", "sizeof(String)", sizeof(rd::String));
+}
+
+BENCHMARK(sds, concat) {
+  rd::String a(std::string(30, 'a').c_str()), b(std::string(30, 'b').c_str()),
+      c(std::string(30, 'c').c_str());
+  rd::bench::measure("a + b + c", kRounds, [&](size_t) {
+    rd::String s = a + b + c;
+    rd::bench::doNotOptimize(s.data());
+  });
+  rd::bench::measure("concat(a, b, c)", kRounds, [&](size_t) {
+    rd::String s = rd::concat(a, b, c);
+    rd::bench::doNotOptimize(s.data());
+  });
+}
+
+BENCHMARK(sds, list) {
+  rd::String value(std::string(64, 'v').c_str());
+  rd::bench::measure("List<String>::pushBack(String &&)", kRounds,
+                     [&](size_t) {
+    rd::List<rd::String> l;
+    rd::String s(value);
+    l.pushBack(std::move(s));
+    rd::bench::doNotOptimize(l.size());
+  });
+}
+
+namespace {
+const char *levelName(rd::simd::Level level) {
+  switch (level) {
+    case rd::simd::Level::kScalar: return "scalar";
+    case rd::simd::Level::kSSE2: return "sse2";
+    default: return "avx2";
+  }
+}
+const rd::simd::Level kLevels[] = {
+    rd::simd::Level::kScalar, rd::simd::Level::kSSE2, rd::simd::Level::kAVX2};
+}
+
+BENCHMARK(sds, equal) {
+  rd::simd::Level best = rd::simd::level();
+  for (rd::simd::Level level : kLevels) {
+    if (!rd::simd::setLevel(level)) { continue; }
+    for (size_t len : {8, 32, 256, 4096}) {
+      std::string raw(len, 'k');
+      rd::String a(raw.c_str()), b(raw.c_str());
+      std::string label = std::string("operator== ") + levelName(level) +
+          " len=" + std::to_string(len);
+      rd::bench::measure(label.c_str(), kRounds, [&](size_t) {
+        rd::bench::doNotOptimize(a == b);
+      });
+    }
+  }
+  rd::simd::setLevel(best);
+}
+
+BENCHMARK(sds, find) {
+  rd::simd::Level best = rd::simd::level();
+  std::string raw;
+  for (int i = 0; i < 4096; i++) { raw += static_cast<char>('a' + i % 26); }
+  rd::String haystack(raw.c_str());
+  for (rd::simd::Level level : kLevels) {
+    if (!rd::simd::setLevel(level)) { continue; }
+    std::string label = std::string("find(\"zz\") 4 KB ") + levelName(level);
+    rd::bench::measure(label.c_str(), kRounds / 10, [&](size_t) {
+      rd::bench::doNotOptimize(haystack.find("zz"));
+    });
+    label = std::string("find('#') 4 KB ") + levelName(level);
+    rd::bench::measure(label.c_str(), kRounds / 10, [&](size_t) {
+      rd::bench::doNotOptimize(haystack.find('#'));
+    });
+  }
+  rd::simd::setLevel(best);
+}
+
+BENCHMARK(sds, trim) {
+  rd::simd::Level best = rd::simd::level();
+  std::string pad(200, ' ');
+  std::string raw = pad + "value" + pad;
+  for (rd::simd::Level level : kLevels) {
+    if (!rd::simd::setLevel(level)) { continue; }
+    std::string label = std::string("trim 200 + 200 pad ") + levelName(level);
+    rd::String s;
+    rd::bench::measure(label.c_str(), kRounds / 10, [&](size_t) {
+      s.assign(raw.c_str());
+      s.trim(" \t\r\n");
+      rd::bench::doNotOptimize(s.data());
+    });
+  }
+  rd::simd::setLevel(best);
+}
+
+BENCHMARK(sds, fanout) {
+  // One 64 KB value handed to the keyspace, a reply and a backlog.
+  rd::String value(std::string(64 * 1024, 'v').c_str());
+  rd::bench::measure("String copy x3 (64 KB)", kRounds / 100, [&](size_t) {
+    rd::String keyspace(value), reply(value), backlog(value);
+    rd::bench::doNotOptimize(backlog.data());
+  });
+  rd::SharedString shared{rd::String(value)};
+  rd::bench::measure("SharedString copy x3 (64 KB)", kRounds / 100,
+                     [&](size_t) {
+    rd::SharedString keyspace(shared), reply(shared), backlog(shared);
+    rd::bench::doNotOptimize(backlog.data());
+  });
+}
@@ -7,11 +7,14 @@
 
 // For std::find
 #include <algorithm>
+// For std::move
+#include <utility>
 #include "common.h"
+#include "zmalloc.h"
 
 namespace rd {
 template<class T>
-class _ListNode {
+class _ListNode : public ZmallocNew {
  public:
   _ListNode *prev;
   _ListNode *next;
@@ -82,7 +85,7 @@ class _ListConstIterator {
 };
 
 template<class T>
-class List {
+class List : public ZmallocNew {
  public:
   typedef T value_type;
   typedef _ListIterator<T> iterator;
@@ -106,6 +109,7 @@ class List {
   void listAux(InIt first, InIt last, std::__false_type);
   void listAux(size_type n, const_reference val, std::__true_type);
   void addNode(link_type node, const_reference val);
+  void addNode(link_type node, value_type &&val);
   link_type removeNode(link_type node);
   link_type eraseRange(link_type first, link_type last);
 
@@ -134,7 +138,9 @@ class List {
   const { return const_reverse_iterator(rend()); }
 
   void pushBack(const_reference val);
+  void pushBack(value_type &&val);
   void pushFront(const_reference val);
+  void pushFront(value_type &&val);
   value_type popBack();
   value_type popFront();
 
@@ -181,6 +187,13 @@ void List<T>::addNode(List::link_type node, const_reference val) {
   len_++;
 }
 template<class T>
+void List<T>::addNode(List::link_type node, value_type &&val) {
+  auto pNode = new _ListNode<T>(std::move(val), node->prev, node);
+  node->prev->next = pNode;
+  node->prev = pNode;
+  len_++;
+}
+template<class T>
 typename List<T>::link_type List<T>::removeNode(List::link_type node) {
   link_type next = node->next;
   link_type prev = node->prev;
@@ -250,18 +263,26 @@ void List<T>::pushBack(const_reference val) {
   addNode(tail_, val);
 }
 template<class T>
+void List<T>::pushBack(value_type &&val) {
+  addNode(tail_, std::move(val));
+}
+template<class T>
 void List<T>::pushFront(const_reference val) {
   addNode(tail_->next, val);
 }
 template<class T>
+void List<T>::pushFront(value_type &&val) {
+  addNode(tail_->next, std::move(val));
+}
+template<class T>
 typename List<T>::value_type List<T>::popBack() {
-  value_type val = tail_->prev->value;
+  value_type val = std::move(tail_->prev->value);
   removeNode(tail_->prev);
   return val;
 }
 template<class T>
 typename List<T>::value_type List<T>::popFront() {
-  value_type val = tail_->next->value;
+  value_type val = std::move(tail_->next->value);
   removeNode(tail_->next);
   return val;
 }
@@ -292,8 +313,7 @@ typename List<T>::iterator List<T>::search(const_reference val) {
 }
 template<class T>
 void List<T>::rotate() {
-  value_type val = popBack();
-  pushFront(val);
+  pushFront(popBack());
 }
 template<class T>
 bool List<T>::empty() const {
@@ -324,7 +344,7 @@ List<T> &List<T>::operator=(const List &list) {
 
 template<class T>
 _ListNode<T>::_ListNode(T val, _ListNode *pv, _ListNode *nt)
-    : value(val), prev(pv), next(nt) {}
+    : value(std::move(val)), prev(pv), next(nt) {}
 
 template<class T>
 typename _ListIterator<T>::pointer _ListIterator<T>::operator->() {
@@ -0,0 +1,49 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_BITOPS_H
+#define REDIS_BITOPS_H
+
+// For initializer_list
+#include <initializer_list>
+#include "sds.h"
+
+namespace rd {
+
+// Bitmaps are plain Strings. Bit 0 is the most significant bit of the
+// first byte, as in Redis, so a bitmap reads left to right.
+
+// SETBIT refuses offsets past 512 MB worth of bits, like proto-max-bulk-len.
+const size_t kMaxBitmapSize = 512ull * 1024 * 1024;
+
+enum class BitOp { kAnd, kOr, kXor, kNot };
+
+// Set the bit at offset to on (0 or 1), growing the bitmap with zeros as
+// needed. Returns the previous bit, or -1 when offset is out of range.
+int setBit(String &bitmap, size_t offset, int on);
+// Bits past the end read as 0.
+int getBit(StringView bitmap, size_t offset);
+
+// Set bits in the whole bitmap, or in the inclusive byte range
+// [start, end]; negative indices count from the end.
+size_t bitCount(StringView bitmap);
+size_t bitCount(StringView bitmap, long long start, long long end);
+
+// Position of the first bit equal to bit, or -1. Without an end, a
+// search for 0 in an all-ones bitmap reports the first bit past the end,
+// since the string is conceptually padded with zeros; with an explicit
+// end it reports -1 instead.
+long long bitPos(StringView bitmap, int bit);
+long long bitPos(StringView bitmap, int bit, long long start);
+long long bitPos(StringView bitmap, int bit, long long start, long long end);
+
+// dest = srcs[0] op srcs[1] op ..., shorter inputs padded with zeros; NOT
+// takes exactly one source. dest may alias a source. Returns the length
+// of dest, or -1 when NOT gets more than one source.
+long long bitOp(BitOp op, String &dest, const StringView *srcs, size_t n);
+long long bitOp(BitOp op, String &dest, std::initializer_list<StringView> srcs);
+
+}  // namespace rd
+
+#endif //REDIS_BITOPS_H
@@ -0,0 +1,230 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_COLLECTIONS_H
+#define REDIS_COLLECTIONS_H
+
+// For std::unique_ptr
+#include <memory>
+#include "adlist.h"
+#include "common.h"
+#include "dict.h"
+#include "intset.h"
+#include "listpack.h"
+#include "object.h"
+#include "sds.h"
+#include "skiplist.h"
+#include "util.h"
+#include "zmalloc.h"
+
+namespace rd {
+
+// Sizes past which a collection leaves its compact encoding, after
+// Redis' *-max-listpack-* and set-max-intset-entries: the most elements
+// (pairs for hashes and sorted sets), and the longest string element.
+struct EncodingConfig {
+  size_type hash_max_listpack_entries = 128;
+  size_type hash_max_listpack_value = 64;
+  size_type set_max_intset_entries = 512;
+  size_type zset_max_listpack_entries = 128;
+  size_type zset_max_listpack_value = 64;
+  size_type list_max_listpack_entries = 128;
+  size_type list_max_listpack_value = 64;
+};
+
+// The process-wide thresholds, like Redis' server config: a collection
+// holds no config of its own, which would cost a word per key. Set them
+// before collections are written to; they are not synchronized.
+EncodingConfig &encodingConfig();
+
+// Collections start out in one compact allocation and convert, once and
+// for good, to the node-based encoding when an insert crosses a threshold
+// of encodingConfig(). The conversion is invisible to callers but for
+// encoding(), and costs O(n) once. Each type is 16 bytes itself.
+
+// Field-value pairs: a ListPack of alternating fields and values, then a
+// Dict.
+class HashType {
+ public:
+  typedef Dict<String, String> dict_type;
+
+ private:
+  // Moved out once dict_ takes over.
+  ListPack lp_;
+  std::unique_ptr<dict_type> dict_;
+
+  void convert();
+
+ public:
+  Object::Encoding encoding() const {
+    return dict_ ? Object::kEncodingHashTable : Object::kEncodingListPack;
+  }
+  size_type size() const { return dict_ ? dict_->size() : lp_.size() / 2; }
+
+  // Sets field to value; true if field is new.
+  bool set(StringView field, StringView value);
+  bool get(StringView field, String *value);
+  bool exists(StringView field);
+  bool remove(StringView field);
+  // fn(StringView field, StringView value) for every pair, in no
+  // particular order.
+  template<class BiFn>
+  void forEach(BiFn fn);
+};
+
+// Members of a set: an IntSet while every member is the canonical text of
+// a long long, then a Dict whose values are unused.
+class SetType {
+ public:
+  typedef Dict<String, bool> dict_type;
+
+ private:
+  // Moved out once dict_ takes over.
+  IntSet is_;
+  std::unique_ptr<dict_type> dict_;
+
+  void convert();
+
+ public:
+  Object::Encoding encoding() const {
+    return dict_ ? Object::kEncodingHashTable : Object::kEncodingIntSet;
+  }
+  size_type size() const { return dict_ ? dict_->size() : is_.size(); }
+  // The members while they are integers, else nullptr.
+  const IntSet *intset() const { return dict_ ? nullptr : &is_; }
+
+  // False if member is already present.
+  bool add(StringView member);
+  bool remove(StringView member);
+  bool contains(StringView member);
+  // fn(StringView member) for every member, in no particular order.
+  template<class UnFn>
+  void forEach(UnFn fn);
+};
+
+// Members with scores, ordered by score then member: a ListPack of
+// member-score pairs kept in that order, then a Dict from member to score
+// beside a SkipList, as Redis' zset. Scores must not be NaN.
+class ZSetType {
+ public:
+  typedef Dict<String, double> dict_type;
+
+ private:
+  struct _ZSet : ZmallocNew {
+    dict_type dict;
+    SkipList zsl;
+  };
+  // Moved out once zset_ takes over.
+  ListPack lp_;
+  std::unique_ptr<_ZSet> zset_;
+
+  static double readScore(ListPackValue value);
+  void convert();
+  void insertPair(StringView member, double score);
+
+ public:
+  Object::Encoding encoding() const {
+    return zset_ ? Object::kEncodingSkipList : Object::kEncodingListPack;
+  }
+  size_type size() const {
+    return zset_ ? zset_->dict.size() : lp_.size() / 2;
+  }
+
+  // Adds member, or moves it to score; true if member is new.
+  bool add(StringView member, double score);
+  bool score(StringView member, double *score);
+  bool remove(StringView member);
+  // fn(StringView member, double score) for every member, in order.
+  template<class BiFn>
+  void forEach(BiFn fn);
+};
+
+// A sequence pushed and popped at both ends: a ListPack, then a List.
+class ListType {
+ public:
+  typedef List<String> list_type;
+
+ private:
+  // Moved out once list_ takes over.
+  ListPack lp_;
+  std::unique_ptr<list_type> list_;
+
+  void convert();
+  bool fits(StringView value) const;
+
+ public:
+  Object::Encoding encoding() const {
+    return list_ ? Object::kEncodingLinkedList : Object::kEncodingListPack;
+  }
+  size_type size() const { return list_ ? list_->size() : lp_.size(); }
+
+  void pushFront(StringView value);
+  void pushBack(StringView value);
+  // False if the list is empty.
+  bool popFront(String *value);
+  bool popBack(String *value);
+  // The element at index, counting from the back when negative.
+  bool index(long long index, String *value);
+  // fn(StringView value) for every element, front to back.
+  template<class UnFn>
+  void forEach(UnFn fn);
+};
+
+template<class BiFn>
+void HashType::forEach(BiFn fn) {
+  if (dict_) {
+    for (auto &entry : *dict_) {
+      fn(StringView(entry.key), StringView(entry.value));
+    }
+    return;
+  }
+  char field[kLongStrSize], value[kLongStrSize];
+  for (size_type p = lp_.first(); p != ListPack::npos;) {
+    size_type q = lp_.next(p);
+    fn(lp_.get(p).view(field), lp_.get(q).view(value));
+    p = lp_.next(q);
+  }
+}
+
+template<class UnFn>
+void SetType::forEach(UnFn fn) {
+  if (dict_) {
+    for (auto &entry : *dict_) { fn(StringView(entry.key)); }
+    return;
+  }
+  char buf[kLongStrSize];
+  for (size_type i = 0; i < is_.size(); i++) {
+    fn(StringView(buf, ll2string(buf, sizeof(buf), is_.get(i))));
+  }
+}
+
+template<class BiFn>
+void ZSetType::forEach(BiFn fn) {
+  if (zset_) {
+    for (auto &node : zset_->zsl) { fn(StringView(node.elem), node.score); }
+    return;
+  }
+  char buf[kLongStrSize];
+  for (size_type p = lp_.first(); p != ListPack::npos;) {
+    size_type q = lp_.next(p);
+    fn(lp_.get(p).view(buf), readScore(lp_.get(q)));
+    p = lp_.next(q);
+  }
+}
+
+template<class UnFn>
+void ListType::forEach(UnFn fn) {
+  if (list_) {
+    for (const String &value : *list_) { fn(StringView(value)); }
+    return;
+  }
+  char buf[kLongStrSize];
+  for (size_type p = lp_.first(); p != ListPack::npos; p = lp_.next(p)) {
+    fn(lp_.get(p).view(buf));
+  }
+}
+
+}  // namespace rd
+
+#endif //REDIS_COLLECTIONS_H
@@ -0,0 +1,275 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_CONCURRENTDICT_H
+#define REDIS_CONCURRENTDICT_H
+
+// For std::sort, std::unique
+#include <algorithm>
+// For uint64_t
+#include <cstdint>
+// For std::unique_ptr
+#include <memory>
+// For std::lock_guard
+#include <mutex>
+// For std::shared_mutex, std::shared_lock
+#include <shared_mutex>
+// For std::vector
+#include <vector>
+#include "dict.h"
+
+namespace rd {
+
+template<class Dict>
+struct alignas(64) _ConcurrentShard {
+  mutable std::shared_mutex lock;
+  Dict dict;
+};
+
+// A keyspace shared between threads: a power-of-two number of Dicts,
+// each behind its own reader-writer lock, with the shard of a key taken
+// from the top bits of its mixed hash. Lookups of different keys only
+// contend when they share a shard and one of them writes.
+//
+// Shards rehash independently in RehashMode::kCron, which makes their
+// lookups read-only, so any number of readers can share a shard. Each
+// write then moves a slice of buckets while it holds the shard, and
+// cron() finishes whatever rehashing is left.
+//
+// Entries never leave the shard lock, so lookups copy values out.
+template<class Key, class Value,
+    class Hash = std::hash<Key>, class Equal = std::equal_to<>>
+class ConcurrentDict {
+ public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef rd::size_type size_type;
+  typedef Dict<Key, Value, Hash, Equal> dict_type;
+  typedef typename dict_type::pointer pointer;
+
+ private:
+  typedef _ConcurrentShard<dict_type> shard_type;
+
+  template<class H, class E>
+  using _Transparent =
+  std::void_t<typename H::is_transparent, typename E::is_transparent>;
+
+  // Rehash budget of one write, in microseconds: about one slice.
+  static constexpr size_type kWriteRehashUs = 1;
+  static constexpr size_type kDefaultShards = 64;
+
+  std::unique_ptr<shard_type[]> shards_;
+  size_type shard_bits_;
+  Hash hash_;
+
+  size_type shards() const { return size_type(1) << shard_bits_; }
+  template<class Probe>
+  size_type shardOf(const Probe &key) const;
+  template<class Probe>
+  bool find(const Probe &key, value_type *value) const;
+  template<class Probe>
+  size_type findMany(const Probe *keys, size_type n,
+                     value_type *values, bool *found) const;
+  template<class Probe>
+  bool removeKey(const Probe &key);
+
+ public:
+  // shards is rounded up to a power of two.
+  explicit ConcurrentDict(size_type shards = kDefaultShards);
+  ConcurrentDict(const ConcurrentDict &) = delete;
+  ConcurrentDict &operator=(const ConcurrentDict &) = delete;
+
+  // The sum of the shard sizes, each read under its lock: exact when no
+  // thread is writing.
+  size_type size() const;
+  bool empty() const { return size() == 0; }
+
+  // Copies the value of key into *value; false if key is absent.
+  bool get(const key_type &key, value_type *value) const {
+    return find(key, value);
+  }
+  template<class Probe, class H = Hash, class E = Equal,
+      class = _Transparent<H, E>>
+  bool get(const Probe &key, value_type *value) const {
+    return find(key, value);
+  }
+  // Looks up n keys with each shard read-locked once and the bucket
+  // misses of all of them overlapped. Sets found[i] and, for keys
+  // found, values[i]; returns how many were found.
+  size_type getMany(const key_type *keys, size_type n,
+                    value_type *values, bool *found) const {
+    return findMany(keys, n, values, found);
+  }
+  template<class Probe, class H = Hash, class E = Equal,
+      class = _Transparent<H, E>>
+  size_type getMany(const Probe *keys, size_type n,
+                    value_type *values, bool *found) const {
+    return findMany(keys, n, values, found);
+  }
+  // False if key is already present.
+  bool add(key_type key, value_type value);
+  // Inserts key or overwrites its value.
+  void replace(key_type key, value_type value);
+  bool remove(const key_type &key) { return removeKey(key); }
+  template<class Probe, class H = Hash, class E = Equal,
+      class = _Transparent<H, E>>
+  bool remove(const Probe &key) { return removeKey(key); }
+
+  // Dict::scan across shards: the low bits of the cursor select a shard,
+  // the rest is that shard's cursor. fn runs with the shard read-locked
+  // and must not call back into this dict.
+  template<class UnFn>
+  size_type scan(size_type cursor, UnFn fn);
+  // Moves buckets of every rehashing shard for about us microseconds
+  // each, one shard locked at a time.
+  void cron(size_type us);
+};
+
+template<class K, class V, class H, class E>
+ConcurrentDict<K, V, H, E>::ConcurrentDict(size_type shards)
+    : shard_bits_(0) {
+  while (this->shards() < shards) { shard_bits_++; }
+  shards_ = std::make_unique<shard_type[]>(this->shards());
+  for (size_type i = 0; i < this->shards(); i++) {
+    shards_[i].dict.setRehashMode(RehashMode::kCron);
+  }
+}
+
+// Dicts index buckets with the low bits of the hash, so shards take the
+// high bits, after a multiply: std::hash of an integer is the identity.
+template<class K, class V, class H, class E>
+template<class Probe>
+typename ConcurrentDict<K, V, H, E>::size_type
+ConcurrentDict<K, V, H, E>::shardOf(const Probe &key) const {
+  if (shard_bits_ == 0) { return 0; }
+  uint64_t mixed = static_cast<uint64_t>(hash_(key)) * 0x9e3779b97f4a7c15ULL;
+  return static_cast<size_type>(mixed >> (64 - shard_bits_));
+}
+
+template<class K, class V, class H, class E>
+typename ConcurrentDict<K, V, H, E>::size_type
+ConcurrentDict<K, V, H, E>::size() const {
+  size_type size = 0;
+  for (size_type i = 0; i < shards(); i++) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].lock);
+    size += shards_[i].dict.size();
+  }
+  return size;
+}
+
+// Dict::getMany neither rehashes in kCron mode nor pins the dict, which
+// is what makes it safe under a shared lock, unlike Dict::get.
+template<class K, class V, class H, class E>
+template<class Probe>
+bool ConcurrentDict<K, V, H, E>::find(
+    const Probe &key, value_type *value) const {
+  shard_type &shard = shards_[shardOf(key)];
+  std::shared_lock<std::shared_mutex> lock(shard.lock);
+  pointer entry;
+  shard.dict.getMany(&key, 1, &entry);
+  if (entry == nullptr) { return false; }
+  *value = entry->value;
+  return true;
+}
+
+// Read-locks every shard the keys fall in, in ascending order, then
+// prefetches all their buckets before looking any key up, so misses
+// overlap across shards as they do within Dict::getMany. Holding
+// several shared locks cannot deadlock: writers hold one lock at a time.
+template<class K, class V, class H, class E>
+template<class Probe>
+typename ConcurrentDict<K, V, H, E>::size_type
+ConcurrentDict<K, V, H, E>::findMany(
+    const Probe *keys, size_type n, value_type *values, bool *found) const {
+  // Per-thread buffers, reused from call to call.
+  static thread_local std::vector<size_type> shard_of, locked;
+  shard_of.resize(n);
+  locked.clear();
+  for (size_type i = 0; i < n; i++) {
+    shard_of[i] = shardOf(keys[i]);
+    locked.push_back(shard_of[i]);
+  }
+  std::sort(locked.begin(), locked.end());
+  locked.erase(std::unique(locked.begin(), locked.end()), locked.end());
+  for (size_type s : locked) { shards_[s].lock.lock_shared(); }
+  for (size_type i = 0; i < n; i++) {
+    shards_[shard_of[i]].dict.prefetch(keys[i]);
+  }
+  size_type hits = 0;
+  for (size_type i = 0; i < n; i++) {
+    pointer entry;
+    shards_[shard_of[i]].dict.getMany(&keys[i], 1, &entry);
+    found[i] = entry != nullptr;
+    if (found[i]) {
+      values[i] = entry->value;
+      hits++;
+    }
+  }
+  for (size_type s : locked) { shards_[s].lock.unlock_shared(); }
+  return hits;
+}
+
+template<class K, class V, class H, class E>
+bool ConcurrentDict<K, V, H, E>::add(key_type key, value_type value) {
+  shard_type &shard = shards_[shardOf(key)];
+  std::lock_guard<std::shared_mutex> lock(shard.lock);
+  bool added = shard.dict.add(std::move(key), std::move(value)) != nullptr;
+  if (shard.dict.isRehashing()) {
+    shard.dict.rehashMicroseconds(kWriteRehashUs);
+  }
+  return added;
+}
+
+template<class K, class V, class H, class E>
+void ConcurrentDict<K, V, H, E>::replace(key_type key, value_type value) {
+  shard_type &shard = shards_[shardOf(key)];
+  std::lock_guard<std::shared_mutex> lock(shard.lock);
+  shard.dict.replace(std::move(key), std::move(value));
+  if (shard.dict.isRehashing()) {
+    shard.dict.rehashMicroseconds(kWriteRehashUs);
+  }
+}
+
+template<class K, class V, class H, class E>
+template<class Probe>
+bool ConcurrentDict<K, V, H, E>::removeKey(const Probe &key) {
+  shard_type &shard = shards_[shardOf(key)];
+  std::lock_guard<std::shared_mutex> lock(shard.lock);
+  bool removed = shard.dict.remove(key);
+  if (shard.dict.isRehashing()) {
+    shard.dict.rehashMicroseconds(kWriteRehashUs);
+  }
+  return removed;
+}
+
+template<class K, class V, class H, class E>
+template<class UnFn>
+typename ConcurrentDict<K, V, H, E>::size_type
+ConcurrentDict<K, V, H, E>::scan(size_type cursor, UnFn fn) {
+  size_type s = cursor & (shards() - 1), inner = cursor >> shard_bits_;
+  for (; s < shards(); s++, inner = 0) {
+    shard_type &shard = shards_[s];
+    std::shared_lock<std::shared_mutex> lock(shard.lock);
+    if (shard.dict.empty()) { continue; }
+    inner = shard.dict.scan(inner, fn);
+    if (inner != 0) { return (inner << shard_bits_) | s; }
+    // This shard is done: the next call starts on the next one.
+    return s + 1 < shards() ? s + 1 : 0;
+  }
+  return 0;
+}
+
+template<class K, class V, class H, class E>
+void ConcurrentDict<K, V, H, E>::cron(size_type us) {
+  for (size_type i = 0; i < shards(); i++) {
+    std::lock_guard<std::shared_mutex> lock(shards_[i].lock);
+    if (shards_[i].dict.isRehashing()) {
+      shards_[i].dict.rehashMicroseconds(us);
+    }
+  }
+}
+
+}  // namespace rd
+
+#endif //REDIS_CONCURRENTDICT_H
@@ -0,0 +1,111 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_DB_H
+#define REDIS_DB_H
+
+#include "common.h"
+#include "dict.h"
+#include "evict.h"
+#include "expire.h"
+#include "object.h"
+#include "sds.h"
+
+namespace rd {
+
+// A keyspace, like Redis' redisDb: keys mapped to Objects, plus the keys
+// that have a time to live mapped to when they expire, in unix
+// milliseconds. The Db holds one reference to every value.
+//
+// Keys past their expire time are deleted lazily, when looked up, and
+// actively by activeExpireCycle(), which callers run from their cron.
+//
+// With a maxmemory limit set, callers run performEvictions() before any
+// write, as Redis does before each command that may use more memory, and
+// refuse the write on kFail. The limit applies to usedMemory(), which
+// counts the whole process.
+class Db {
+ public:
+  typedef Dict<String, Object *> dict_type;
+  typedef Dict<String, long long> expires_type;
+
+ private:
+  dict_type dict_;
+  expires_type expires_;
+  MaxmemoryConfig maxmemory_;
+  EvictionPool pool_;
+  ExpireConfig expire_;
+  ExpireStats expire_stats_;
+  // Where the next cycle resumes scanning the expires.
+  size_type expires_cursor_;
+  // Whether the last cycle ran out of time.
+  bool expire_timed_out_;
+  // Start of the last fast cycle, in steady_clock microseconds.
+  uint64_t last_fast_cycle_;
+
+  bool isLfu() const;
+  bool evictsByAccess() const;
+  bool evictsVolatile() const;
+  void populatePool();
+  bool nextEvictionKey(String *key);
+  size_type expireKeys(size_type count, long long now, size_type *sampled);
+  void resizeTables();
+
+ public:
+  Db();
+  Db(const Db &) = delete;
+  Db &operator=(const Db &) = delete;
+  ~Db();
+
+  size_type size() const { return dict_.size(); }
+  dict_type &dict() { return dict_; }
+  expires_type &expires() { return expires_; }
+
+  // The value of key, or nullptr, recording the access for eviction. A
+  // key past its expire time is deleted and not found.
+  Object *lookup(StringView key);
+  // Sets key to value, taking over the caller's reference, and clears
+  // its TTL. Under an LRU or LFU policy a shared integer is replaced by
+  // an unshared copy, which can record accesses; an overwrite keeps the
+  // LFU counter of the old value.
+  void set(StringView key, Object *value);
+  bool remove(StringView key);
+  // False if key does not exist.
+  bool setExpire(StringView key, long long when);
+  // The expire time of key, or -1 if it has none.
+  long long getExpire(StringView key);
+  bool removeExpire(StringView key);
+  // Deletes key if it has expired; true if it did.
+  bool expireIfNeeded(StringView key);
+
+  const MaxmemoryConfig &maxmemory() const { return maxmemory_; }
+  void setMaxmemory(const MaxmemoryConfig &config);
+  // Evicts keys by the maxmemory policy until usedMemory() is at most
+  // maxmemory. Each key comes from the eviction pool, refilled with
+  // config.samples keys sampled from the keyspace (or from the expires
+  // of a volatile policy). After every 16 keys the time spent is checked
+  // against eviction_time_limit_us, and past it the call returns
+  // kRunning, so a large overshoot is worked off across several calls
+  // instead of stalling one.
+  EvictResult performEvictions();
+
+  const ExpireConfig &expireConfig() const { return expire_; }
+  void setExpireConfig(const ExpireConfig &config) { expire_ = config; }
+  const ExpireStats &expireStats() const { return expire_stats_; }
+  // Deletes expired keys for a bounded time, after Redis' expire.c. Each
+  // loop scans the expires from a cursor kept across cycles until it
+  // has looked at 20 keys (more with a higher effort), deleting those
+  // past their time, and loops again while more than 10% of them were
+  // stale. The clock is checked after every loop: a slow cycle may spend
+  // 25% of a cron tick, a fast one 1 ms, and a fast cycle is skipped
+  // unless the last cycle timed out or the stale estimate is high.
+  // A slow cycle then shrinks either dict once it is under 10% full,
+  // which keeps scanning the expires cheap after a mass expiry, and
+  // gives any rehash in progress a millisecond.
+  void activeExpireCycle(ExpireCycle type);
+};
+
+}  // namespace rd
+
+#endif //REDIS_DB_H
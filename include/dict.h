@@ -4,49 +4,136 @@
 
 #ifndef REDIS_DICT_H
 #define REDIS_DICT_H
+// algorithm for std::fill, std::min
+// atomic for the rehash thread's flags and stripe locks
+// cassert for assert
+// chrono for time diff
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+// functional for std::hash, std::equal_to
+#include <functional>
+// memory for std::unique_ptr
+// memory_resource for std::pmr
+#include <memory>
+#include <memory_resource>
+// thread for the rehash thread
+#include <thread>
+// type_traits for std::void_t
+#include <type_traits>
 // vector used in _DictTable.table_
 #include <vector>
 #include "common.h"
+#include "slab.h"
+#include "util.h"
+#include "zmalloc.h"
 
 namespace rd {
 
-using std::hash;
-using std::vector;
-
+template<class Dict>
 class _DictIterator;
 
-class Dict;
+// Who moves buckets while a dict is rehashing.
+enum class RehashMode {
+  // Every lookup, insert and remove moves one bucket, as in Redis.
+  kOnAccess,
+  // Nothing moves until the owner calls rehashMicroseconds, typically
+  // from a periodic cron with a fixed time budget.
+  kCron,
+  // A helper thread moves every bucket while the owner keeps using the
+  // dict. Lookups, inserts and removes lock the stripe of their key.
+  kThread,
+};
+
+// A rehash handed to a helper thread. Both threads lock a key's stripe,
+// picked from its bucket index in the smaller table: that index is
+// shared by the key's bucket in either table, so one stripe covers the
+// bucket being moved and every bucket its entries can land in.
+struct _DictRehasher {
+  static constexpr size_type kStripes = 256;
+
+  std::thread thread;
+  std::atomic<bool> stop{false};
+  std::atomic<bool> done{false};
+  // Entries moved, read by the owner once the thread has joined.
+  size_type moved = 0;
+  std::atomic<bool> locks[kStripes]{};
 
-struct _DictEntry {
-  Var key;
-  Var value;
+  void lock(size_type stripe) {
+    while (locks[stripe].exchange(true, std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+  void unlock(size_type stripe) {
+    locks[stripe].store(false, std::memory_order_release);
+  }
+};
+
+// Holds a stripe of a rehasher, if there is one, for its lifetime.
+class _DictStripeLock {
+ private:
+  _DictRehasher *rehasher_;
+  size_type stripe_;
+
+ public:
+  _DictStripeLock(_DictRehasher *rehasher, size_type bucket)
+      : rehasher_(rehasher),
+        stripe_(bucket & (_DictRehasher::kStripes - 1)) {
+    if (rehasher_ != nullptr) { rehasher_->lock(stripe_); }
+  }
+  _DictStripeLock(const _DictStripeLock &) = delete;
+  _DictStripeLock &operator=(const _DictStripeLock &) = delete;
+  ~_DictStripeLock() {
+    if (rehasher_ != nullptr) { rehasher_->unlock(stripe_); }
+  }
+};
+
+// The full hash of an entry's key, kept when the dict caches hashes.
+template<bool Cached>
+struct _DictHash {
+  void setHash(size_type) {}
+};
+
+template<>
+struct _DictHash<true> {
+  size_type hash;
+  void setHash(size_type h) { hash = h; }
+};
+
+template<class Key, class Value, bool CacheHash>
+struct _DictEntry : _DictHash<CacheHash> {
+  Key key;
+  Value value;
   _DictEntry *next;
-  _DictEntry(Var &k, Var &v);
+  _DictEntry(Key k, Value v)
+      : key(std::move(k)), value(std::move(v)), next(nullptr) {}
 };
 
+// Entries are owned and freed by the Dict, which allocates them from
+// its Slab; the table only holds the bucket array.
+template<class Entry>
 struct _DictTable {
-  vector<_DictEntry *> table_;
+  std::pmr::vector<Entry *> table_;
   size_type capacity_;
   size_type size_;
-//  Allocator<_DictEntry> allocator_;
 
   inline size_t mask() const { return capacity_ - 1; }
 
-//  _DictTable();
-  explicit _DictTable(size_t n);
-  ~_DictTable();
-  _DictEntry *
+  _DictTable(size_t n, Allocator<Entry *> allocator);
+  Entry *
   &at(size_type n) { return table_[n]; }
 };
 
+template<class Dict>
 class _DictIterator {
-  friend class Dict;
+  friend Dict;
 
  public:
   typedef rd::size_type size_type;
   typedef _DictIterator iterator;
   typedef std::forward_iterator_tag iterator_category;
-  typedef _DictEntry entry_type;
+  typedef typename Dict::entry_type entry_type;
   typedef Dict dict_type;
   typedef entry_type &reference;
   typedef entry_type *pointer;
@@ -55,17 +142,24 @@ class _DictIterator {
   pointer cur_;
   Dict *dict_;
   bool in_rehash_;
+  // Whether this iterator holds one of the dict's iterator counts, which
+  // pause incremental rehashing while the iterator points at an entry.
+  bool pinned_;
   size_type index_;
 
+  void pin();
+  void unpin();
+
  public:
   _DictIterator()
       : cur_(nullptr), dict_(nullptr),
-        index_(0), in_rehash_(false) {}
+        in_rehash_(false), pinned_(false), index_(0) {}
   _DictIterator(const _DictIterator &it);
   explicit _DictIterator(
       Dict *dict, size_type index = 0,
       pointer cur = nullptr, bool in_rehash = false);
-  ~_DictIterator();
+  ~_DictIterator() { unpin(); }
+  _DictIterator &operator=(const _DictIterator &it);
 
   reference operator*()
   const { return *cur_; }
@@ -80,53 +174,191 @@ class _DictIterator {
   const { return dict_ == it.dict_ && cur_ == it.cur_; }
   bool operator!=(const iterator &it)
   const { return !(operator==(it)); }
-  bool operator==(nullptr_t)
+  bool operator==(std::nullptr_t)
   const { return cur_ == nullptr; }
-  bool operator!=(nullptr_t)
+  bool operator!=(std::nullptr_t)
   const { return cur_ != nullptr; }
 };
 
-class Dict {
+// The tuning of a Dict, fixed at compile time so that it takes no room
+// in the dict and folds into the code. A policy derives from DictPolicy
+// and overrides what it changes, e.g.
+//   struct CountedPolicy : DictPolicy { static constexpr bool kStats = true; };
+struct DictPolicy {
+  // Buckets of a new or fully shrunk table.
+  static constexpr size_type kInitialSize = 4;
+  // Entries per bucket at which the table grows...
+  static constexpr size_type kResizeRatio = 1;
+  // ...and at which it grows even while resizing is disabled.
+  static constexpr size_type kForceResizeRatio = 5;
+  // Times the entries of a full table that its replacement is sized for.
+  static constexpr size_type kGrowthFactor = 2;
+  // Empty buckets a rehash step may skip before giving up.
+  static constexpr size_type kRehashSliceLength = 10;
+  // Buckets moved between looks at the clock in rehashMicroseconds.
+  static constexpr size_type kRehashMsDuration = 100;
+  // Whether the dict keeps DictStats.
+  static constexpr bool kStats = false;
+};
+
+// Counters of a Dict whose policy sets kStats. They are updated by the
+// calls that may modify the dict (not getMany or the scans), so that
+// readers sharing a dict under a shared lock do not race on them.
+struct DictStats {
+  // Lookups by key from get, add, replace and remove.
+  uint64_t lookups = 0;
+  // Entries compared against the key over those lookups.
+  uint64_t probes = 0;
+  // Most entries compared in one lookup.
+  uint64_t max_chain = 0;
+  // Incremental rehash steps, and the buckets they moved.
+  uint64_t rehash_steps = 0;
+  uint64_t rehashed_buckets = 0;
+  // Tables allocated to grow or shrink the dict.
+  uint64_t resizes = 0;
+};
+
+// Where a Dict counts, if its policy asks it to; empty otherwise.
+template<bool Enabled>
+struct _DictCounters {
+  void countLookup(size_type) {}
+  void countRehashStep(size_type) {}
+  void countResize() {}
+};
+
+template<>
+struct _DictCounters<true> {
+  DictStats stats_;
+  void countLookup(size_type probes) {
+    stats_.lookups++;
+    stats_.probes += probes;
+    stats_.max_chain = std::max<uint64_t>(stats_.max_chain, probes);
+  }
+  void countRehashStep(size_type buckets) {
+    stats_.rehash_steps++;
+    stats_.rehashed_buckets += buckets;
+  }
+  void countResize() { stats_.resizes++; }
+};
+
+// A chained hash table with incremental rehashing, after Redis' dict.c.
+// Keys are hashed with Hash and compared with Equal. When both are
+// transparent (declare is_transparent), get and remove also accept any
+// type they can hash and compare against Key, e.g. a StringView probe
+// of a String-keyed dict, without building a temporary key.
+//
+// All memory comes from one std::pmr::memory_resource, zmallocResource()
+// unless one is passed in: bucket arrays and tables through a
+// polymorphic allocator, entries through a per-dict Slab that recycles
+// freed entries. A monotonic_buffer_resource makes a bulk load an arena
+// allocation that is dropped in one go.
+//
+// With CacheHash, the default for keys that are not plain numbers, each
+// entry keeps its key's full hash: rehashing moves entries without
+// hashing their keys again, and a chain walk skips entries whose hash
+// differs before comparing keys. It costs a word per entry.
+//
+// Policy, a DictPolicy, sets the load factor, growth and rehash pace,
+// and whether stats() are kept.
+template<class Key, class Value,
+    class Hash = std::hash<Key>, class Equal = std::equal_to<>,
+    bool CacheHash = !std::is_arithmetic_v<Key>,
+    class Policy = DictPolicy>
+class Dict : private _DictCounters<Policy::kStats>, public ZmallocNew {
  public:
-  friend class _DictIterator;
+  friend class _DictIterator<Dict>;
 
-  typedef Var key_type;
-  typedef Var value_type;
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef Hash hasher;
+  typedef Equal key_equal;
+  typedef Policy policy_type;
   typedef rd::size_type size_type;
-  typedef _DictIterator iterator;
-  typedef _DictEntry entry_type;
+  typedef _DictIterator<Dict> iterator;
+  typedef _DictEntry<Key, Value, CacheHash> entry_type;
   typedef entry_type *pointer;
   typedef entry_type &reference;
 
  private:
-  const size_type kForceResizeRatio = 5;
-  const size_type kInitialSize = 4;
-  const size_type kRehashSliceLength = 10;
-  const size_type kRehashMsDuration = 100;
-  const size_type kResizeRatio = 1;
+  typedef _DictTable<entry_type> table_type;
+
+  template<class H, class E>
+  using _Transparent =
+  std::void_t<typename H::is_transparent, typename E::is_transparent>;
 
-  _DictTable *data_, *rehash_;
+  static constexpr size_type kForceResizeRatio = Policy::kForceResizeRatio;
+  static constexpr size_type kGrowthFactor = Policy::kGrowthFactor;
+  static constexpr size_type kInitialSize = Policy::kInitialSize;
+  static constexpr size_type kRehashSliceLength = Policy::kRehashSliceLength;
+  static constexpr size_type kRehashMsDuration = Policy::kRehashMsDuration;
+  static constexpr size_type kResizeRatio = Policy::kResizeRatio;
+  // Lookups in flight in getMany: enough to cover memory latency, few
+  // enough that their buckets and entries stay in L1.
+  static constexpr size_type kGetManyBatch = 16;
+  // Parts per thread in scanParallel: enough that a thread done early
+  // takes over parts, so uneven ones do not leave threads idle.
+  static constexpr size_type kScanPartsPerThread = 8;
+  static constexpr size_type kScanCount = 1024;
+  // Entries randomEntry draws from, Redis' GETFAIR_NUM_ENTRIES.
+  static constexpr size_type kRandomSamples = 15;
+  // sampleEntries calls before randomEntry walks the table instead.
+  static constexpr size_type kRandomTries = 3;
+
+  table_type *data_, *rehash_;
   size_type process_;
   size_type iter_num_;
   bool resizable;
-//  Allocator<_DictTable> allocator_;
+  RehashMode rehash_mode_;
+  std::unique_ptr<_DictRehasher> rehasher_;
+  Hash hash_;
+  Equal equal_;
+  Allocator<table_type> allocator_;
+  Slab entries_;
 
   size_type fixSize(size_type n) const;
   template<class T>
   T reverseBit(T n) const;
 
-  iterator findIterIndex(const key_type &key);
-  typename Dict::iterator setKeyValue(
-      const iterator &iter, key_type &key, value_type &value);
+  size_type entryHash(pointer entry) const;
+  template<class Probe>
+  bool matches(pointer entry, size_type hash, const Probe &key) const;
+  template<class Probe>
+  iterator findIterIndex(const Probe &key) {
+    return findIterIndex(key, hash_(key));
+  }
+  template<class Probe>
+  iterator findIterIndex(const Probe &key, size_type hash);
+  iterator setKeyValue(key_type &&key, value_type &&value, size_type hash);
+  template<class Probe>
+  bool removeKey(const Probe &key);
+  template<class Probe>
+  void findMany(const Probe *keys, size_type n, pointer *out);
   void rehash(size_type n = 1);
+  inline void rehashStep();
   void resize(size_type n);
+  void rebuild(size_type n);
+  _DictStripeLock lockStripe(size_type hash) const;
+  void startRehashThread();
+  void stopRehashThread();
+  void rehashInThread();
+
+  table_type *newTable(size_type n);
+  void freeTable(table_type *table);
+  pointer newEntry(key_type &&key, value_type &&value, size_type hash);
+  void freeEntry(pointer entry);
 
   inline void stopRehash();
-  inline void acquireIterator(iterator *iter);
+  inline void acquireIterator();
   inline void releaseIterator();
 
  public:
   Dict();
+  explicit Dict(std::pmr::memory_resource *resource);
+  explicit Dict(
+      const Hash &hash, const Equal &equal = Equal(),
+      std::pmr::memory_resource *resource = zmallocResource());
+  Dict(const Dict &) = delete;
+  Dict &operator=(const Dict &) = delete;
   ~Dict();
 
   iterator begin();
@@ -138,22 +370,220 @@ class Dict {
   const { return rehash_ != nullptr; }
   bool isRehashable()
   const { return iter_num_ == 0; }
+  std::pmr::memory_resource *resource()
+  const { return allocator_.resource(); }
+  // Buckets in the table(s).
+  size_type buckets() const {
+    return data_->capacity_ + (isRehashing() ? rehash_->capacity_ : 0);
+  }
+  // Entry blocks in the slab, including free ones kept for reuse.
+  size_type entryCapacity()
+  const { return entries_.capacity(); }
+  const DictStats &stats() const {
+    static_assert(Policy::kStats, "the policy of this dict keeps no stats");
+    return this->stats_;
+  }
 
-  void rehashMilliseconds(size_type n);
+  RehashMode rehashMode()
+  const { return rehash_mode_; }
+  // Switching away from kThread stops a running helper; buckets it has
+  // not moved are left to the new mode.
+  void setRehashMode(RehashMode mode);
+  // Moves buckets for about n microseconds, checking the monotonic clock
+  // every kRehashMsDuration buckets. Does nothing while a helper thread
+  // owns the rehash.
+  void rehashMicroseconds(size_type n);
+  void rehashMilliseconds(size_type n) { rehashMicroseconds(n * 1000); }
   void shrink();
   void expand();
+  // Grows the table to hold n entries without resizing, at once rather
+  // than by an incremental rehash: entries already in the dict, in
+  // either table, are moved before it returns. Does nothing if the
+  // table, or the one being rehashed to, is big enough. Not allowed
+  // while an iterator is pinned.
+  void reserve(size_type n);
 
-  iterator get(const key_type &key);
-  iterator add(key_type &key, value_type &value);
-  iterator replace(key_type &key, value_type &value);
-  bool remove(const key_type &key);
+  iterator get(const key_type &key) { return findIterIndex(key); }
+  template<class Probe, class H = Hash, class E = Equal,
+      class = _Transparent<H, E>>
+  iterator get(const Probe &key) { return findIterIndex(key); }
+  // Looks up n keys at once, setting out[i] to the entry of keys[i] or
+  // nullptr. Keys go through in batches, prefetching every bucket of a
+  // batch and then every chain head before comparing any, so the cache
+  // misses of one lookup overlap those of the others. The entries stay
+  // valid until the dict is next modified.
+  void getMany(const key_type *keys, size_type n, pointer *out) {
+    findMany(keys, n, out);
+  }
+  template<class Probe, class H = Hash, class E = Equal,
+      class = _Transparent<H, E>>
+  void getMany(const Probe *keys, size_type n, pointer *out) {
+    findMany(keys, n, out);
+  }
+  // Prefetches the bucket of key in each table, for callers batching
+  // lookups over several dicts. Reads and moves nothing.
+  template<class Probe>
+  void prefetch(const Probe &key) const;
+  // An entry chosen at random, or nullptr if the dict is empty: one of
+  // kRandomSamples entries from sampleEntries, which evens out the bias
+  // of picking a bucket first towards entries in short chains. On a
+  // table so sparse that samples come back empty, the entries in the
+  // buckets after a random one.
+  pointer randomEntry();
+  // Stores up to count entries found by walking consecutive buckets of
+  // both tables from a random one, and returns how many. Like Redis'
+  // dictGetSomeKeys: it visits at most 10 * count buckets and jumps to
+  // a new random bucket after a run of empty ones, so the work stays
+  // O(count) on sparse tables, at the price of sometimes returning
+  // fewer entries. The same entry may come back twice on a table
+  // smaller than the walk.
+  size_type sampleEntries(size_type count, pointer *out);
+  // Inserts key unless it is present; returns end() in that case.
+  iterator add(key_type key, value_type value);
+  // Inserts key, or overwrites the value of the entry already holding it.
+  iterator replace(key_type key, value_type value);
+  // Inserts key, which the caller guarantees is not present, e.g. when
+  // loading a snapshot. Skips the lookup for a duplicate and moves no
+  // buckets of a rehash in progress; a full table doubles in place, as
+  // reserve() would, so reserving the final size first makes a load
+  // allocate one table and visit each entry once.
+  iterator addUnique(key_type key, value_type value);
+  bool remove(const key_type &key) { return removeKey(key); }
+  template<class Probe, class H = Hash, class E = Equal,
+      class = _Transparent<H, E>>
+  bool remove(const Probe &key) { return removeKey(key); }
   template<class UnFn>
   size_type scan(size_type n, UnFn fn);
+  // scan restricted to one of parts (a power of two) disjoint slices of
+  // the cursor space: the cursors whose low bits are part, that is the
+  // buckets whose index is part modulo parts, at every table size. Each
+  // part runs from cursor 0 until 0 is returned, and together the parts
+  // give the guarantee of scan, even across resizes between calls. A
+  // table with fewer than parts buckets is read as if it had parts,
+  // keeping from each bucket the entries whose hash belongs to part.
+  //
+  // Each call visits count cursors, or what is left of the part. On a
+  // table that is not rehashing, consecutive cursors of one call have
+  // their buckets and chain heads prefetched together.
+  //
+  // The call only reads, so threads may scan parts concurrently while
+  // nothing modifies the dict, e.g. under a shared lock, and no helper
+  // thread is rehashing it.
+  template<class UnFn>
+  size_type scanPartition(size_type part, size_type parts, size_type cursor,
+                          UnFn fn, size_type count = 1) const;
+  // Sweeps the whole dict on threads threads, the calling one included,
+  // which take kScanPartsPerThread parts each on average, one at a time,
+  // kScanCount cursors per call.
+  // fn(entry, worker) runs concurrently for different workers, worker
+  // in [0, threads), and must not modify the dict.
+  template<class BiFn>
+  void scanParallel(size_type threads, BiFn fn) const;
 
 };
 
+template<class Entry>
+_DictTable<Entry>::_DictTable(size_t n, Allocator<Entry *> allocator)
+    : table_(n, allocator), capacity_(n), size_(0) {}
+
+template<class Dict>
+void _DictIterator<Dict>::pin() {
+  if (!pinned_ && cur_ != nullptr) {
+    dict_->acquireIterator();
+    pinned_ = true;
+  }
+}
+
+template<class Dict>
+void _DictIterator<Dict>::unpin() {
+  if (pinned_) {
+    dict_->releaseIterator();
+    pinned_ = false;
+  }
+}
+
+template<class Dict>
+_DictIterator<Dict>::_DictIterator(const _DictIterator &it)
+    : cur_(it.cur_), dict_(it.dict_), in_rehash_(it.in_rehash_),
+      pinned_(false), index_(it.index_) {
+  pin();
+}
+
+template<class Dict>
+_DictIterator<Dict>::_DictIterator(
+    Dict *dict, size_type index,
+    _DictIterator::pointer cur, bool in_rehash)
+    : cur_(cur), dict_(dict), in_rehash_(in_rehash),
+      pinned_(false), index_(index) {
+  pin();
+}
+
+template<class Dict>
+_DictIterator<Dict> &
+_DictIterator<Dict>::operator=(const _DictIterator &it) {
+  if (this != &it) {
+    unpin();
+    cur_ = it.cur_;
+    dict_ = it.dict_;
+    in_rehash_ = it.in_rehash_;
+    index_ = it.index_;
+    pin();
+  }
+  return *this;
+}
+
+// Walks the old table, then the new one while a rehash is in progress.
+// The iterator pins the dict, so no entry moves between the two; a
+// helper thread, which pins cannot pause, is stopped first.
+template<class Dict>
+typename _DictIterator<Dict>::iterator &
+_DictIterator<Dict>::operator++() {
+  dict_->stopRehashThread();
+  if (cur_ != nullptr) {
+    cur_ = cur_->next;
+  }
+  while (cur_ == nullptr) {
+    typename Dict::table_type *table =
+        in_rehash_ ? dict_->rehash_ : dict_->data_;
+    if (++index_ >= table->capacity_) {
+      if (in_rehash_ || !dict_->isRehashing()) {
+        break;
+      }
+      in_rehash_ = true;
+      index_ = 0;
+      cur_ = dict_->rehash_->at(0);
+      continue;
+    }
+    cur_ = table->at(index_);
+  }
+  if (cur_ == nullptr) {
+    unpin();
+  } else {
+    pin();
+  }
+  return *this;
+}
+
+template<class Dict>
+typename _DictIterator<Dict>::iterator // NOLINT
+_DictIterator<Dict>::operator++(int) {
+  iterator it(*this);
+  ++(*this);
+  return it;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::size_type
+Dict<K, V, H, E, C, P>::fixSize(size_type n) const {
+  size_type i = kInitialSize;
+  if (n >= SIZE_MAX) { return SIZE_MAX + 1U; }
+  for (; i < n; i *= 2);
+  return i;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
 template<class T>
-T Dict::reverseBit(T n) const {
+T Dict<K, V, H, E, C, P>::reverseBit(T n) const {
   T s = 8 * sizeof(n),
       mask = ~T();
   while ((s >>= 1u) > 0) {
@@ -163,12 +593,628 @@ T Dict::reverseBit(T n) const {
   return n;
 }
 
+template<class K, class V, class H, class E, bool C, class P>
+template<class Probe>
+typename Dict<K, V, H, E, C, P>::iterator
+Dict<K, V, H, E, C, P>::findIterIndex(const Probe &key, size_type hash) {
+  if (empty()) {
+    return iterator(this);
+  }
+  rehashStep();
+  _DictStripeLock lock = lockStripe(hash);
+  table_type *table = data_;
+  size_type probes = 0;
+  for (size_type i = 0; i < 1 + isRehashing(); i++, table = rehash_) {
+    size_type idx = hash & table->mask();
+    pointer entry = table->at(idx);
+    for (; entry != nullptr; entry = entry->next) {
+      probes++;
+      if (matches(entry, hash, key)) {
+        this->countLookup(probes);
+        return iterator(this, idx, entry, i == 1);
+      }
+    }
+//    if (!isRehashing()) { break; }
+  }
+  this->countLookup(probes);
+  return iterator(this);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::size_type
+Dict<K, V, H, E, C, P>::entryHash(pointer entry) const {
+  if constexpr (C) {
+    return entry->hash;
+  } else {
+    return hash_(entry->key);
+  }
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+template<class Probe>
+bool Dict<K, V, H, E, C, P>::matches(
+    pointer entry, size_type hash, const Probe &key) const {
+  if constexpr (C) {
+    if (entry->hash != hash) { return false; }
+  }
+  return equal_(entry->key, key);
+}
+
+// Group prefetching over both tables: stage one hashes a batch and
+// prefetches its buckets, stage two loads the heads and prefetches the
+// entries, stage three walks the chains. The batch runs after at most
+// one rehash step, so no entry moves between the stages. A helper
+// thread could, so with one running keys are looked up one by one.
+template<class K, class V, class H, class E, bool C, class P>
+template<class Probe>
+void Dict<K, V, H, E, C, P>::findMany(
+    const Probe *keys, size_type n, pointer *out) {
+  if (empty()) {
+    std::fill(out, out + n, nullptr);
+    return;
+  }
+  rehashStep();
+  if (rehasher_ != nullptr) {
+    for (size_type i = 0; i < n; i++) {
+      out[i] = findIterIndex(keys[i]).operator->();
+    }
+    return;
+  }
+  size_type tables = 1 + isRehashing();
+  table_type *table[2] = {data_, rehash_};
+  size_type hash[kGetManyBatch];
+  pointer head[kGetManyBatch][2];
+  for (size_type base = 0; base < n; base += kGetManyBatch) {
+    size_type batch = std::min(kGetManyBatch, n - base);
+    for (size_type i = 0; i < batch; i++) {
+      hash[i] = hash_(keys[base + i]);
+      for (size_type t = 0; t < tables; t++) {
+        __builtin_prefetch(&table[t]->at(hash[i] & table[t]->mask()));
+      }
+    }
+    for (size_type i = 0; i < batch; i++) {
+      for (size_type t = 0; t < tables; t++) {
+        head[i][t] = table[t]->at(hash[i] & table[t]->mask());
+        if (head[i][t] != nullptr) { __builtin_prefetch(head[i][t]); }
+      }
+    }
+    for (size_type i = 0; i < batch; i++) {
+      pointer found = nullptr;
+      for (size_type t = 0; t < tables && found == nullptr; t++) {
+        for (pointer entry = head[i][t];
+             entry != nullptr; entry = entry->next) {
+          if (matches(entry, hash[i], keys[base + i])) {
+            found = entry;
+            break;
+          }
+        }
+      }
+      out[base + i] = found;
+    }
+  }
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+template<class Probe>
+void Dict<K, V, H, E, C, P>::prefetch(const Probe &key) const {
+  size_type hash = hash_(key);
+  __builtin_prefetch(&data_->at(hash & data_->mask()));
+  if (isRehashing()) {
+    __builtin_prefetch(&rehash_->at(hash & rehash_->mask()));
+  }
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::pointer Dict<K, V, H, E, C, P>::randomEntry() {
+  if (empty()) { return nullptr; }
+  pointer samples[kRandomSamples];
+  size_type n = 0;
+  for (size_type j = 0; j < kRandomTries && n == 0; j++) {
+    n = sampleEntries(kRandomSamples, samples);
+  }
+  // Too sparse to sample: walk from a random bucket to the next entries.
+  // Shrinking is left to resizeTables and the cron: under RehashMode::kCron
+  // or with an iterator pinned, it would not get anywhere from here.
+  while (n == 0) {
+    size_type tables = 1 + isRehashing();
+    table_type *table[2] = {data_, rehash_};
+    size_type max_mask = data_->mask();
+    if (tables == 2) { max_mask = std::max(max_mask, rehash_->mask()); }
+    size_type i = random64() & max_mask, steps = max_mask + 1;
+    size_type budget = kRandomSamples * 10;
+    for (; steps != 0 && n < kRandomSamples; steps--) {
+      if (n == 0 && tables == 1 && rehasher_ == nullptr) {
+        // Nothing to lock or skip: run to the next entry in a tight loop.
+        for (; steps > 1 && data_->at(i) == nullptr; steps--) {
+          i = (i + 1) & max_mask;
+        }
+      }
+      for (size_type t = 0; t < tables && n < kRandomSamples; t++) {
+        if (tables == 2 && t == 0 && rehasher_ == nullptr && i < process_) {
+          continue;
+        }
+        if (i >= table[t]->capacity_) { continue; }
+        _DictStripeLock lock = lockStripe(i);
+        for (pointer entry = table[t]->at(i);
+             entry != nullptr && n < kRandomSamples; entry = entry->next) {
+          samples[n++] = entry;
+        }
+      }
+      // Past the first entry, look as far as sampleEntries would.
+      if (n != 0 && budget-- == 0) { break; }
+      i = (i + 1) & max_mask;
+    }
+  }
+  return samples[random64() % n];
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::size_type
+Dict<K, V, H, E, C, P>::sampleEntries(size_type count, pointer *out) {
+  count = std::min(count, size());
+  if (count == 0) { return 0; }
+  for (size_type j = 0; j < count && isRehashing(); j++) { rehashStep(); }
+  size_type tables = 1 + isRehashing();
+  table_type *table[2] = {data_, rehash_};
+  size_type max_mask = data_->mask();
+  if (tables == 2) { max_mask = std::max(max_mask, rehash_->mask()); }
+  size_type maxsteps = count * 10, stored = 0, empty_run = 0;
+  size_type i = random64() & max_mask;
+  while (stored < count && maxsteps-- != 0) {
+    for (size_type t = 0; t < tables; t++) {
+      // Old buckets below process_ are already moved. A helper thread
+      // owns process_, so with one running they are just seen empty.
+      if (tables == 2 && t == 0 && rehasher_ == nullptr && i < process_) {
+        if (i >= rehash_->capacity_) {
+          i = process_;
+        } else {
+          continue;
+        }
+      }
+      if (i >= table[t]->capacity_) { continue; }
+      _DictStripeLock lock = lockStripe(i);
+      pointer entry = table[t]->at(i);
+      if (entry == nullptr) {
+        if (++empty_run >= 5 && empty_run > count) {
+          i = random64() & max_mask;
+          empty_run = 0;
+        }
+        continue;
+      }
+      empty_run = 0;
+      for (; entry != nullptr; entry = entry->next) {
+        out[stored++] = entry;
+        if (stored == count) { return stored; }
+      }
+    }
+    i = (i + 1) & max_mask;
+  }
+  return stored;
+}
+
+// Links a new entry for a key known to be absent, into the new table
+// while rehashing so that the old one only ever shrinks.
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::iterator
+Dict<K, V, H, E, C, P>::setKeyValue(
+    key_type &&key, value_type &&value, size_type hash) {
+  table_type *table =
+      isRehashing() ? rehash_ : data_;
+  pointer entry = newEntry(std::move(key), std::move(value), hash);
+  size_type idx = hash & table->mask();
+  {
+    _DictStripeLock lock = lockStripe(hash);
+    table->size_++;
+    entry->next = table->at(idx);
+    table->at(idx) = entry;
+  }
+  expand();
+  return iterator(this, idx, entry, table == rehash_);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::rehash(size_type n) {
+  // Note that iterator is not safe rehashing.
+  if (!isRehashable() || !isRehashing() || rehasher_ != nullptr) { return; }
+  size_type moved = 0;
+  for (; moved != n && data_->size_ != 0; moved++) {
+    size_type visited_buckets = 0;
+    // Note that process_ can't overflow as there are
+    // more elements because data->size_ != 0
+    assert(data_->capacity_ > process_);
+    while (data_->at(process_) == nullptr) {
+      process_++, visited_buckets++;
+      if (visited_buckets == kRehashSliceLength) {
+        this->countRehashStep(moved);
+        return;
+      }
+    }
+    // Move all the elements from the old bucket to the new.
+    for (pointer entry = data_->at(process_);
+         entry != nullptr;) {
+      pointer next_entry = entry->next;
+      size_type index = entryHash(entry) & rehash_->mask();
+      entry->next = rehash_->at(index);
+      rehash_->at(index) = entry;
+      data_->size_--;
+      rehash_->size_++;
+      entry = next_entry;
+    }
+    data_->at(process_) = nullptr;
+    process_++;
+  }
+  this->countRehashStep(moved);
+  if (data_->size_ == 0) {
+    stopRehash();
+  }
+}
+
+// The share of a rehash that each lookup, insert and remove carries.
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::rehashStep() {
+  if (!isRehashing()) { return; }
+  switch (rehash_mode_) {
+    case RehashMode::kOnAccess:
+      rehash();
+      break;
+    case RehashMode::kCron:
+      break;
+    case RehashMode::kThread:
+      if (rehasher_ == nullptr) {
+        startRehashThread();
+      } else if (rehasher_->done.load(std::memory_order_acquire)) {
+        stopRehashThread();
+      }
+      break;
+  }
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+_DictStripeLock Dict<K, V, H, E, C, P>::lockStripe(size_type hash) const {
+  if (rehasher_ == nullptr) { return _DictStripeLock(nullptr, 0); }
+  size_type mask = std::min(data_->mask(), rehash_->mask());
+  return _DictStripeLock(rehasher_.get(), hash & mask);
+}
+
+// Pinned iterators stop the per-operation steps from moving entries but
+// cannot stop a thread, so none may be live when one starts.
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::startRehashThread() {
+  if (!isRehashing() || !isRehashable() || rehasher_ != nullptr) { return; }
+  rehasher_ = std::make_unique<_DictRehasher>();
+  rehasher_->thread = std::thread([this] { rehashInThread(); });
+}
+
+// Joins the helper thread, finished or not, and settles the table sizes
+// it left alone while it ran.
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::stopRehashThread() {
+  if (rehasher_ == nullptr) { return; }
+  rehasher_->stop.store(true, std::memory_order_relaxed);
+  rehasher_->thread.join();
+  data_->size_ -= rehasher_->moved;
+  rehash_->size_ += rehasher_->moved;
+  rehasher_.reset();
+  if (data_->size_ == 0) {
+    stopRehash();
+  }
+}
+
+// Runs on the helper thread. Table sizes are left to the owner, which
+// updates them concurrently; size() only reads their sum, which moving
+// entries does not change.
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::rehashInThread() {
+  _DictRehasher &rehasher = *rehasher_;
+  size_type mask = std::min(data_->mask(), rehash_->mask());
+  for (; process_ < data_->capacity_ &&
+      !rehasher.stop.load(std::memory_order_relaxed); process_++) {
+    _DictStripeLock lock(&rehasher, process_ & mask);
+    for (pointer entry = data_->at(process_); entry != nullptr;) {
+      pointer next_entry = entry->next;
+      size_type index = entryHash(entry) & rehash_->mask();
+      entry->next = rehash_->at(index);
+      rehash_->at(index) = entry;
+      rehasher.moved++;
+      entry = next_entry;
+    }
+    data_->at(process_) = nullptr;
+  }
+  rehasher.done.store(true, std::memory_order_release);
+}
+
+// start rehash
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::resize(size_type n) {
+  if (isRehashing() || data_->size_ > n) { return; }
+  size_type real_size = fixSize(n);
+  if (real_size == data_->capacity_) { return; }
+  assert(rehash_ == nullptr);
+  rehash_ = newTable(real_size);
+  this->countResize();
+  // Note that do not need to set process_ to 0,
+  // since it has been set to 0 in stopRehash and constructor.
+  if (rehash_mode_ == RehashMode::kThread) { startRehashThread(); }
+}
+
+// Moves every entry into a new table of n buckets (rounded up) in one
+// go, finishing any rehash in progress.
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::rebuild(size_type n) {
+  assert(isRehashable());
+  stopRehashThread();
+  table_type *table = newTable(fixSize(n));
+  this->countResize();
+  for (table_type *old : {data_, rehash_}) {
+    if (old == nullptr) { continue; }
+    for (size_type i = 0; i < old->capacity_; i++) {
+      for (pointer entry = old->at(i); entry != nullptr;) {
+        pointer next_entry = entry->next;
+        size_type index = entryHash(entry) & table->mask();
+        entry->next = table->at(index);
+        table->at(index) = entry;
+        entry = next_entry;
+      }
+      old->at(i) = nullptr;
+    }
+    table->size_ += old->size_;
+    freeTable(old);
+  }
+  data_ = table;
+  rehash_ = nullptr;
+  process_ = 0;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::stopRehash() {
+  std::swap(data_, rehash_);
+  freeTable(rehash_);
+  rehash_ = nullptr;
+  process_ = 0;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::acquireIterator() {
+  iter_num_++;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::releaseIterator() {
+  iter_num_--;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::table_type *
+Dict<K, V, H, E, C, P>::newTable(size_type n) {
+  table_type *table = allocator_.allocate(1);
+  allocator_.construct(table, n, Allocator<pointer>(allocator_));
+  return table;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::freeTable(table_type *table) {
+  for (pointer entry : table->table_) {
+    while (entry != nullptr) {
+      pointer next = entry->next;
+      freeEntry(entry);
+      entry = next;
+    }
+  }
+  allocator_.destroy(table);
+  allocator_.deallocate(table, 1);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::pointer
+Dict<K, V, H, E, C, P>::newEntry(
+    key_type &&key, value_type &&value, size_type hash) {
+  void *block = entries_.allocate();
+  pointer entry = new(block) entry_type(std::move(key), std::move(value));
+  entry->setHash(hash);
+  return entry;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::freeEntry(pointer entry) {
+  entry->~entry_type();
+  entries_.deallocate(entry);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+Dict<K, V, H, E, C, P>::Dict() : Dict(H()) {}
+
+template<class K, class V, class H, class E, bool C, class P>
+Dict<K, V, H, E, C, P>::Dict(std::pmr::memory_resource *resource)
+    : Dict(H(), E(), resource) {}
+
+template<class K, class V, class H, class E, bool C, class P>
+Dict<K, V, H, E, C, P>::Dict(
+    const H &hash, const E &equal, std::pmr::memory_resource *resource)
+    : process_(0), iter_num_(0), resizable(true),
+      rehash_mode_(RehashMode::kOnAccess), hash_(hash), equal_(equal),
+      allocator_(resource),
+      entries_(sizeof(entry_type), alignof(entry_type), resource) {
+  rehash_ = nullptr;
+  data_ = newTable(kInitialSize);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+Dict<K, V, H, E, C, P>::~Dict() {
+  stopRehashThread();
+  freeTable(data_);
+  if (rehash_ != nullptr) { freeTable(rehash_); }
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::iterator Dict<K, V, H, E, C, P>::begin() {
+  stopRehashThread();
+  iterator it(this, 0, data_->at(0));
+  if (it == nullptr) { ++it; }
+  return it;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::iterator Dict<K, V, H, E, C, P>::end() {
+  return iterator(this);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::size_type
+Dict<K, V, H, E, C, P>::size() const {
+  return data_->size_ +
+      (isRehashing() ? rehash_->size_ : 0);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+bool Dict<K, V, H, E, C, P>::empty() const {
+  // Not each size on its own: a helper thread leaves them off by the
+  // entries it has moved.
+  return size() == 0;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::setRehashMode(RehashMode mode) {
+  if (mode != RehashMode::kThread) { stopRehashThread(); }
+  rehash_mode_ = mode;
+  if (mode == RehashMode::kThread) { startRehashThread(); }
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::rehashMicroseconds(size_type n) {
+  if (rehasher_ != nullptr) {
+    if (rehasher_->done.load(std::memory_order_acquire)) {
+      stopRehashThread();
+    }
+    return;
+  }
+  std::chrono::steady_clock::time_point end =
+      std::chrono::steady_clock::now() + std::chrono::microseconds(n);
+  while (std::chrono::steady_clock::now() < end) {
+    if (isRehashing()) {
+      rehash(kRehashMsDuration);
+    } else {
+      break;
+    }
+  }
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::shrink() {
+  if (!resizable || isRehashing()) { return; }
+  size_type minimal = data_->size_;
+  if (minimal < kInitialSize) {
+    minimal = kInitialSize;
+  }
+  return resize(minimal);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::expand() {
+  if (isRehashing()) { return; }
+  if ((data_->size_ >= kResizeRatio * data_->capacity_) &&
+      (resizable || (data_->size_ >=
+          data_->capacity_ * kForceResizeRatio))) {
+    resize(data_->size_ * kGrowthFactor);
+  }
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::iterator
+Dict<K, V, H, E, C, P>::add(key_type key, value_type value) {
+  rehashStep();
+  size_type hash = hash_(key);
+  if (findIterIndex(key, hash) != nullptr) {
+    return iterator(this);
+  }
+  return setKeyValue(std::move(key), std::move(value), hash);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+void Dict<K, V, H, E, C, P>::reserve(size_type n) {
+  table_type *table = isRehashing() ? rehash_ : data_;
+  if (n <= kResizeRatio * table->capacity_) { return; }
+  rebuild(n);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::iterator
+Dict<K, V, H, E, C, P>::addUnique(key_type key, value_type value) {
+  table_type *table = isRehashing() ? rehash_ : data_;
+  if (size() >= kResizeRatio * table->capacity_ && isRehashable() &&
+      (resizable || size() >= table->capacity_ * kForceResizeRatio)) {
+    rebuild(size() * kGrowthFactor);
+    table = data_;
+  }
+  size_type hash = hash_(key);
+  pointer entry = newEntry(std::move(key), std::move(value), hash);
+  size_type idx = hash & table->mask();
+  {
+    _DictStripeLock lock = lockStripe(hash);
+    table->size_++;
+    entry->next = table->at(idx);
+    table->at(idx) = entry;
+  }
+  return iterator(this, idx, entry, table == rehash_);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+typename Dict<K, V, H, E, C, P>::iterator
+Dict<K, V, H, E, C, P>::replace(key_type key, value_type value) {
+  rehashStep();
+  size_type hash = hash_(key);
+  iterator iter = findIterIndex(key, hash);
+  if (iter != nullptr) {
+    iter->value = std::move(value);
+    return iter;
+  }
+  return setKeyValue(std::move(key), std::move(value), hash);
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+template<class Probe>
+bool Dict<K, V, H, E, C, P>::removeKey(const Probe &key) {
+  if (empty()) {
+    return false;
+  }
+  rehashStep();
+  size_type hash = hash_(key);
+  _DictStripeLock lock = lockStripe(hash);
+  table_type *table = data_;
+  size_type probes = 0;
+  for (size_type i = 0; i < 1 + isRehashing(); i++, table = rehash_) {
+    size_type idx = hash & table->mask();
+    for (pointer prev = nullptr, cur = table->at(idx);
+         cur != nullptr; cur = cur->next) {
+      probes++;
+      if (matches(cur, hash, key)) {
+        this->countLookup(probes);
+        if (prev != nullptr) {
+          prev->next = cur->next;
+        } else {
+          table->at(idx) = cur->next;
+        }
+        freeEntry(cur);
+        table->size_--;
+        return true;
+      }
+      prev = cur;
+    }
+  }
+  this->countLookup(probes);
+  return false;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
 template<class UnFn>
-size_type Dict::scan(size_type n, UnFn fn) {
+typename Dict<K, V, H, E, C, P>::size_type
+Dict<K, V, H, E, C, P>::scan(size_type n, UnFn fn) {
+  // fn may well modify the dict, so no stripe can be held around it.
+  stopRehashThread();
   if (empty()) { return 0; }
   if (isRehashing()) {
-    _DictTable *foo = data_, *bar = rehash_;
-    if (foo->size_ > bar->size_) {
+    table_type *foo = data_, *bar = rehash_;
+    if (foo->capacity_ > bar->capacity_) {
       foo = rehash_;
       bar = data_;
     }
@@ -188,7 +1234,7 @@ size_type Dict::scan(size_type n, UnFn fn) {
       n = reverseBit(n);
     } while (n & (foo_mask ^ bar_mask));
   } else {
-    _DictTable *table = data_;
+    table_type *table = data_;
     size_type mask = table->mask();
     for (pointer entry = table->at(n & mask);
          entry != nullptr; entry = entry->next) {
@@ -201,6 +1247,95 @@ size_type Dict::scan(size_type n, UnFn fn) {
   }
   return n;
 }
+
+template<class K, class V, class H, class E, bool C, class P>
+template<class UnFn>
+typename Dict<K, V, H, E, C, P>::size_type
+Dict<K, V, H, E, C, P>::scanPartition(size_type part, size_type parts,
+                                   size_type cursor, UnFn fn,
+                                   size_type count) const {
+  assert((parts & (parts - 1)) == 0 && part < parts);
+  if (empty()) { return 0; }
+  size_type low = parts - 1, v = (cursor & ~low) | part;
+  bool done = false;
+  // Bucket c of table, with vmask the mask of the table as read.
+  auto visit = [&](table_type *table, size_type c, size_type vmask) {
+    bool filter = vmask != table->mask();
+    for (pointer entry = table->at(c & table->mask());
+         entry != nullptr; entry = entry->next) {
+      if (!filter || (entryHash(entry) & vmask) == (c & vmask)) {
+        fn(entry);
+      }
+    }
+  };
+  // The increment runs from the high bits down, so it only reaches the
+  // part bits once every cursor of the part is done.
+  auto next = [&](size_type vmask) {
+    v |= ~vmask;
+    v = reverseBit(v);
+    v++;
+    v = reverseBit(v);
+    done = v == 0 || (v & low) != part;
+  };
+  if (isRehashing()) {
+    table_type *foo = data_, *bar = rehash_;
+    if (foo->capacity_ > bar->capacity_) { std::swap(foo, bar); }
+    size_type foo_mask = foo->mask() | low, bar_mask = bar->mask() | low;
+    for (; count > 0 && !done; count--) {
+      visit(foo, v, foo_mask);
+      do {
+        visit(bar, v, bar_mask);
+        next(bar_mask);
+      } while (!done && (v & (foo_mask ^ bar_mask)));
+    }
+    return done ? 0 : v & ~low;
+  }
+  // Consecutive cursors are buckets far apart, which the hardware does
+  // not prefetch. As in findMany, take them kGetManyBatch at a time:
+  // prefetch every bucket, then every chain head, then walk the chains.
+  size_type mask = data_->mask(), vmask = mask | low;
+  size_type batch[kGetManyBatch];
+  while (count > 0 && !done) {
+    size_type n = 0;
+    for (; n < kGetManyBatch && n < count && !done; n++) {
+      batch[n] = v;
+      __builtin_prefetch(&data_->at(v & mask));
+      next(vmask);
+    }
+    for (size_type i = 0; i < n; i++) {
+      if (pointer head = data_->at(batch[i] & mask)) {
+        __builtin_prefetch(head);
+      }
+    }
+    for (size_type i = 0; i < n; i++) { visit(data_, batch[i], vmask); }
+    count -= n;
+  }
+  return done ? 0 : v & ~low;
+}
+
+template<class K, class V, class H, class E, bool C, class P>
+template<class BiFn>
+void Dict<K, V, H, E, C, P>::scanParallel(size_type threads, BiFn fn) const {
+  if (threads == 0) { threads = 1; }
+  size_type parts = 1;
+  while (parts < threads * kScanPartsPerThread) { parts <<= 1; }
+  std::atomic<size_type> next_part(0);
+  auto work = [&](size_type worker) {
+    auto visit = [&](pointer entry) { fn(entry, worker); };
+    size_type part;
+    while ((part = next_part.fetch_add(1, std::memory_order_relaxed))
+        < parts) {
+      size_type cursor = 0;
+      do {
+        cursor = scanPartition(part, parts, cursor, visit, kScanCount);
+      } while (cursor != 0);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_type i = 1; i < threads; i++) { workers.emplace_back(work, i); }
+  work(0);
+  for (std::thread &worker : workers) { worker.join(); }
+}
 }
 
 #endif //REDIS_DICT_H
@@ -0,0 +1,85 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_EVICT_H
+#define REDIS_EVICT_H
+
+// For size_t
+#include <cstddef>
+// For uint64_t
+#include <cstdint>
+#include "common.h"
+#include "sds.h"
+
+namespace rd {
+
+// Which keys to evict once usedMemory() exceeds maxmemory, as in Redis'
+// maxmemory-policy. The volatile policies only pick keys with a TTL.
+enum class MaxmemoryPolicy {
+  kNoEviction,
+  kAllKeysLru,
+  kVolatileLru,
+  kAllKeysLfu,
+  kVolatileLfu,
+  kVolatileTtl,
+};
+
+enum class EvictResult {
+  // Memory is under the limit.
+  kOk,
+  // Still over the limit when the time budget ran out: call again.
+  kRunning,
+  // Nothing left that the policy allows evicting.
+  kFail,
+};
+
+struct MaxmemoryConfig {
+  // Bytes of usedMemory() above which keys are evicted; 0 is no limit.
+  size_t maxmemory = 0;
+  MaxmemoryPolicy policy = MaxmemoryPolicy::kNoEviction;
+  // Keys sampled per refill of the eviction pool.
+  size_type samples = 5;
+  // See Object::touchLfu and Object::lfuCounter.
+  int lfu_log_factor = 10;
+  int lfu_decay_time = 1;
+  // How long one performEvictions call may evict for.
+  size_type eviction_time_limit_us = 500;
+};
+
+struct _EvictionCandidate {
+  uint64_t idle;
+  String key;
+};
+
+// The best eviction candidates seen so far, after Redis' EvictionPoolLRU:
+// up to kSize keys in ascending order of idle, a score that grows with
+// how good a candidate a key is (idle time, 255 minus the LFU counter,
+// or the inverse of the expire time). Keeping candidates across samples
+// makes a handful of samples per eviction approximate true LRU closely.
+// Keys are copies and may be gone from the keyspace by the time they are
+// popped.
+class EvictionPool {
+ public:
+  static constexpr size_type kSize = 16;
+
+ private:
+  _EvictionCandidate entries_[kSize];
+  size_type size_;
+
+ public:
+  EvictionPool() : size_(0) {}
+
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  // Adds key unless the pool is full of better candidates, in which case
+  // the key is not even copied. A full pool drops its worst one.
+  void insert(StringView key, uint64_t idle);
+  // Removes and returns the best candidate; the pool must not be empty.
+  String pop();
+  void clear();
+};
+
+}  // namespace rd
+
+#endif //REDIS_EVICT_H
@@ -0,0 +1,49 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_EXPIRE_H
+#define REDIS_EXPIRE_H
+
+// For uint64_t
+#include <cstdint>
+#include "common.h"
+
+namespace rd {
+
+enum class ExpireCycle {
+  // Once per cron tick, with a budget of a share of the tick.
+  kSlow,
+  // Between ticks, e.g. before the event loop sleeps: short, and only
+  // while the last cycles left many stale keys behind.
+  kFast,
+};
+
+struct ExpireConfig {
+  // Slow cycles per second, Redis' hz.
+  size_type hz = 10;
+  // 1 to 10, Redis' active-expire-effort: higher effort checks more
+  // keys per loop, tolerates fewer stale keys and allows cycles more
+  // time.
+  size_type effort = 1;
+};
+
+struct ExpireStats {
+  // Keys deleted for having expired, on access or by a cycle.
+  size_type expired_keys = 0;
+  // Keys with a TTL looked at by cycles.
+  size_type sampled_keys = 0;
+  // Estimate of the percentage of keys with a TTL that have expired but
+  // are still in memory, averaged over the recent cycles.
+  double stale_perc = 0;
+  size_type cycles = 0;
+  // Cycles stopped by their time budget rather than by running out of
+  // stale keys.
+  size_type time_cap_reached = 0;
+  // Time spent in cycles.
+  uint64_t cycle_us = 0;
+};
+
+}  // namespace rd
+
+#endif //REDIS_EXPIRE_H
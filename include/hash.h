@@ -0,0 +1,45 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_HASH_H
+#define REDIS_HASH_H
+
+// For uint8_t, uint64_t
+#include <cstdint>
+// For size_t
+#include <cstddef>
+
+namespace rd {
+
+// Hash families for table keys. Both are keyed by the process-wide seed,
+// which is drawn from std::random_device on first use, so bucket layouts
+// cannot be predicted from outside the process.
+//
+// SipHash12 is SipHash-1-2, the keyed PRF Redis uses for its dicts; it
+// resists hash flooding and is the default for String keys.
+// WyHash is a wyhash-style multiply-mix hash, several times faster on
+// short keys but not a PRF; keep it for keys that never come from clients.
+struct SipHash12 {
+  static uint64_t hash(const void *data, size_t n);
+};
+
+struct WyHash {
+  static uint64_t hash(const void *data, size_t n);
+};
+
+template<int CRounds, int DRounds>
+uint64_t sipHash(const void *data, size_t n, const uint8_t key[16]);
+uint64_t wyHash(const void *data, size_t n, uint64_t seed);
+// Unkeyed MurmurHash64A. Only for data that must hash the same in every
+// process, such as HyperLogLog registers.
+uint64_t murmurHash64A(const void *data, size_t n, uint64_t seed);
+
+const uint8_t *hashSeed();
+// Replaces the seed, e.g. for reproducible tests. Tables filled before
+// the call keep buckets computed with the old seed.
+void setHashSeed(const uint8_t seed[16]);
+
+}  // namespace rd
+
+#endif //REDIS_HASH_H
@@ -0,0 +1,56 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_HYPERLOGLOG_H
+#define REDIS_HYPERLOGLOG_H
+
+// For uint64_t
+#include <cstdint>
+// For initializer_list
+#include <initializer_list>
+#include "sds.h"
+
+namespace rd {
+
+// HyperLogLog counters stored in a String, byte for byte in Redis' format:
+// a 16-byte header ("HYLL", encoding, cached cardinality) followed by
+// 2^14 six-bit registers, either packed (dense, 12 KB) or run-length
+// coded (sparse). The standard error is 1.04 / sqrt(2^14) = 0.81%.
+//
+// A counter starts sparse and is promoted to dense once the sparse form
+// grows past kHllSparseMaxBytes or a register exceeds what a sparse
+// opcode can hold. Every function rejects a String that is not a valid
+// counter instead of touching it.
+
+const size_t kHllRegisters = 1 << 14;
+const size_t kHllHeaderSize = 16;
+const size_t kHllDenseSize = kHllHeaderSize + kHllRegisters * 6 / 8;
+// Redis' hll-sparse-max-bytes default.
+const size_t kHllSparseMaxBytes = 3000;
+
+enum class HllEncoding { kDense, kSparse, kInvalid };
+
+HllEncoding hllEncoding(StringView hll);
+
+// PFADD: an empty hll is initialized first. Returns 1 if any register
+// changed, 0 if none did, -1 if hll is not a counter.
+int pfAdd(String &hll, const StringView *elements, size_t n);
+int pfAdd(String &hll, std::initializer_list<StringView> elements);
+
+// PFCOUNT of one counter; reads and refreshes the cached cardinality.
+// An empty hll counts as 0. False if hll is not a counter.
+bool pfCount(String &hll, uint64_t *card);
+// PFCOUNT of the union of several counters, computed on a merged copy.
+bool pfCount(const StringView *hlls, size_t n, uint64_t *card);
+bool pfCount(std::initializer_list<StringView> hlls, uint64_t *card);
+
+// PFMERGE: dest becomes the union of itself and srcs. dest stays sparse
+// when every input is sparse and the result fits. False, with dest left
+// untouched, if any input is not a counter.
+bool pfMerge(String &dest, const StringView *srcs, size_t n);
+bool pfMerge(String &dest, std::initializer_list<StringView> srcs);
+
+}  // namespace rd
+
+#endif //REDIS_HYPERLOGLOG_H
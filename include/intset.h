@@ -0,0 +1,104 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_INTSET_H
+#define REDIS_INTSET_H
+
+// For int16_t, int32_t, int64_t, uint32_t
+#include <cstdint>
+#include "common.h"
+
+namespace rd {
+
+// A set of integers as one sorted array, after Redis' intset.c. Every
+// element takes the width of the widest one, 2, 4 or 8 bytes: adding a
+// value that does not fit upgrades the whole array, and removals never
+// downgrade it. Lookups halve the array without branches down to 64
+// bytes, then rank those in vector registers (simd::Kernels::rank*).
+//
+// The array follows an 8-byte header in one zmalloc allocation, which
+// every add or remove replaces, so updates are O(n): meant for sets of a
+// few hundred elements, or for large sets built in one go and then only
+// read, such as the operands and results of intersect(), unite() and
+// difference().
+class IntSet {
+ public:
+  static constexpr uint32_t kEncInt16 = sizeof(int16_t);
+  static constexpr uint32_t kEncInt32 = sizeof(int32_t);
+  static constexpr uint32_t kEncInt64 = sizeof(int64_t);
+
+ private:
+  struct _Header {
+    uint32_t encoding;
+    uint32_t length;
+  };
+  _Header *is_;
+
+  // capacity elements of encoding, left uninitialized, for results
+  // written in place and then cut to their length with truncate().
+  IntSet(uint32_t encoding, size_type capacity);
+  void truncate(size_type length);
+
+  char *contents() const { return reinterpret_cast<char *>(is_ + 1); }
+  static long long getEncoded(const char *contents, size_type pos,
+                              uint32_t encoding);
+  void setEncoded(size_type pos, long long value);
+  // Where value is, or else where it would go.
+  bool search(long long value, size_type *pos) const;
+  // Replaces the blob by one of length elements of encoding, holding the
+  // old elements with a gap at pos if the set grows, or without the
+  // element at pos if it shrinks.
+  void rebuild(uint32_t encoding, size_type length, size_type pos);
+
+ public:
+  // The narrowest encoding that holds value.
+  static uint32_t valueEncoding(long long value);
+
+  IntSet();
+  // The distinct values among values[0, n), in one allocation.
+  IntSet(const long long *values, size_type n);
+  IntSet(IntSet &&other) noexcept;
+  IntSet &operator=(IntSet &&other) noexcept;
+  IntSet(const IntSet &) = delete;
+  IntSet &operator=(const IntSet &) = delete;
+  ~IntSet();
+
+  size_type size() const { return is_->length; }
+  bool empty() const { return is_->length == 0; }
+  uint32_t encoding() const { return is_->encoding; }
+  // Bytes allocated.
+  size_type bytes() const {
+    return sizeof(_Header) + size() * encoding();
+  }
+  // The element of rank pos, in ascending order.
+  long long get(size_type pos) const {
+    return getEncoded(contents(), pos, encoding());
+  }
+
+  // False if value is already present.
+  bool add(long long value);
+  bool remove(long long value);
+  bool contains(long long value) const;
+
+  // Set algebra, after SINTER, SUNION and SDIFF. The arrays are sorted, so
+  // these are merges, O(m + n). When one side is more than kGallopRatio
+  // times smaller, each of its elements is instead looked up in the other
+  // by galloping (exponential then binary) search, O(m log(n / m)).
+  // Intersections of similar sizes and one encoding compare whole vector
+  // registers of each side at a time (simd::Kernels::intersect*).
+  //
+  // An intersection takes the narrower encoding of the two, a union the
+  // wider, and a difference that of a.
+  static constexpr size_type kGallopRatio = 32;
+  static IntSet intersect(const IntSet &a, const IntSet &b);
+  // Of sets[0, n), smallest first, stopping once the result is empty.
+  static IntSet intersect(const IntSet *const *sets, size_type n);
+  static IntSet unite(const IntSet &a, const IntSet &b);
+  // The elements of a not in b.
+  static IntSet difference(const IntSet &a, const IntSet &b);
+};
+
+}  // namespace rd
+
+#endif //REDIS_INTSET_H
@@ -0,0 +1,105 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_LISTPACK_H
+#define REDIS_LISTPACK_H
+
+// For uint32_t
+#include <cstdint>
+#include "common.h"
+#include "sds.h"
+
+namespace rd {
+
+// An element read from a ListPack: a string, or an integer when sval is
+// nullptr. sval points into the listpack and is valid until it changes.
+struct ListPackValue {
+  const char *sval;
+  size_type slen;
+  long long lval;
+
+  // The element as text. An integer is formatted into buf, which must
+  // hold kLongStrSize bytes and outlive the view.
+  StringView view(char *buf) const;
+};
+
+// A list of strings and integers in one allocation, after Redis'
+// listpack.c: a header with the total bytes and the element count, the
+// elements back to back, and an end byte. Each element is an encoding
+// byte, data, and its own length backwards in 1 to 5 bytes, so the list
+// is walked from either end. Small integers take a single byte of data
+// or none, and strings that are the canonical form of a long long are
+// stored as integers. A three-field hash fits in some 40 bytes, where a
+// Dict needs hundreds.
+//
+// Elements are addressed by their byte offset, valid until the listpack
+// is modified; npos is past either end. Every insert or removal
+// reallocates and moves the tail, so operations are O(bytes): meant for
+// small collections. Memory comes from zmalloc.
+class ListPack {
+ public:
+  static constexpr size_type npos = static_cast<size_type>(-1);
+  // Total bytes (32 bits) and element count (16 bits, saturating).
+  static constexpr size_type kHeaderSize = 6;
+
+ private:
+  unsigned char *lp_;
+
+  uint32_t totalBytes() const;
+  size_type terminator() const { return totalBytes() - 1; }
+  // Bytes of the encoding and data of the element at p.
+  size_type entrySize(size_type p) const;
+  // Replaces remove_len bytes at p by an element of header and data, or
+  // by nothing if header_len is 0, in one new allocation. Returns p.
+  size_type splice(size_type p, size_type remove_len,
+                   const unsigned char *header, size_type header_len,
+                   const char *data, size_type data_len);
+  size_type insertString(size_type p, size_type remove_len, StringView s);
+  size_type insertInteger(size_type p, size_type remove_len,
+                          long long value);
+  void addCount(int delta);
+
+ public:
+  ListPack();
+  ListPack(ListPack &&other) noexcept;
+  ListPack &operator=(ListPack &&other) noexcept;
+  ListPack(const ListPack &) = delete;
+  ListPack &operator=(const ListPack &) = delete;
+  ~ListPack();
+
+  // O(1) while the count fits in 16 bits, O(n) past it.
+  size_type size() const;
+  bool empty() const { return totalBytes() == kHeaderSize + 1; }
+  // Bytes allocated.
+  size_type bytes() const { return totalBytes(); }
+
+  size_type first() const;
+  size_type last() const;
+  size_type next(size_type p) const;
+  size_type prev(size_type p) const;
+  // The element at index, counting from the end when negative, or npos.
+  size_type seek(long long index) const;
+  ListPackValue get(size_type p) const;
+
+  // Insert before the element at p, or at the end for npos, and return
+  // the offset of the new element.
+  size_type insert(size_type p, StringView s);
+  size_type insert(size_type p, long long value);
+  void append(StringView s) { insert(npos, s); }
+  void append(long long value) { insert(npos, value); }
+  // Overwrite the element at p; returns p.
+  size_type replace(size_type p, StringView s);
+  size_type replace(size_type p, long long value);
+  // Removes the element at p and returns the offset of the one after, or
+  // npos.
+  size_type remove(size_type p);
+  // The first element from p on equal to s, comparing one element then
+  // skipping skip, e.g. only the fields of field-value pairs with a skip
+  // of 1. An integer element matches the canonical text of its value.
+  size_type find(size_type p, StringView s, size_type skip = 0) const;
+};
+
+}  // namespace rd
+
+#endif //REDIS_LISTPACK_H
@@ -0,0 +1,121 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_OBJECT_H
+#define REDIS_OBJECT_H
+
+// For uint8_t, uint32_t
+#include <cstdint>
+#include "sds.h"
+#include "zmalloc.h"
+
+namespace rd {
+
+// A keyspace value, like Redis' robj. A string value whose text is the
+// canonical form of a long long (see string2ll) is stored as the number
+// itself, kEncodingInt; values 0 .. kSharedIntegers - 1 are not even
+// allocated but handed out from a pool of immutable shared objects.
+//
+// Objects are reference counted and created through the static factories;
+// decrRef() frees an object once the last reference is gone and ignores
+// shared ones.
+//
+// Like robj, an object also keeps 24 bits of access history for eviction:
+// either the lruClock() of its last access, or, under an LFU policy, the
+// minute of its last access in the high 16 bits and a logarithmic access
+// counter in the low 8 (see touchLfu). The shared objects never record
+// accesses, as other threads may read them.
+class Object : public ZmallocNew {
+ public:
+  // The string encodings, then those of the collection types (see
+  // collections.h).
+  enum Encoding : uint8_t {
+    kEncodingRaw,
+    kEncodingInt,
+    kEncodingListPack,
+    kEncodingIntSet,
+    kEncodingHashTable,
+    kEncodingSkipList,
+    kEncodingLinkedList,
+  };
+
+  static constexpr long long kSharedIntegers = 10000;
+  static constexpr uint32_t kSharedRefCount = UINT32_MAX;
+  static constexpr uint32_t kLruClockMax = (1u << 24) - 1;
+  // Milliseconds per lruClock() tick.
+  static constexpr uint64_t kLruClockResolution = 1000;
+  // The counter of a new key, so it is not evicted before it had a
+  // chance to be accessed again.
+  static constexpr uint8_t kLfuInitValue = 5;
+
+ private:
+  uint32_t encoding_ : 8;
+  uint32_t lru_ : 24;
+  uint32_t refcount_;
+  union {
+    long long int_;
+    String str_;
+  };
+
+  explicit Object(long long value);
+  explicit Object(String &&str);
+
+  static Object *sharedIntegers();
+  uint8_t decayedCounter(uint16_t now, int decay_minutes) const;
+
+ public:
+  Object(const Object &) = delete;
+  Object &operator=(const Object &) = delete;
+  ~Object();
+
+  static Object *createString(StringView s);
+  static Object *createString(String &&s);
+  // Values below kSharedIntegers come from the shared pool unless
+  // shareable is false, e.g. for a keyspace that evicts by access.
+  static Object *createInt(long long value, bool shareable = true);
+
+  Encoding encoding() const { return static_cast<Encoding>(encoding_); }
+  bool isShared() const { return refcount_ == kSharedRefCount; }
+  uint32_t refCount() const { return refcount_; }
+  void incrRef();
+  void decrRef();
+
+  // The current time in kLruClockResolution ticks, wrapping at
+  // kLruClockMax.
+  static uint32_t lruClock();
+  // The current time in minutes, wrapping at 16 bits.
+  static uint16_t lfuMinutes();
+  uint32_t lru() const { return lru_; }
+  void setLru(uint32_t lru) { lru_ = lru & kLruClockMax; }
+  // Records an access at lruClock().
+  void touchLru();
+  // Milliseconds since the last touchLru(), at kLruClockResolution.
+  uint64_t idleMilliseconds() const;
+  // Starts the LFU counter of a new key at kLfuInitValue.
+  void initLfu();
+  // Records an access: decays the counter (see lfuCounter), then bumps it
+  // with probability 1 / ((counter - kLfuInitValue) * log_factor + 1),
+  // so that it takes about a million accesses to saturate at 255 with a
+  // log_factor of 10.
+  void touchLfu(int log_factor, int decay_minutes);
+  // The LFU counter, less one for every decay_minutes since the last
+  // access.
+  uint8_t lfuCounter(int decay_minutes) const;
+
+  bool getLongLong(long long *value) const;
+  String toString() const;
+  size_type length() const;
+
+  // INCRBY/DECRBY. Replaces obj by an object holding its value plus incr
+  // and returns true, or returns false when the value is not an integer
+  // or the result would overflow. An unshared int-encoded object is
+  // updated in place, and a shared one moves to the pool object of the
+  // result below kSharedIntegers, so neither case parses, formats or
+  // allocates. The result is shared only if obj was.
+  static bool incrBy(Object *&obj, long long incr);
+};
+
+}  // namespace rd
+
+#endif //REDIS_OBJECT_H
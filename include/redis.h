@@ -5,7 +5,23 @@
 #ifndef REDIS_REDIS_H
 #define REDIS_REDIS_H
 #include "adlist.h"
+#include "bitops.h"
+#include "collections.h"
+#include "concurrentdict.h"
+#include "db.h"
 #include "dict.h"
+#include "evict.h"
+#include "expire.h"
+#include "hash.h"
+#include "hyperloglog.h"
+#include "intset.h"
+#include "listpack.h"
+#include "object.h"
 #include "sds.h"
+#include "simd.h"
 #include "skiplist.h"
+#include "slab.h"
+#include "swisstable.h"
+#include "util.h"
+#include "zmalloc.h"
 #endif //REDIS_REDIS_H
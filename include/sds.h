@@ -5,6 +5,10 @@
 #ifndef REDIS_SDS_H
 #define REDIS_SDS_H
 
+// For uint8_t .. uint64_t
+#include <cstdint>
+// For atomic reference counts
+#include <atomic>
 // For strlen, strchr
 #include <cstring>
 // For partial specialization std::hash
@@ -12,8 +16,24 @@
 // For ostream
 #include <iostream>
 #include "common.h"
+#include "hash.h"
+#include "zmalloc.h"
 
 namespace rd {
+class StringView;
+
+// A String is a single pointer-sized handle plus an inline tail.
+//
+// Short strings (up to kInlineCapacity bytes) live inside the object. The
+// last byte of the object then holds the spare capacity, so it doubles as
+// the terminator of a full buffer.
+//
+// Longer strings live in one heap block laid out like Redis' sds: a packed
+// header with the length and allocated capacity, a flags byte, then the
+// characters. sds_ points at the characters and sds_[-1] is the flags byte,
+// whose low bits select how wide the length fields are (_Header<uint8_t>
+// up to _Header<uint64_t>), so a 100-byte value pays 3 bytes of header.
+// In this mode the last byte of the object is kHeapTag.
 class String {
  public:
   typedef char value_type;
@@ -24,12 +44,57 @@ class String {
   typedef const char &const_reference;
   typedef ptrdiff_t difference_type;
 
+  static constexpr size_type kInlineCapacity = 2 * sizeof(iterator) - 1;
+  // Growth doubles the capacity until it reaches kMaxPrealloc, after which
+  // it only adds kMaxPrealloc bytes of slack at a time.
+  static constexpr size_type kMaxPrealloc = 1024 * 1024;
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
  private:
-  iterator begin_{};
-  iterator end_{};
-  iterator storage_end_{};
+  template<class T>
+  struct __attribute__((__packed__)) _Header {
+    T len;
+    T alloc;
+    unsigned char flags;
+  };
+
+  static constexpr unsigned char kHeapTag = 0x80;
+  static constexpr unsigned char kHeader8 = 1;
+  static constexpr unsigned char kHeader16 = 2;
+  static constexpr unsigned char kHeader32 = 3;
+  static constexpr unsigned char kHeader64 = 4;
+  static constexpr unsigned char kHeaderTypeMask = 7;
 
-//  Allocator<value_type> allocator_;
+  union {
+    iterator sds_;
+    value_type local_[kInlineCapacity + 1];
+  };
+
+  unsigned char tag() const {
+    return static_cast<unsigned char>(local_[kInlineCapacity]);
+  }
+  iterator ptr() const {
+    return isInline() ? const_cast<iterator>(local_) : sds_;
+  }
+  template<class T>
+  _Header<T> *header() const {
+    return reinterpret_cast<_Header<T> *>(sds_ - sizeof(_Header<T>));
+  }
+  size_type heapSize() const;
+  size_type heapCapacity() const;
+  static unsigned char headerType(size_type capacity);
+  static size_type headerSize(unsigned char type);
+  static iterator allocate(size_type capacity);
+  static void deallocate(iterator s);
+
+  void initInline();
+  void markInline() {
+    local_[kInlineCapacity] = static_cast<value_type>(kInlineCapacity);
+  }
+  void setSize(size_type n);
+  void adopt(iterator s);
+  void release();
+  void moveInline();
 
   template<class InIt>
   void allocateAndCopy(InIt first, InIt last);
@@ -44,19 +109,26 @@ class String {
   String &assignAux(InIt ite, size_type n, std::__true_type);
 
  public:
-  String() : begin_(nullptr), end_(nullptr), storage_end_(nullptr) {}
+  String() { initInline(); }
   explicit String(const char *s);
   String(const String &string);
+  String(String &&string) noexcept;
   template<class InIt>
   String(InIt first, InIt last);
   String(const char *s, size_type n);
+  explicit String(StringView view);
   ~String();
 
-  iterator begin() const { return begin_; }
-  iterator end() const { return end_; }
-  size_type capacity() const { return storage_end_ - begin_; }
-  size_type size() const { return end_ - begin_; }
-  size_type empty() const { return end_ == begin_; }
+  bool isInline() const { return tag() != kHeapTag; }
+  iterator begin() const { return ptr(); }
+  iterator end() const { return ptr() + size(); }
+  size_type capacity() const {
+    return isInline() ? kInlineCapacity : heapCapacity();
+  }
+  size_type size() const {
+    return isInline() ? kInlineCapacity - tag() : heapSize();
+  }
+  size_type empty() const { return size() == 0; }
   void clear();
   const char *data() const;
 
@@ -69,29 +141,65 @@ class String {
   String &assign(InIt first, InIt last);
   void resize(size_type n);
   String substr(size_type pos, size_type offset) const;
+  StringView view(size_type pos = 0, size_type n = npos) const;
   void trim(const char *set);
+  size_type find(char c, size_type pos = 0) const;
+  size_type find(StringView view, size_type pos = 0) const;
+  int caseCompare(const String &string) const;
+  void reserve(size_type n);
+  iterator makeRoomFor(size_type n);
+  void incrLen(difference_type n);
+  void shrinkToFit();
+  void swap(String &string) noexcept;
 
   String &operator=(const String &string);
+  String &operator=(String &&string) noexcept;
   String &operator=(const char *s);
   String &operator+=(const char *s);
   String &operator+=(const String &string);
+  String &operator+=(String &&string);
   friend String operator+(const String &lhs, const String &rhs);
   friend String operator+(const String &lhs, const char *rhs);
   friend String operator+(const char *lhs, const String &rhs);
+  friend String operator+(String &&lhs, const String &rhs);
+  friend String operator+(String &&lhs, const char *rhs);
+  template<class... Args>
+  friend String concat(const Args &... args);
   friend bool operator==(const rd::String &lhs, const rd::String &rhs);
   friend bool operator!=(const rd::String &lhs, const rd::String &rhs);
   friend bool operator<(const rd::String &lhs, const rd::String &rhs);
   friend std::ostream &operator<<(std::ostream &os, const rd::String &string);
 };
 
+inline String::size_type String::heapSize() const {
+  switch (static_cast<unsigned char>(sds_[-1]) & kHeaderTypeMask) {
+    case kHeader8: return header<uint8_t>()->len;
+    case kHeader16: return header<uint16_t>()->len;
+    case kHeader32: return header<uint32_t>()->len;
+    default: return header<uint64_t>()->len;
+  }
+}
+inline String::size_type String::heapCapacity() const {
+  switch (static_cast<unsigned char>(sds_[-1]) & kHeaderTypeMask) {
+    case kHeader8: return header<uint8_t>()->alloc;
+    case kHeader16: return header<uint16_t>()->alloc;
+    case kHeader32: return header<uint32_t>()->alloc;
+    default: return header<uint64_t>()->alloc;
+  }
+}
+
 template<class InIt>
 void String::allocateAndCopy(InIt first, InIt last) {
   auto len = static_cast<size_type>(std::distance(first, last));
-//  begin_ = allocator_.allocate(len + 1);
-  begin_ = new value_type[len + 1];
-  std::uninitialized_copy(first, last, begin_);
-  storage_end_ = end_ = begin_ + len;
-  *end_ = 0;
+  if (len <= kInlineCapacity) {
+    initInline();
+    std::uninitialized_copy(first, last, local_);
+  } else {
+    iterator buffer = allocate(len);
+    std::uninitialized_copy(first, last, buffer);
+    adopt(buffer);
+  }
+  setSize(len);
 }
 template<class InIt>
 void String::constructAux(InIt first, InIt last, std::__false_type) {
@@ -108,39 +216,42 @@ String::String(InIt first, InIt last) {
 template<class InIt>
 String &String::append(InIt first, InIt last) {
   auto offset = static_cast<size_type>(std::distance(first, last));
-  if (offset < storage_end_ - end_) {
-    while (first != last)
-      *end_++ = *first++;
-    *end_ = 0;
+  size_type len = size();
+  if (offset <= capacity() - len) {
+    std::uninitialized_copy(first, last, ptr() + len);
   } else {
-    size_type newCapacity = getNewCapacity(offset);
-//    iterator newBeginIterator = allocator_.allocate(newCapacity + 1);
-    auto newBeginIterator = new value_type[newCapacity + 1];
-    end_ = std::uninitialized_copy(begin_, end_, newBeginIterator);
-    end_ = std::uninitialized_copy(first, last, end_);
-    delete[] begin_;
-//    allocator_.deallocate(begin_, capacity() + 1);
-    begin_ = newBeginIterator;
-    *end_ = 0;
-    storage_end_ = newBeginIterator + newCapacity;
+    // Copy into the new buffer before releasing the old one, so that
+    // [first, last) may point into this string.
+    iterator newBegin = allocate(getNewCapacity(offset));
+    auto newEnd = std::uninitialized_copy(ptr(), ptr() + len, newBegin);
+    std::uninitialized_copy(first, last, newEnd);
+    release();
+    adopt(newBegin);
   }
+  setSize(len + offset);
   return *this;
 }
 template<class InIt>
 String &String::assignAux(InIt first, InIt last, std::__false_type) {
   auto len = static_cast<size_type>(std::distance(first, last));
-  if (len < capacity()) {
-    std::uninitialized_copy(first, last, begin_);
-    end_ = begin_ + len;
-    *end_ = 0;
+  if (len <= kInlineCapacity) {
+    // Copying forward into local_ overwrites sds_, so keep the old
+    // buffer aside until the (possibly aliased) source has been read.
+    iterator old = isInline() ? nullptr : sds_;
+    std::copy(first, last, local_);
+    if (old != nullptr) {
+      deallocate(old);
+      markInline();
+    }
+  } else if (!isInline() && len <= capacity()) {
+    std::copy(first, last, sds_);
   } else {
-//    allocator_.deallocate(begin_, capacity() + 1);
-//    begin_ = allocator_.allocate(len + 1);
-    delete[] begin_;
-    begin_ = new value_type[len + 1];
-    storage_end_ = end_ = std::uninitialized_copy(first, last, begin_);
-    *end_ = 0;
+    iterator buffer = allocate(len);
+    std::uninitialized_copy(first, last, buffer);
+    release();
+    adopt(buffer);
   }
+  setSize(len);
   return *this;
 }
 template<class InIt>
@@ -149,16 +260,195 @@ String &String::assignAux(InIt ite, String::size_type n, std::__true_type) {
 }
 template<class InIt>
 String &String::assign(InIt first, InIt last) {
-  return assignAux(first, last, std::__is_integer<InIt>::__type());
+  return assignAux(first, last, typename std::__is_integer<InIt>::__type());
+}
+
+// A non-owning window [data, data + size) into bytes owned elsewhere,
+// usually a String or a request buffer. Lookups and parsing can slice and
+// compare views without copying; a view must not outlive its bytes.
+class StringView {
+ public:
+  typedef char value_type;
+  typedef const char *iterator;
+  typedef const char *const_iterator;
+  typedef rd::size_type size_type;
+
+  static constexpr size_type npos = String::npos;
+
+ private:
+  const char *data_;
+  size_type size_;
+
+ public:
+  StringView() : data_(""), size_(0) {}
+  StringView(const char *s, size_type n) : data_(s), size_(n) {}
+  StringView(const char *s) : data_(s), size_(strlen(s)) {} // NOLINT
+  StringView(const String &s) : data_(s.data()), size_(s.size()) {} // NOLINT
+
+  const char *data() const { return data_; }
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  iterator begin() const { return data_; }
+  iterator end() const { return data_ + size_; }
+  char operator[](size_type n) const { return data_[n]; }
+
+  StringView substr(size_type pos, size_type n = npos) const;
+  void removePrefix(size_type n) { data_ += n, size_ -= n; }
+  void removeSuffix(size_type n) { size_ -= n; }
+  size_type find(char c, size_type pos = 0) const;
+  size_type find(StringView view, size_type pos = 0) const;
+  int compare(StringView view) const;
+
+  friend bool operator==(StringView lhs, StringView rhs);
+  friend bool operator!=(StringView lhs, StringView rhs) {
+    return !(lhs == rhs);
+  }
+  friend bool operator<(StringView lhs, StringView rhs) {
+    return lhs.compare(rhs) < 0;
+  }
+  friend std::ostream &operator<<(std::ostream &os, StringView view) {
+    return os.write(view.data(), view.size());
+  }
+};
+
+inline StringView String::view(size_type pos, size_type n) const {
+  return StringView(*this).substr(pos, n);
 }
 
+// An immutable, reference-counted String. Copies share one buffer, so a
+// value can be held by the keyspace, a reply buffer and the replication
+// backlog at once; mutate() first detaches a private copy if the buffer
+// is shared (copy on write).
+class SharedString {
+ private:
+  struct _Block : ZmallocNew {
+    std::atomic<size_type> refs;
+    String str;
+  };
+  _Block *block_;
+
+  void unref();
+
+ public:
+  SharedString() : block_(nullptr) {}
+  explicit SharedString(String str);
+  SharedString(const SharedString &shared);
+  SharedString(SharedString &&shared) noexcept : block_(shared.block_) {
+    shared.block_ = nullptr;
+  }
+  ~SharedString() { unref(); }
+  SharedString &operator=(const SharedString &shared);
+  SharedString &operator=(SharedString &&shared) noexcept;
+
+  const String &str() const;
+  StringView view() const { return StringView(str()); }
+  const char *data() const { return str().data(); }
+  size_type size() const { return str().size(); }
+  size_type useCount() const {
+    return block_ == nullptr ? 0 : block_->refs.load();
+  }
+  String &mutate();
+};
+
+inline const char *_pieceBegin(const String &s) { return s.begin(); }
+inline const char *_pieceEnd(const String &s) { return s.end(); }
+inline const char *_pieceBegin(const char *s) { return s; }
+inline const char *_pieceEnd(const char *s) { return s + strlen(s); }
+inline const char *_pieceBegin(StringView s) { return s.begin(); }
+inline const char *_pieceEnd(StringView s) { return s.end(); }
+
+// Concatenates any mix of String, StringView and C strings with a single
+// allocation, since the total length is known before the first byte is
+// copied.
+template<class... Args>
+String concat(const Args &... args) {
+  String ret;
+  ret.reserve((static_cast<size_type>(
+      _pieceEnd(args) - _pieceBegin(args)) + ... + 0));
+  (ret.append(_pieceBegin(args), _pieceEnd(args)), ...);
+  return ret;
+}
+
+// Hashes the bytes of a String with one of the families in hash.h. A
+// StringView of the same bytes hashes identically, so a view can probe a
+// table keyed by Strings.
+template<class Family = SipHash12>
+struct StringHasher {
+  typedef void is_transparent;
+
+  size_t operator()(const String &key) const {
+    return Family::hash(key.data(), key.size());
+  }
+  size_t operator()(StringView key) const {
+    return Family::hash(key.data(), key.size());
+  }
+};
+
+// A String that remembers its hash after the first call to hash(), so a
+// key object that is looked up or rehashed repeatedly is only hashed
+// once. Two HashedStrings whose hashes are both known compare unequal
+// without touching the bytes when the hashes differ.
+class HashedString {
+ private:
+  String str_;
+  mutable size_t hash_;
+  mutable bool hashed_;
+
+ public:
+  HashedString() : hash_(0), hashed_(false) {}
+  explicit HashedString(const String &str)
+      : str_(str), hash_(0), hashed_(false) {}
+  explicit HashedString(String &&str)
+      : str_(std::move(str)), hash_(0), hashed_(false) {}
+  explicit HashedString(const char *s)
+      : str_(s), hash_(0), hashed_(false) {}
+
+  const String &str() const { return str_; }
+  bool hashed() const { return hashed_; }
+  size_t hash() const {
+    if (!hashed_) {
+      hash_ = StringHasher<>()(str_);
+      hashed_ = true;
+    }
+    return hash_;
+  }
+
+  friend bool operator==(const HashedString &lhs, const HashedString &rhs) {
+    if (lhs.hashed_ && rhs.hashed_ && lhs.hash_ != rhs.hash_) {
+      return false;
+    }
+    return lhs.str_ == rhs.str_;
+  }
+  friend bool operator!=(const HashedString &lhs, const HashedString &rhs) {
+    return !(lhs == rhs);
+  }
+};
+
 }
 
 namespace std {
+// Transparent, so String-keyed tables can be probed with a StringView.
 template<>
 struct hash<rd::String> {
+  typedef void is_transparent;
+
   std::size_t operator()(const rd::String &key) const {
-    return std::_Hash_impl::hash(key.data(), key.size());
+    return rd::StringHasher<>()(key);
+  }
+  std::size_t operator()(rd::StringView key) const {
+    return rd::StringHasher<>()(key);
+  }
+};
+template<>
+struct hash<rd::StringView> {
+  std::size_t operator()(rd::StringView key) const {
+    return rd::StringHasher<>()(key);
+  }
+};
+template<>
+struct hash<rd::HashedString> {
+  std::size_t operator()(const rd::HashedString &key) const {
+    return key.hash();
   }
 };
 }
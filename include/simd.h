@@ -0,0 +1,72 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_SIMD_H
+#define REDIS_SIMD_H
+
+// For size_t
+#include <cstddef>
+// For int16_t, int32_t, int64_t
+#include <cstdint>
+
+namespace rd {
+namespace simd {
+
+// Byte kernels behind rd::String, and integer kernels behind rd::IntSet.
+// Every kernel has a scalar version plus, on x86-64, an SSE2 and an AVX2
+// version; the widest one the CPU supports is picked the first time any
+// kernel runs.
+enum class Level { kScalar, kSSE2, kAVX2 };
+
+struct Kernels {
+  bool (*equal)(const char *lhs, const char *rhs, size_t n);
+  // First byte c in [s, s + n), or nullptr.
+  const char *(*findChar)(const char *s, size_t n, char c);
+  // First occurrence of needle[0, m) in s[0, n), m >= 2, or nullptr.
+  const char *(*find)(const char *s, size_t n, const char *needle, size_t m);
+  // Length of the prefix (span) or suffix (rspan) of s[0, n) made of
+  // bytes of set[0, m) or '\0', matching how strchr treats the set.
+  size_t (*span)(const char *s, size_t n, const char *set, size_t m);
+  size_t (*rspan)(const char *s, size_t n, const char *set, size_t m);
+  // Compares s1[0, n) and s2[0, n) ignoring ASCII case, like strncasecmp.
+  int (*caseCompare)(const char *lhs, const char *rhs, size_t n);
+  // Number of set bits in s[0, n).
+  size_t (*popcount)(const char *s, size_t n);
+  // dst[i] = dst[i] op src[i] for i in [0, n); bitNot flips dst in place.
+  void (*bitAnd)(char *dst, const char *src, size_t n);
+  void (*bitOr)(char *dst, const char *src, size_t n);
+  void (*bitXor)(char *dst, const char *src, size_t n);
+  void (*bitNot)(char *dst, size_t n);
+  // How many of a[0, n) are smaller than key: the position of key in a
+  // sorted a. Meant for the last few dozen elements of a search.
+  size_t (*rank16)(const int16_t *a, size_t n, int16_t key);
+  size_t (*rank32)(const int32_t *a, size_t n, int32_t key);
+  size_t (*rank64)(const int64_t *a, size_t n, int64_t key);
+  // Writes the elements common to the sorted, duplicate-free a[0, na)
+  // and b[0, nb) to out, in order, and returns how many. out must have
+  // room for min(na, nb) elements, all of which may be written. The
+  // vector versions compare a block of a against a block of b, every
+  // element against every other, then advance past the block with the
+  // smaller maximum.
+  size_t (*intersect16)(const int16_t *a, size_t na,
+                        const int16_t *b, size_t nb, int16_t *out);
+  size_t (*intersect32)(const int32_t *a, size_t na,
+                        const int32_t *b, size_t nb, int32_t *out);
+  size_t (*intersect64)(const int64_t *a, size_t na,
+                        const int64_t *b, size_t nb, int64_t *out);
+};
+
+const Kernels &kernels();
+Level level();
+// Forces a narrower (or the widest supported) level; returns false when
+// the CPU lacks it. Not thread safe, meant for tests and benchmarks.
+bool setLevel(Level level);
+
+bool hasAVX2();
+bool hasPopcnt();
+
+}  // namespace simd
+}  // namespace rd
+
+#endif //REDIS_SIMD_H
@@ -1,6 +1,7 @@
 #include <experimental/memory_resource>
 #include "common.h"
 #include "sds.h"
+#include "zmalloc.h"
 
 #ifndef REDIS_SKIPLIST_H_
 #define REDIS_SKIPLIST_H_
@@ -8,19 +9,19 @@ namespace rd {
 
 struct _SkipListNode;
 
-struct _SkipListLevel {
+struct _SkipListLevel : ZmallocNew {
   _SkipListNode *next;
   size_type span;
   _SkipListLevel() : next(nullptr), span(0) {}
 };
 
-struct _SkipListNode {
+struct _SkipListNode : ZmallocNew {
   String elem;
   double score;
   _SkipListNode *prev;
   _SkipListLevel *levels;
 
-  _SkipListNode(int level_num, double score, const String &elem);
+  _SkipListNode(int level_num, double score, String elem);
   ~_SkipListNode();
 };
 
@@ -51,7 +52,10 @@ class _SkipListIterator {
   bool operator!=(const _SkipListIterator &it) const;
 };
 
-class SkipList {
+// Elements ordered by score, then by elem, after Redis' zskiplist. Each
+// level links a quarter of the nodes of the one below, so lookups, inserts
+// and removals take O(log n) expected steps.
+class SkipList : public ZmallocNew {
  public:
   typedef rd::size_type size_type;
   typedef _SkipListNode value_type;
@@ -71,9 +75,20 @@ class SkipList {
 
  public:
   SkipList();
+  SkipList(const SkipList &) = delete;
+  SkipList &operator=(const SkipList &) = delete;
   ~SkipList();
 
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  iterator begin() { return iterator(head_->levels[0].next); }
+  iterator end() { return iterator(); }
+
+  // The caller keeps elems unique, as a sorted set does with a dict.
   iterator insert(const String &elem, double score);
+  iterator insert(String &&elem, double score);
+  // Removes the node holding elem with score; false if there is none.
+  bool remove(StringView elem, double score);
 };
 
 }  // namespace rd
@@ -0,0 +1,93 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_SLAB_H
+#define REDIS_SLAB_H
+
+// For std::max_align_t
+#include <cstddef>
+// For std::pmr::memory_resource
+#include <memory_resource>
+#include "common.h"
+
+namespace rd {
+
+// A pool of fixed-size blocks, e.g. the entries of one Dict. Blocks are
+// carved out of chunks taken from an upstream memory_resource; freed
+// blocks go onto an intrusive free list and are handed out again before
+// any new chunk is touched, so a table under insert/delete churn reuses
+// the same memory instead of fragmenting the heap. Chunks double in size
+// up to kMaxChunkBlocks and go back upstream only when the Slab is
+// destroyed or release() finds every block free. Not thread safe: one
+// Slab per owner.
+class Slab {
+ public:
+  static constexpr size_type kMinChunkBlocks = 32;
+  static constexpr size_type kMaxChunkBlocks = 4096;
+
+ private:
+  struct _FreeBlock {
+    _FreeBlock *next;
+  };
+  struct _Chunk {
+    _Chunk *next;
+    size_type bytes;
+  };
+
+  std::pmr::memory_resource *upstream_;
+  size_type block_size_;
+  size_type align_;
+  _FreeBlock *free_;
+  _Chunk *chunks_;
+  // Uncarved tail of the newest chunk.
+  char *cursor_, *limit_;
+  size_type next_blocks_;
+  size_type used_;
+  size_type capacity_;
+
+  void grow();
+  void freeChunks();
+
+ public:
+  explicit Slab(
+      size_type size, size_type align = alignof(std::max_align_t),
+      std::pmr::memory_resource *upstream =
+      std::pmr::get_default_resource());
+  Slab(const Slab &) = delete;
+  Slab &operator=(const Slab &) = delete;
+  ~Slab();
+
+  void *allocate() {
+    if (free_ != nullptr) {
+      _FreeBlock *block = free_;
+      free_ = block->next;
+      used_++;
+      return block;
+    }
+    if (cursor_ == limit_) { grow(); }
+    void *block = cursor_;
+    cursor_ += block_size_;
+    used_++;
+    return block;
+  }
+  void deallocate(void *p) {
+    auto block = static_cast<_FreeBlock *>(p);
+    block->next = free_;
+    free_ = block;
+    used_--;
+  }
+  // Returns every chunk upstream; only allowed while no block is in use.
+  bool release();
+
+  size_type blockSize() const { return block_size_; }
+  // Blocks handed out and not yet freed.
+  size_type used() const { return used_; }
+  // Blocks in all chunks, used or not.
+  size_type capacity() const { return capacity_; }
+  std::pmr::memory_resource *upstream() const { return upstream_; }
+};
+
+}  // namespace rd
+
+#endif //REDIS_SLAB_H
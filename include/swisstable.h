@@ -0,0 +1,650 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_SWISSTABLE_H
+#define REDIS_SWISSTABLE_H
+
+// For assert
+#include <cassert>
+// For steady_clock
+#include <chrono>
+// For uint32_t
+#include <cstdint>
+// For memset
+#include <cstring>
+// For std::hash, std::equal_to
+#include <functional>
+// For std::pmr::memory_resource
+#include <memory_resource>
+// For std::conditional_t, std::void_t
+#include <type_traits>
+#include "dict.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rd {
+
+// One control byte per slot: kEmpty, kDeleted, or the low 7 bits of the
+// hash (h2) of the key stored there.
+const int8_t kSwissEmpty = -128;
+const int8_t kSwissDeleted = -2;
+const size_type kSwissGroupWidth = 16;
+
+// The 16 control bytes of a group, matched all at once: one SSE2 compare
+// and movemask gives a bitmask of candidate slots. A 16-byte group is a
+// single SSE2 register, so there is nothing for AVX2 to add here.
+class _SwissGroup {
+ private:
+#if defined(__SSE2__)
+  __m128i ctrl_;
+#else
+  const int8_t *ctrl_;
+#endif
+
+ public:
+#if defined(__SSE2__)
+  explicit _SwissGroup(const int8_t *ctrl)
+      : ctrl_(_mm_load_si128(reinterpret_cast<const __m128i *>(ctrl))) {}
+  uint32_t match(int8_t h2) const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2))));
+  }
+  uint32_t matchEmpty() const { return match(kSwissEmpty); }
+  // Empty and deleted are the only negative control bytes.
+  uint32_t matchFree() const {
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+  }
+#else
+  explicit _SwissGroup(const int8_t *ctrl) : ctrl_(ctrl) {}
+  uint32_t match(int8_t h2) const {
+    uint32_t mask = 0;
+    for (size_type i = 0; i < kSwissGroupWidth; i++) {
+      mask |= static_cast<uint32_t>(ctrl_[i] == h2) << i;
+    }
+    return mask;
+  }
+  uint32_t matchEmpty() const { return match(kSwissEmpty); }
+  uint32_t matchFree() const {
+    uint32_t mask = 0;
+    for (size_type i = 0; i < kSwissGroupWidth; i++) {
+      mask |= static_cast<uint32_t>(ctrl_[i] < 0) << i;
+    }
+    return mask;
+  }
+#endif
+};
+
+template<class Key, class Value>
+struct _SwissSlot {
+  Key key;
+  Value value;
+};
+
+template<class Slot>
+struct _SwissTable {
+  int8_t *ctrl_;
+  Slot *slots_;
+  size_type capacity_;
+  size_type size_;
+  size_type deleted_;
+
+  _SwissTable()
+      : ctrl_(nullptr), slots_(nullptr),
+        capacity_(0), size_(0), deleted_(0) {}
+  size_type groups() const { return capacity_ / kSwissGroupWidth; }
+  size_type mask() const { return groups() - 1; }
+  // Inserts left before the load factor reaches 7/8. Tombstones count as
+  // used: they lengthen probes just like live keys.
+  size_type growthLeft() const {
+    return capacity_ / 8 * 7 - size_ - deleted_;
+  }
+  bool isFull(size_type i) const { return ctrl_[i] >= 0; }
+};
+
+template<class Dict>
+class _SwissIterator {
+  friend Dict;
+
+ public:
+  typedef rd::size_type size_type;
+  typedef _SwissIterator iterator;
+  typedef std::forward_iterator_tag iterator_category;
+  typedef typename Dict::entry_type entry_type;
+  typedef entry_type &reference;
+  typedef entry_type *pointer;
+
+ private:
+  Dict *dict_;
+  bool in_old_;
+  size_type index_;
+  pointer cur_;
+
+  _SwissIterator(Dict *dict, bool in_old, size_type index)
+      : dict_(dict), in_old_(in_old), index_(index),
+        cur_(dict == nullptr ? nullptr : dict->slotAt(in_old, index)) {}
+
+ public:
+  _SwissIterator()
+      : dict_(nullptr), in_old_(false), index_(0), cur_(nullptr) {}
+
+  reference operator*() const { return *cur_; }
+  pointer operator->() const { return cur_; }
+  iterator &operator++() {
+    cur_ = dict_->nextSlot(&in_old_, &index_);
+    return *this;
+  }
+  iterator operator++(int) { // NOLINT
+    iterator it(*this);
+    ++(*this);
+    return it;
+  }
+
+  bool operator==(const iterator &it)
+  const { return cur_ == it.cur_; }
+  bool operator!=(const iterator &it)
+  const { return cur_ != it.cur_; }
+  bool operator==(std::nullptr_t)
+  const { return cur_ == nullptr; }
+  bool operator!=(std::nullptr_t)
+  const { return cur_ != nullptr; }
+};
+
+// An open-addressing table in the style of Abseil's Swiss tables, with
+// the same interface as Dict. Keys and values live inline in a slot
+// array beside a control-byte array, so a lookup reads one group of
+// control bytes and then, almost always, the one slot that matches,
+// instead of walking a chain of heap entries.
+//
+// Groups are probed linearly. A key therefore lies in its home group
+// (hash >> 7 masked to the group count) or in a later group that was
+// reached because every group before it was full. That invariant is
+// what keeps scan's reverse-binary cursor valid: scan visits the home
+// group and follows it through groups with no empty byte.
+//
+// Growing is incremental, like Dict's rehash. A new table is allocated,
+// every mutation then moves one group of the old table across, and
+// lookups check both tables until the old one is empty. Migrated slots
+// become tombstones, so probes in the old table still run past them.
+//
+// Unlike Dict's iterators, these do not pause rehashing: any add,
+// replace or remove may invalidate them. Use scan to walk the table
+// across mutations.
+template<class Key, class Value,
+    class Hash = std::hash<Key>, class Equal = std::equal_to<>>
+class SwissDict {
+ public:
+  friend class _SwissIterator<SwissDict>;
+
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef Hash hasher;
+  typedef Equal key_equal;
+  typedef rd::size_type size_type;
+  typedef _SwissIterator<SwissDict> iterator;
+  typedef _SwissSlot<Key, Value> entry_type;
+  typedef entry_type *pointer;
+  typedef entry_type &reference;
+
+ private:
+  typedef _SwissTable<entry_type> table_type;
+
+  template<class H, class E>
+  using _Transparent =
+  std::void_t<typename H::is_transparent, typename E::is_transparent>;
+
+  static constexpr size_type kMinCapacity = 16;
+  static constexpr size_type kRehashSliceLength = 10;
+  static constexpr size_type kRehashMsDuration = 100;
+
+  // table_ takes every insert; old_ is drained while rehashing.
+  table_type table_, old_;
+  size_type process_;
+  Hash hash_;
+  Equal equal_;
+  std::pmr::memory_resource *resource_;
+
+  // std::hash of an integer is the identity, which would put runs of 128
+  // consecutive keys in one home group; fold a 128-bit product first.
+  template<class Probe>
+  size_t hashOf(const Probe &key) const {
+    unsigned __int128 m = static_cast<unsigned __int128>(hash_(key)) *
+        0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>(m ^ (m >> 64));
+  }
+  static size_type h1(size_t hash) { return hash >> 7; }
+  static int8_t h2(size_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+  static size_type reverseBits(size_type n);
+  size_type capacityFor(size_type n) const;
+  table_type newTable(size_type capacity);
+  void freeTable(table_type &table);
+
+  template<class Probe>
+  size_type findIn(const table_type &table, const Probe &key,
+                   size_t hash) const;
+  pointer insertUnique(table_type &table, size_t hash,
+                       key_type &&key, value_type &&value);
+  void eraseAt(table_type &table, size_type index);
+  void moveSlot(table_type &from, size_type index, table_type &to);
+  template<class Probe>
+  bool removeKey(const Probe &key);
+  template<class Probe>
+  iterator findIterIndex(const Probe &key);
+  void grow();
+  void startRehash(size_type capacity);
+  void stopRehash();
+  void rehash(size_type n = 1);
+
+  pointer slotAt(bool in_old, size_type index);
+  pointer nextSlot(bool *in_old, size_type *index);
+  template<class UnFn>
+  void scanChain(table_type &table, size_type group, UnFn &fn);
+
+ public:
+  SwissDict();
+  explicit SwissDict(std::pmr::memory_resource *resource);
+  explicit SwissDict(
+      const Hash &hash, const Equal &equal = Equal(),
+      std::pmr::memory_resource *resource = zmallocResource());
+  SwissDict(const SwissDict &) = delete;
+  SwissDict &operator=(const SwissDict &) = delete;
+  ~SwissDict();
+
+  iterator begin();
+  iterator end() { return iterator(); }
+  size_type size() const { return table_.size_ + old_.size_; }
+  bool empty() const { return size() == 0; }
+  // Slots in the live table(s), for memory accounting.
+  size_type capacity() const { return table_.capacity_ + old_.capacity_; }
+
+  bool isRehashing()
+  const { return old_.ctrl_ != nullptr; }
+  std::pmr::memory_resource *resource()
+  const { return resource_; }
+
+  void rehashMilliseconds(size_type n);
+  // Starts an incremental rebuild into the smallest table that holds the
+  // current keys plus a group, which also drops tombstones. Never grows
+  // the table.
+  void shrink();
+
+  iterator get(const key_type &key) { return findIterIndex(key); }
+  template<class Probe, class H = Hash, class E = Equal,
+      class = _Transparent<H, E>>
+  iterator get(const Probe &key) { return findIterIndex(key); }
+  // Inserts key unless it is present; returns end() in that case.
+  iterator add(key_type key, value_type value);
+  // Inserts key, or overwrites the value of the entry already holding it.
+  iterator replace(key_type key, value_type value);
+  bool remove(const key_type &key) { return removeKey(key); }
+  template<class Probe, class H = Hash, class E = Equal,
+      class = _Transparent<H, E>>
+  bool remove(const Probe &key) { return removeKey(key); }
+  template<class UnFn>
+  size_type scan(size_type n, UnFn fn);
+};
+
+// Picks the table engine of a dict at compile time.
+enum class DictEngine { kChained, kSwiss };
+
+template<DictEngine Engine, class Key, class Value,
+    class Hash = std::hash<Key>, class Equal = std::equal_to<>>
+using DictOf = std::conditional_t<Engine == DictEngine::kChained,
+                                  Dict<Key, Value, Hash, Equal>,
+                                  SwissDict<Key, Value, Hash, Equal>>;
+
+template<class K, class V, class H, class E>
+SwissDict<K, V, H, E>::SwissDict() : SwissDict(H()) {}
+
+template<class K, class V, class H, class E>
+SwissDict<K, V, H, E>::SwissDict(std::pmr::memory_resource *resource)
+    : SwissDict(H(), E(), resource) {}
+
+template<class K, class V, class H, class E>
+SwissDict<K, V, H, E>::SwissDict(
+    const H &hash, const E &equal, std::pmr::memory_resource *resource)
+    : process_(0), hash_(hash), equal_(equal), resource_(resource) {
+  table_ = newTable(kMinCapacity);
+}
+
+template<class K, class V, class H, class E>
+SwissDict<K, V, H, E>::~SwissDict() {
+  freeTable(table_);
+  freeTable(old_);
+}
+
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::size_type
+SwissDict<K, V, H, E>::capacityFor(size_type n) const {
+  size_type capacity = kMinCapacity;
+  while (capacity / 8 * 7 < n) { capacity *= 2; }
+  return capacity;
+}
+
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::size_type
+SwissDict<K, V, H, E>::reverseBits(size_type n) {
+  size_type s = 8 * sizeof(n), mask = ~size_type();
+  while ((s >>= 1u) > 0) {
+    mask ^= (mask << s);
+    n = ((n >> s) & mask) | ((n << s) & ~mask);
+  }
+  return n;
+}
+
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::table_type
+SwissDict<K, V, H, E>::newTable(size_type capacity) {
+  table_type table;
+  table.capacity_ = capacity;
+  table.ctrl_ = static_cast<int8_t *>(
+      resource_->allocate(capacity, kSwissGroupWidth));
+  table.slots_ = static_cast<pointer>(
+      resource_->allocate(capacity * sizeof(entry_type),
+                          alignof(entry_type)));
+  memset(table.ctrl_, kSwissEmpty, capacity);
+  return table;
+}
+
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::freeTable(table_type &table) {
+  if (table.ctrl_ == nullptr) { return; }
+  for (size_type i = 0; i < table.capacity_; i++) {
+    if (table.isFull(i)) { table.slots_[i].~entry_type(); }
+  }
+  resource_->deallocate(table.ctrl_, table.capacity_, kSwissGroupWidth);
+  resource_->deallocate(table.slots_, table.capacity_ * sizeof(entry_type),
+                        alignof(entry_type));
+  table = table_type();
+}
+
+template<class K, class V, class H, class E>
+template<class Probe>
+typename SwissDict<K, V, H, E>::size_type
+SwissDict<K, V, H, E>::findIn(
+    const table_type &table, const Probe &key, size_t hash) const {
+  if (table.size_ == 0) { return table.capacity_; }
+  size_type mask = table.mask();
+  for (size_type g = h1(hash) & mask;; g = (g + 1) & mask) {
+    _SwissGroup group(table.ctrl_ + g * kSwissGroupWidth);
+    for (uint32_t m = group.match(h2(hash)); m != 0; m &= m - 1) {
+      size_type i = g * kSwissGroupWidth + __builtin_ctz(m);
+      if (equal_(table.slots_[i].key, key)) { return i; }
+    }
+    // The load factor keeps at least one empty byte in the table.
+    if (group.matchEmpty() != 0) { return table.capacity_; }
+  }
+}
+
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::pointer
+SwissDict<K, V, H, E>::insertUnique(
+    table_type &table, size_t hash, key_type &&key, value_type &&value) {
+  size_type mask = table.mask();
+  for (size_type g = h1(hash) & mask;; g = (g + 1) & mask) {
+    uint32_t m = _SwissGroup(table.ctrl_ + g * kSwissGroupWidth).matchFree();
+    if (m == 0) { continue; }
+    size_type i = g * kSwissGroupWidth + __builtin_ctz(m);
+    if (table.ctrl_[i] == kSwissDeleted) { table.deleted_--; }
+    table.ctrl_[i] = h2(hash);
+    table.size_++;
+    return new(&table.slots_[i]) entry_type{std::move(key), std::move(value)};
+  }
+}
+
+// A slot whose group still has an empty byte can go back to empty: no
+// probe has ever run past that group, so none depends on it.
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::eraseAt(table_type &table, size_type index) {
+  table.slots_[index].~entry_type();
+  table.size_--;
+  size_type group = index / kSwissGroupWidth * kSwissGroupWidth;
+  if (_SwissGroup(table.ctrl_ + group).matchEmpty() != 0) {
+    table.ctrl_[index] = kSwissEmpty;
+  } else {
+    table.ctrl_[index] = kSwissDeleted;
+    table.deleted_++;
+  }
+}
+
+// Moves the key in from's slot index into to, leaving a tombstone.
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::moveSlot(
+    table_type &from, size_type index, table_type &to) {
+  entry_type &slot = from.slots_[index];
+  insertUnique(to, hashOf(slot.key), std::move(slot.key),
+               std::move(slot.value));
+  slot.~entry_type();
+  from.ctrl_[index] = kSwissDeleted;
+  from.size_--;
+  from.deleted_++;
+}
+
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::startRehash(size_type capacity) {
+  assert(!isRehashing());
+  old_ = table_;
+  table_ = newTable(capacity);
+  process_ = 0;
+}
+
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::stopRehash() {
+  freeTable(old_);
+  process_ = 0;
+}
+
+// Moves up to n non-empty groups of the old table, visiting at most
+// kRehashSliceLength empty ones per group, as Dict::rehash does.
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::rehash(size_type n) {
+  if (!isRehashing()) { return; }
+  for (size_type moved = 0; moved != n && old_.size_ != 0; moved++) {
+    // A new table without room for another group, filled by inserts
+    // since the rehash began, cannot take the rest one group at a time:
+    // grow() merges both at once.
+    if (table_.growthLeft() < kSwissGroupWidth) {
+      grow();
+      return;
+    }
+    size_type visited = 0;
+    for (;;) {
+      assert(process_ < old_.groups());
+      // Full slots are the ones with a clear sign bit.
+      uint32_t free = _SwissGroup(old_.ctrl_ +
+          process_ * kSwissGroupWidth).matchFree();
+      if (free != (1u << kSwissGroupWidth) - 1) { break; }
+      process_++;
+      if (++visited == kRehashSliceLength) { return; }
+    }
+    size_type base = process_ * kSwissGroupWidth;
+    for (size_type i = base; i < base + kSwissGroupWidth; i++) {
+      if (old_.isFull(i)) { moveSlot(old_, i, table_); }
+    }
+    process_++;
+  }
+  if (old_.size_ == 0) { stopRehash(); }
+}
+
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::grow() {
+  size_type capacity = capacityFor(2 * (size() + 1));
+  if (!isRehashing()) {
+    startRehash(capacity);
+    return;
+  }
+  // Inserts outran the rehash, which takes many removes from the old
+  // table first: every insert moves a group, and the new table starts
+  // with room for twice the keys. Rebuild both into one table at once.
+  table_type table = newTable(capacity);
+  for (table_type *from : {&table_, &old_}) {
+    for (size_type i = 0; i < from->capacity_; i++) {
+      if (from->isFull(i)) { moveSlot(*from, i, table); }
+    }
+  }
+  freeTable(table_);
+  stopRehash();
+  table_ = table;
+}
+
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::rehashMilliseconds(size_type n) {
+  auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(n);
+  while (isRehashing() && std::chrono::steady_clock::now() < end) {
+    rehash(kRehashMsDuration);
+  }
+}
+
+template<class K, class V, class H, class E>
+void SwissDict<K, V, H, E>::shrink() {
+  if (isRehashing()) { return; }
+  // A group's worth of room on top of the keys, or the new table could
+  // not take the last groups of the old one.
+  size_type capacity = capacityFor(table_.size_ + kSwissGroupWidth);
+  // A nearly full table would only come back bigger: its tombstones are
+  // left to grow() on the insert path.
+  if (capacity > table_.capacity_) { return; }
+  if (capacity < table_.capacity_ || table_.deleted_ != 0) {
+    startRehash(capacity);
+  }
+}
+
+template<class K, class V, class H, class E>
+template<class Probe>
+typename SwissDict<K, V, H, E>::iterator
+SwissDict<K, V, H, E>::findIterIndex(const Probe &key) {
+  size_t hash = hashOf(key);
+  size_type i = findIn(table_, key, hash);
+  if (i != table_.capacity_) { return iterator(this, false, i); }
+  if (isRehashing()) {
+    i = findIn(old_, key, hash);
+    if (i != old_.capacity_) { return iterator(this, true, i); }
+  }
+  return end();
+}
+
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::iterator
+SwissDict<K, V, H, E>::add(key_type key, value_type value) {
+  if (isRehashing()) { rehash(); }
+  if (findIterIndex(key) != nullptr) { return end(); }
+  if (table_.growthLeft() == 0) { grow(); }
+  size_t hash = hashOf(key);
+  pointer slot = insertUnique(table_, hash, std::move(key), std::move(value));
+  return iterator(this, false, slot - table_.slots_);
+}
+
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::iterator
+SwissDict<K, V, H, E>::replace(key_type key, value_type value) {
+  if (isRehashing()) { rehash(); }
+  iterator it = findIterIndex(key);
+  if (it != nullptr) {
+    it->value = std::move(value);
+    return it;
+  }
+  if (table_.growthLeft() == 0) { grow(); }
+  size_t hash = hashOf(key);
+  pointer slot = insertUnique(table_, hash, std::move(key), std::move(value));
+  return iterator(this, false, slot - table_.slots_);
+}
+
+template<class K, class V, class H, class E>
+template<class Probe>
+bool SwissDict<K, V, H, E>::removeKey(const Probe &key) {
+  if (isRehashing()) { rehash(); }
+  size_t hash = hashOf(key);
+  size_type i = findIn(table_, key, hash);
+  if (i != table_.capacity_) {
+    eraseAt(table_, i);
+    return true;
+  }
+  if (isRehashing()) {
+    i = findIn(old_, key, hash);
+    if (i != old_.capacity_) {
+      eraseAt(old_, i);
+      if (old_.size_ == 0) { stopRehash(); }
+      return true;
+    }
+  }
+  return false;
+}
+
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::pointer
+SwissDict<K, V, H, E>::slotAt(bool in_old, size_type index) {
+  return &(in_old ? old_ : table_).slots_[index];
+}
+
+// The next full slot after (*in_old, *index): the rest of table_, then
+// old_ from its start.
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::pointer
+SwissDict<K, V, H, E>::nextSlot(bool *in_old, size_type *index) {
+  for (;;) {
+    table_type &table = *in_old ? old_ : table_;
+    while (++*index < table.capacity_) {
+      if (table.isFull(*index)) { return &table.slots_[*index]; }
+    }
+    if (*in_old || !isRehashing()) { return nullptr; }
+    *in_old = true;
+    // Wraps to 0 on the pre-increment above.
+    *index = SIZE_MAX;
+  }
+}
+
+template<class K, class V, class H, class E>
+typename SwissDict<K, V, H, E>::iterator SwissDict<K, V, H, E>::begin() {
+  iterator it(this, false, 0);
+  if (!table_.isFull(0)) { ++it; }
+  return it;
+}
+
+template<class K, class V, class H, class E>
+template<class UnFn>
+void SwissDict<K, V, H, E>::scanChain(
+    table_type &table, size_type group, UnFn &fn) {
+  size_type mask = table.mask();
+  for (;; group = (group + 1) & mask) {
+    size_type base = group * kSwissGroupWidth;
+    for (size_type i = base; i < base + kSwissGroupWidth; i++) {
+      if (table.isFull(i)) { fn(&table.slots_[i]); }
+    }
+    if (_SwissGroup(table.ctrl_ + base).matchEmpty() != 0) { break; }
+  }
+}
+
+// Same cursor as Dict::scan, over groups instead of buckets. Keys that
+// probed past their home group are reported with it, so a key may be
+// seen twice but is never missed.
+template<class K, class V, class H, class E>
+template<class UnFn>
+typename SwissDict<K, V, H, E>::size_type
+SwissDict<K, V, H, E>::scan(size_type n, UnFn fn) {
+  if (empty()) { return 0; }
+  auto next = [](size_type n, size_type mask) {
+    n |= ~mask;
+    n = reverseBits(n);
+    n++;
+    return reverseBits(n);
+  };
+  if (isRehashing()) {
+    table_type *small = &table_, *large = &old_;
+    if (small->capacity_ > large->capacity_) { std::swap(small, large); }
+    size_type small_mask = small->mask(), large_mask = large->mask();
+    scanChain(*small, n & small_mask, fn);
+    do {
+      scanChain(*large, n & large_mask, fn);
+      n = next(n, large_mask);
+    } while (n & (small_mask ^ large_mask));
+  } else {
+    scanChain(table_, n & table_.mask(), fn);
+    n = next(n, table_.mask());
+  }
+  return n;
+}
+
+}  // namespace rd
+
+#endif //REDIS_SWISSTABLE_H
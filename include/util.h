@@ -0,0 +1,36 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_UTIL_H
+#define REDIS_UTIL_H
+
+// For uint32_t, uint64_t
+#include <cstdint>
+// For size_t
+#include <cstddef>
+
+namespace rd {
+
+// Enough room for any long long in base 10, sign and terminator included.
+const size_t kLongStrSize = 21;
+
+uint32_t digits10(uint64_t v);
+// Write the decimal form of value plus a terminator to dst and return
+// its length, or 0 when dstlen is too small.
+size_t ull2string(char *dst, size_t dstlen, unsigned long long value);
+size_t ll2string(char *dst, size_t dstlen, long long value);
+// Parse s[0, slen) as a long long. Only the canonical form is accepted:
+// no spaces, no '+', no leading zeros, no "-0". That is exactly the text
+// ll2string would produce, so a value that parses round-trips.
+bool string2ll(const char *s, size_t slen, long long *value);
+// A fast pseudo-random number from a per-thread generator seeded by
+// std::random_device, for sampling. Not for anything that must be
+// unpredictable.
+uint64_t random64();
+// Unix time in milliseconds, the unit of key expire times.
+long long mstime();
+
+}  // namespace rd
+
+#endif //REDIS_UTIL_H
@@ -0,0 +1,41 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_ZMALLOC_H
+#define REDIS_ZMALLOC_H
+
+// For size_t
+#include <cstddef>
+// For std::pmr::memory_resource
+#include <memory_resource>
+
+namespace rd {
+
+// Counted heap allocation, after Redis' zmalloc. Strings, list and skip
+// list nodes, objects and, through zmallocResource(), dicts take their
+// memory from here, so usedMemory() is what a maxmemory limit is checked
+// against. Callers pass the size back on free instead of it being stored
+// in a prefix: every one of them knows it. Sizes are the requested ones,
+// so allocator overhead and fragmentation are not counted.
+void *zmalloc(size_t size);
+void zfree(void *ptr, size_t size);
+// Bytes currently allocated, by all threads.
+size_t usedMemory();
+// A memory_resource over zmalloc, the default resource of Dict and
+// SwissDict.
+std::pmr::memory_resource *zmallocResource();
+
+// Derive from it to allocate a class, and arrays of it, through zmalloc.
+struct ZmallocNew {
+  static void *operator new(size_t size) { return zmalloc(size); }
+  static void *operator new[](size_t size) { return zmalloc(size); }
+  static void operator delete(void *ptr, size_t size) { zfree(ptr, size); }
+  static void operator delete[](void *ptr, size_t size) {
+    zfree(ptr, size);
+  }
+};
+
+}  // namespace rd
+
+#endif //REDIS_ZMALLOC_H
@@ -0,0 +1,158 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For memcpy
+#include <cstring>
+#include "bitops.h"
+#include "simd.h"
+
+namespace rd {
+
+namespace {
+
+// Clamp Redis-style inclusive indices to [0, len); false if empty.
+bool normalizeRange(long long len, long long *start, long long *end) {
+  if (*start < 0) { *start += len; }
+  if (*end < 0) { *end += len; }
+  if (*start < 0) { *start = 0; }
+  if (*end < 0) { *end = 0; }
+  if (*end >= len) { *end = len - 1; }
+  return len > 0 && *start <= *end;
+}
+
+const unsigned char *bytes(StringView view) {
+  return reinterpret_cast<const unsigned char *>(view.data());
+}
+
+// Scan [p, p + n) for the first bit equal to bit, skipping whole words
+// of 0x00 (looking for 1) or 0xff (looking for 0) first.
+long long findBit(const unsigned char *p, size_t n, int bit) {
+  const uint64_t skip = bit ? 0 : ~0ull;
+  const unsigned char skipByte = bit ? 0 : 0xff;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t word;
+    memcpy(&word, p + i, sizeof(word));
+    if (word != skip) { break; }
+  }
+  for (; i < n && p[i] == skipByte; i++);
+  if (i == n) { return -1; }
+  unsigned char byte = bit ? p[i] : static_cast<unsigned char>(~p[i]);
+  return static_cast<long long>(i) * 8 + __builtin_clz(byte) - 24;
+}
+
+long long bitPosRange(StringView bitmap, int bit,
+                      long long start, long long end, bool endGiven) {
+  auto len = static_cast<long long>(bitmap.size());
+  if (len == 0) { return bit ? -1 : 0; }
+  if (!normalizeRange(len, &start, &end)) { return -1; }
+  long long pos = findBit(bytes(bitmap) + start,
+                          static_cast<size_t>(end - start + 1), bit);
+  if (pos != -1) { return start * 8 + pos; }
+  // No zero in range: the implicit padding after the string holds one,
+  // unless the caller pinned the end of the range.
+  return (bit == 0 && !endGiven) ? (end + 1) * 8 : -1;
+}
+
+bool overlaps(StringView view, const String &string) {
+  const char *begin = string.data();
+  return view.data() < begin + string.capacity() &&
+         begin < view.data() + view.size();
+}
+
+}  // namespace
+
+int setBit(String &bitmap, size_t offset, int on) {
+  size_t byte = offset >> 3;
+  if (byte >= kMaxBitmapSize) { return -1; }
+  if (byte >= bitmap.size()) { bitmap.resize(byte + 1); }
+  auto mask = static_cast<unsigned char>(0x80u >> (offset & 7));
+  auto &slot = reinterpret_cast<unsigned char &>(bitmap.begin()[byte]);
+  int old = (slot & mask) != 0;
+  slot = on ? (slot | mask) : (slot & ~mask);
+  return old;
+}
+
+int getBit(StringView bitmap, size_t offset) {
+  size_t byte = offset >> 3;
+  if (byte >= bitmap.size()) { return 0; }
+  return (bytes(bitmap)[byte] & (0x80u >> (offset & 7))) != 0;
+}
+
+size_t bitCount(StringView bitmap) {
+  return simd::kernels().popcount(bitmap.data(), bitmap.size());
+}
+
+size_t bitCount(StringView bitmap, long long start, long long end) {
+  if (!normalizeRange(static_cast<long long>(bitmap.size()), &start, &end)) {
+    return 0;
+  }
+  return simd::kernels().popcount(bitmap.data() + start,
+                                  static_cast<size_t>(end - start + 1));
+}
+
+long long bitPos(StringView bitmap, int bit) {
+  return bitPosRange(bitmap, bit, 0, -1, false);
+}
+
+long long bitPos(StringView bitmap, int bit, long long start) {
+  return bitPosRange(bitmap, bit, start, -1, false);
+}
+
+long long bitPos(StringView bitmap, int bit, long long start, long long end) {
+  return bitPosRange(bitmap, bit, start, end, true);
+}
+
+long long bitOp(BitOp op, String &dest, const StringView *srcs, size_t n) {
+  if (op == BitOp::kNot && n != 1) { return -1; }
+  size_t maxlen = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (srcs[i].size() > maxlen) { maxlen = srcs[i].size(); }
+  }
+  // dest's buffer is reused unless a source points into it, in which
+  // case the result is built aside and moved in at the end.
+  bool aliased = false;
+  for (size_t i = 0; i < n; i++) {
+    aliased |= overlaps(srcs[i], dest);
+  }
+  String scratch;
+  String &result = aliased ? scratch : dest;
+  result.clear();
+  if (n > 0) {
+    result.reserve(maxlen);
+    result.append(srcs[0].data(), srcs[0].data() + srcs[0].size());
+    result.resize(maxlen);
+  }
+  const simd::Kernels &k = simd::kernels();
+  char *out = result.begin();
+  if (op == BitOp::kNot) {
+    k.bitNot(out, maxlen);
+  }
+  for (size_t i = 1; i < n; i++) {
+    const StringView &src = srcs[i];
+    switch (op) {
+      case BitOp::kAnd:
+        k.bitAnd(out, src.data(), src.size());
+        // AND with the zero padding past the end of src.
+        memset(out + src.size(), 0, maxlen - src.size());
+        break;
+      case BitOp::kOr:
+        k.bitOr(out, src.data(), src.size());
+        break;
+      case BitOp::kXor:
+        k.bitXor(out, src.data(), src.size());
+        break;
+      case BitOp::kNot:
+        break;
+    }
+  }
+  if (aliased) { dest = std::move(scratch); }
+  return static_cast<long long>(maxlen);
+}
+
+long long bitOp(BitOp op, String &dest, std::initializer_list<StringView> srcs) {
+  return bitOp(op, dest, srcs.begin(), srcs.size());
+}
+
+}  // namespace rd
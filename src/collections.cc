@@ -0,0 +1,355 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For snprintf
+#include <cstdio>
+// For strtod
+#include <cstdlib>
+// For memcpy
+#include <cstring>
+#include "collections.h"
+
+namespace rd {
+
+EncodingConfig &encodingConfig() {
+  static EncodingConfig config;
+  return config;
+}
+
+namespace {
+// Integral scores up to 2^53 are exact as doubles and stored as integers.
+const double kMaxExactScore = 9007199254740992.0;
+
+bool parseInteger(StringView s, long long *value) {
+  return s.size() < kLongStrSize && string2ll(s.data(), s.size(), value);
+}
+
+void assignView(String *dst, StringView view) {
+  dst->assign(view.data(), view.size());
+}
+}  // namespace
+
+// HashType
+
+void HashType::convert() {
+  auto dict = std::make_unique<dict_type>();
+  dict->reserve(lp_.size() / 2);
+  char field[kLongStrSize], value[kLongStrSize];
+  for (size_type p = lp_.first(); p != ListPack::npos;) {
+    size_type q = lp_.next(p);
+    dict->addUnique(String(lp_.get(p).view(field)),
+                    String(lp_.get(q).view(value)));
+    p = lp_.next(q);
+  }
+  dict_ = std::move(dict);
+  ListPack dead = std::move(lp_);
+}
+
+bool HashType::set(StringView field, StringView value) {
+  if (!dict_) {
+    const EncodingConfig &config = encodingConfig();
+    if (field.size() <= config.hash_max_listpack_value &&
+        value.size() <= config.hash_max_listpack_value) {
+      size_type p = lp_.find(lp_.first(), field, 1);
+      if (p != ListPack::npos) {
+        lp_.replace(lp_.next(p), value);
+        return false;
+      }
+      if (lp_.size() / 2 < config.hash_max_listpack_entries) {
+        lp_.append(field);
+        lp_.append(value);
+        return true;
+      }
+    }
+    convert();
+  }
+  auto it = dict_->get(field);
+  if (it != dict_->end()) {
+    assignView(&it->value, value);
+    return false;
+  }
+  dict_->add(String(field), String(value));
+  return true;
+}
+
+bool HashType::get(StringView field, String *value) {
+  if (dict_) {
+    auto it = dict_->get(field);
+    if (it == dict_->end()) { return false; }
+    *value = it->value;
+    return true;
+  }
+  size_type p = lp_.find(lp_.first(), field, 1);
+  if (p == ListPack::npos) { return false; }
+  char buf[kLongStrSize];
+  assignView(value, lp_.get(lp_.next(p)).view(buf));
+  return true;
+}
+
+bool HashType::exists(StringView field) {
+  if (dict_) { return dict_->get(field) != dict_->end(); }
+  return lp_.find(lp_.first(), field, 1) != ListPack::npos;
+}
+
+bool HashType::remove(StringView field) {
+  if (dict_) { return dict_->remove(field); }
+  size_type p = lp_.find(lp_.first(), field, 1);
+  if (p == ListPack::npos) { return false; }
+  // The value first: removing it leaves the offset of the field valid.
+  lp_.remove(lp_.next(p));
+  lp_.remove(p);
+  return true;
+}
+
+// SetType
+
+void SetType::convert() {
+  auto dict = std::make_unique<dict_type>();
+  dict->reserve(is_.size() + 1);
+  char buf[kLongStrSize];
+  for (size_type i = 0; i < is_.size(); i++) {
+    dict->addUnique(String(buf, ll2string(buf, sizeof(buf), is_.get(i))),
+                    true);
+  }
+  dict_ = std::move(dict);
+  IntSet dead = std::move(is_);
+}
+
+bool SetType::add(StringView member) {
+  if (!dict_) {
+    long long value;
+    if (parseInteger(member, &value)) {
+      if (is_.size() < encodingConfig().set_max_intset_entries) {
+        return is_.add(value);
+      }
+      if (is_.contains(value)) { return false; }
+    }
+    convert();
+  }
+  return dict_->add(String(member), true) != dict_->end();
+}
+
+bool SetType::remove(StringView member) {
+  if (dict_) { return dict_->remove(member); }
+  long long value;
+  return parseInteger(member, &value) && is_.remove(value);
+}
+
+bool SetType::contains(StringView member) {
+  if (dict_) { return dict_->get(member) != dict_->end(); }
+  long long value;
+  return parseInteger(member, &value) && is_.contains(value);
+}
+
+// ZSetType
+
+double ZSetType::readScore(ListPackValue value) {
+  if (value.sval == nullptr) { return static_cast<double>(value.lval); }
+  char buf[32];
+  size_type n = value.slen < sizeof(buf) ? value.slen : sizeof(buf) - 1;
+  memcpy(buf, value.sval, n);
+  buf[n] = '\0';
+  return strtod(buf, nullptr);
+}
+
+// Inserts member and score before the first pair that sorts after them.
+void ZSetType::insertPair(StringView member, double score) {
+  char buf[kLongStrSize];
+  size_type p = lp_.first();
+  for (; p != ListPack::npos; p = lp_.next(lp_.next(p))) {
+    double cur = readScore(lp_.get(lp_.next(p)));
+    if (cur > score ||
+        (cur == score && member < lp_.get(p).view(buf))) {
+      break;
+    }
+  }
+  p = lp_.insert(p, member);
+  size_type q = lp_.next(p);
+  if (score > -kMaxExactScore && score < kMaxExactScore &&
+      score == static_cast<long long>(score)) {
+    lp_.insert(q, static_cast<long long>(score));
+  } else {
+    // %.17g round-trips every double.
+    char text[32];
+    int n = snprintf(text, sizeof(text), "%.17g", score);
+    lp_.insert(q, StringView(text, n));
+  }
+}
+
+void ZSetType::convert() {
+  auto zset = std::make_unique<_ZSet>();
+  zset->dict.reserve(lp_.size() / 2);
+  char buf[kLongStrSize];
+  for (size_type p = lp_.first(); p != ListPack::npos;) {
+    size_type q = lp_.next(p);
+    StringView member = lp_.get(p).view(buf);
+    double score = readScore(lp_.get(q));
+    zset->dict.addUnique(String(member), score);
+    zset->zsl.insert(String(member), score);
+    p = lp_.next(q);
+  }
+  zset_ = std::move(zset);
+  ListPack dead = std::move(lp_);
+}
+
+bool ZSetType::add(StringView member, double score) {
+  if (!zset_) {
+    const EncodingConfig &config = encodingConfig();
+    if (member.size() <= config.zset_max_listpack_value) {
+      size_type p = lp_.find(lp_.first(), member, 1);
+      if (p != ListPack::npos) {
+        if (readScore(lp_.get(lp_.next(p))) != score) {
+          lp_.remove(lp_.next(p));
+          lp_.remove(p);
+          insertPair(member, score);
+        }
+        return false;
+      }
+      if (lp_.size() / 2 < config.zset_max_listpack_entries) {
+        insertPair(member, score);
+        return true;
+      }
+    }
+    convert();
+  }
+  auto it = zset_->dict.get(member);
+  if (it != zset_->dict.end()) {
+    if (it->value != score) {
+      zset_->zsl.remove(member, it->value);
+      zset_->zsl.insert(String(member), score);
+      it->value = score;
+    }
+    return false;
+  }
+  zset_->dict.add(String(member), score);
+  zset_->zsl.insert(String(member), score);
+  return true;
+}
+
+bool ZSetType::score(StringView member, double *score) {
+  if (zset_) {
+    auto it = zset_->dict.get(member);
+    if (it == zset_->dict.end()) { return false; }
+    *score = it->value;
+    return true;
+  }
+  size_type p = lp_.find(lp_.first(), member, 1);
+  if (p == ListPack::npos) { return false; }
+  *score = readScore(lp_.get(lp_.next(p)));
+  return true;
+}
+
+bool ZSetType::remove(StringView member) {
+  if (zset_) {
+    double score;
+    {
+      auto it = zset_->dict.get(member);
+      if (it == zset_->dict.end()) { return false; }
+      score = it->value;
+    }
+    zset_->zsl.remove(member, score);
+    zset_->dict.remove(member);
+    return true;
+  }
+  size_type p = lp_.find(lp_.first(), member, 1);
+  if (p == ListPack::npos) { return false; }
+  lp_.remove(lp_.next(p));
+  lp_.remove(p);
+  return true;
+}
+
+// ListType
+
+void ListType::convert() {
+  auto list = std::make_unique<list_type>();
+  char buf[kLongStrSize];
+  for (size_type p = lp_.first(); p != ListPack::npos; p = lp_.next(p)) {
+    list->pushBack(String(lp_.get(p).view(buf)));
+  }
+  list_ = std::move(list);
+  ListPack dead = std::move(lp_);
+}
+
+// Whether value can join the listpack.
+bool ListType::fits(StringView value) const {
+  const EncodingConfig &config = encodingConfig();
+  return value.size() <= config.list_max_listpack_value &&
+      lp_.size() < config.list_max_listpack_entries;
+}
+
+void ListType::pushFront(StringView value) {
+  if (!list_) {
+    if (fits(value)) {
+      lp_.insert(lp_.first(), value);
+      return;
+    }
+    convert();
+  }
+  list_->pushFront(String(value));
+}
+
+void ListType::pushBack(StringView value) {
+  if (!list_) {
+    if (fits(value)) {
+      lp_.append(value);
+      return;
+    }
+    convert();
+  }
+  list_->pushBack(String(value));
+}
+
+bool ListType::popFront(String *value) {
+  if (list_) {
+    if (list_->empty()) { return false; }
+    *value = list_->popFront();
+    return true;
+  }
+  size_type p = lp_.first();
+  if (p == ListPack::npos) { return false; }
+  char buf[kLongStrSize];
+  assignView(value, lp_.get(p).view(buf));
+  lp_.remove(p);
+  return true;
+}
+
+bool ListType::popBack(String *value) {
+  if (list_) {
+    if (list_->empty()) { return false; }
+    *value = list_->popBack();
+    return true;
+  }
+  size_type p = lp_.last();
+  if (p == ListPack::npos) { return false; }
+  char buf[kLongStrSize];
+  assignView(value, lp_.get(p).view(buf));
+  lp_.remove(p);
+  return true;
+}
+
+bool ListType::index(long long index, String *value) {
+  if (list_) {
+    long long n = static_cast<long long>(list_->size());
+    if (index < 0) { index += n; }
+    if (index < 0 || index >= n) { return false; }
+    // Walk from the nearer end.
+    if (index < n / 2) {
+      auto it = list_->begin();
+      for (; index > 0; index--) { ++it; }
+      *value = *it;
+    } else {
+      auto it = list_->end();
+      for (; index < n; index++) { --it; }
+      *value = *it;
+    }
+    return true;
+  }
+  size_type p = lp_.seek(index);
+  if (p == ListPack::npos) { return false; }
+  char buf[kLongStrSize];
+  assignView(value, lp_.get(p).view(buf));
+  return true;
+}
+
+}  // namespace rd
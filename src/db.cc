@@ -0,0 +1,105 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include "db.h"
+#include "util.h"
+
+namespace rd {
+
+Db::Db()
+    : expires_cursor_(0), expire_timed_out_(false), last_fast_cycle_(0) {}
+
+Db::~Db() {
+  for (auto &entry : dict_) { entry.value->decrRef(); }
+}
+
+bool Db::isLfu() const {
+  return maxmemory_.policy == MaxmemoryPolicy::kAllKeysLfu ||
+      maxmemory_.policy == MaxmemoryPolicy::kVolatileLfu;
+}
+
+bool Db::evictsByAccess() const {
+  return maxmemory_.policy != MaxmemoryPolicy::kNoEviction &&
+      maxmemory_.policy != MaxmemoryPolicy::kVolatileTtl;
+}
+
+bool Db::evictsVolatile() const {
+  return maxmemory_.policy == MaxmemoryPolicy::kVolatileLru ||
+      maxmemory_.policy == MaxmemoryPolicy::kVolatileLfu ||
+      maxmemory_.policy == MaxmemoryPolicy::kVolatileTtl;
+}
+
+Object *Db::lookup(StringView key) {
+  auto it = dict_.get(key);
+  if (it == dict_.end()) { return nullptr; }
+  Object *value = it->value;
+  if (expireIfNeeded(key)) { return nullptr; }
+  if (isLfu()) {
+    value->touchLfu(maxmemory_.lfu_log_factor, maxmemory_.lfu_decay_time);
+  } else {
+    value->touchLru();
+  }
+  return value;
+}
+
+void Db::set(StringView key, Object *value) {
+  long long number;
+  if (value->isShared() && evictsByAccess() &&
+      value->getLongLong(&number)) {
+    value = Object::createInt(number, false);
+  }
+  auto it = dict_.get(key);
+  if (it == dict_.end()) {
+    if (isLfu()) { value->initLfu(); }
+    dict_.add(String(key), value);
+    return;
+  }
+  Object *old = it->value;
+  if (isLfu()) { value->setLru(old->lru()); }
+  it->value = value;
+  old->decrRef();
+  expires_.remove(key);
+}
+
+bool Db::remove(StringView key) {
+  auto it = dict_.get(key);
+  if (it == dict_.end()) { return false; }
+  Object *value = it->value;
+  expires_.remove(key);
+  dict_.remove(key);
+  value->decrRef();
+  return true;
+}
+
+bool Db::setExpire(StringView key, long long when) {
+  if (dict_.get(key) == dict_.end()) { return false; }
+  expires_.replace(String(key), when);
+  return true;
+}
+
+long long Db::getExpire(StringView key) {
+  auto it = expires_.get(key);
+  return it == expires_.end() ? -1 : it->value;
+}
+
+bool Db::removeExpire(StringView key) {
+  return expires_.remove(key);
+}
+
+bool Db::expireIfNeeded(StringView key) {
+  if (expires_.empty()) { return false; }
+  auto it = expires_.get(key);
+  if (it == expires_.end() || it->value >= mstime()) { return false; }
+  remove(key);
+  expire_stats_.expired_keys++;
+  return true;
+}
+
+void Db::setMaxmemory(const MaxmemoryConfig &config) {
+  // Scores of different policies do not compare.
+  if (config.policy != maxmemory_.policy) { pool_.clear(); }
+  maxmemory_ = config;
+}
+
+}  // namespace rd
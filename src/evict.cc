@@ -0,0 +1,135 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For std::move, std::move_backward, std::min
+#include <algorithm>
+// For std::chrono::steady_clock
+#include <chrono>
+// For UINT8_MAX
+#include <cstdint>
+#include "db.h"
+#include "evict.h"
+#include "zmalloc.h"
+
+namespace rd {
+
+namespace {
+// Most keys sampled per pool refill, whatever the config asks for.
+const size_type kMaxSamples = 64;
+// Keys evicted between two looks at the clock.
+const size_type kEvictionsPerClockCheck = 16;
+}
+
+void EvictionPool::insert(StringView key, uint64_t idle) {
+  size_type k = 0;
+  while (k < size_ && entries_[k].idle < idle) { k++; }
+  if (size_ == kSize) {
+    // Worse than every candidate in a full pool.
+    if (k == 0) { return; }
+    // Drop the worst candidate to make room left of k.
+    std::move(entries_ + 1, entries_ + k, entries_);
+    k--;
+  } else {
+    std::move_backward(entries_ + k, entries_ + size_, entries_ + size_ + 1);
+    size_++;
+  }
+  entries_[k].idle = idle;
+  entries_[k].key.assign(key.data(), key.size());
+}
+
+String EvictionPool::pop() {
+  return std::move(entries_[--size_].key);
+}
+
+void EvictionPool::clear() {
+  for (size_type i = 0; i < size_; i++) { entries_[i].key = String(); }
+  size_ = 0;
+}
+
+// Scores config.samples keys and offers them to the pool. Volatile
+// policies sample the expires, and look up the value of the key for LRU
+// and LFU scores.
+void Db::populatePool() {
+  size_type count = std::min(maxmemory_.samples, kMaxSamples);
+  bool from_expires = evictsVolatile();
+  dict_type::pointer keys[kMaxSamples];
+  expires_type::pointer expires[kMaxSamples];
+  size_type n = from_expires ? expires_.sampleEntries(count, expires)
+                             : dict_.sampleEntries(count, keys);
+  for (size_type i = 0; i < n; i++) {
+    const String &key = from_expires ? expires[i]->key : keys[i]->key;
+    uint64_t idle;
+    if (maxmemory_.policy == MaxmemoryPolicy::kVolatileTtl) {
+      // Sooner expires are better candidates.
+      idle = UINT64_MAX - static_cast<uint64_t>(expires[i]->value);
+    } else {
+      Object *value;
+      if (from_expires) {
+        auto it = dict_.get(key);
+        if (it == dict_.end()) { continue; }
+        value = it->value;
+      } else {
+        value = keys[i]->value;
+      }
+      idle = isLfu()
+             ? UINT8_MAX - value->lfuCounter(maxmemory_.lfu_decay_time)
+             : value->idleMilliseconds();
+    }
+    pool_.insert(key, idle);
+  }
+}
+
+// Pops the best candidate still in the keyspace, refilling the pool as
+// often as it runs dry. False once the policy has no keys to pick from.
+bool Db::nextEvictionKey(String *key) {
+  bool from_expires = evictsVolatile();
+  while (!(from_expires ? expires_.empty() : dict_.empty())) {
+    populatePool();
+    while (!pool_.empty()) {
+      String candidate = pool_.pop();
+      bool present = from_expires
+                     ? expires_.get(candidate) != expires_.end()
+                     : dict_.get(candidate) != dict_.end();
+      if (present) {
+        *key = std::move(candidate);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+EvictResult Db::performEvictions() {
+  size_t used = usedMemory();
+  if (maxmemory_.maxmemory == 0 || used <= maxmemory_.maxmemory) {
+    return EvictResult::kOk;
+  }
+  if (maxmemory_.policy == MaxmemoryPolicy::kNoEviction) {
+    return EvictResult::kFail;
+  }
+  using namespace std::chrono;
+  auto deadline = steady_clock::now() +
+      microseconds(maxmemory_.eviction_time_limit_us);
+  size_t to_free = used - maxmemory_.maxmemory, freed = 0;
+  size_type evicted = 0;
+  String key;
+  while (freed < to_free) {
+    if (!nextEvictionKey(&key)) { return EvictResult::kFail; }
+    // Measured rather than estimated. It can even be zero: the entry
+    // stays in the dict's slab, the value may be referenced elsewhere,
+    // and other threads allocate meanwhile.
+    size_t before = usedMemory();
+    remove(key);
+    size_t after = usedMemory();
+    if (after < before) { freed += before - after; }
+    if (++evicted % kEvictionsPerClockCheck == 0 &&
+        steady_clock::now() > deadline) {
+      return usedMemory() <= maxmemory_.maxmemory ? EvictResult::kOk
+                                                  : EvictResult::kRunning;
+    }
+  }
+  return EvictResult::kOk;
+}
+
+}  // namespace rd
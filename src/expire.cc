@@ -0,0 +1,127 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For std::min
+#include <algorithm>
+// For std::chrono::steady_clock
+#include <chrono>
+// For std::vector
+#include <vector>
+#include "db.h"
+#include "expire.h"
+#include "util.h"
+
+namespace rd {
+
+namespace {
+// Redis' ACTIVE_EXPIRE_CYCLE_* defaults, at effort 1.
+const size_type kKeysPerLoop = 20;
+const uint64_t kFastDurationUs = 1000;
+const size_type kSlowTimePerc = 25;
+const size_type kAcceptableStale = 10;
+// Buckets a loop may scan per key it wants, so that loops over a sparse
+// table stay short.
+const size_type kBucketsPerKey = 20;
+// Fill, in percent, below which a dict is shrunk.
+const size_type kMinFillPerc = 10;
+
+uint64_t steadyMicroseconds() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(
+      steady_clock::now().time_since_epoch()).count();
+}
+}
+
+// Scans the expires from expires_cursor_ until count keys are looked at,
+// deleting those that expired before now. Keys are only collected during
+// the scan: deleting an entry under Dict::scan would cut its chain walk.
+size_type Db::expireKeys(size_type count, long long now, size_type *sampled) {
+  static thread_local std::vector<String> stale;
+  stale.clear();
+  *sampled = 0;
+  size_type buckets = 0, max_buckets = count * kBucketsPerKey;
+  while (*sampled < count && buckets < max_buckets) {
+    expires_cursor_ = expires_.scan(
+        expires_cursor_, [&](expires_type::pointer entry) {
+          ++*sampled;
+          if (now > entry->value) { stale.push_back(entry->key); }
+        });
+    buckets++;
+  }
+  for (const String &key : stale) { remove(key.view()); }
+  expire_stats_.expired_keys += stale.size();
+  expire_stats_.sampled_keys += *sampled;
+  return stale.size();
+}
+
+// Shrinks either dict once it is too sparse and moves buckets of any
+// rehash in progress for a millisecond, like Redis' databasesCron:
+// rehashing on access alone leaves an idle dict half moved.
+void Db::resizeTables() {
+  if (dict_.size() * 100 / dict_.buckets() < kMinFillPerc) {
+    dict_.shrink();
+  }
+  if (expires_.size() * 100 / expires_.buckets() < kMinFillPerc) {
+    expires_.shrink();
+  }
+  if (dict_.isRehashing()) { dict_.rehashMilliseconds(1); }
+  if (expires_.isRehashing()) { expires_.rehashMilliseconds(1); }
+}
+
+void Db::activeExpireCycle(ExpireCycle type) {
+  size_type effort = expire_.effort < 1 ? 0
+                     : expire_.effort > 10 ? 9 : expire_.effort - 1;
+  size_type keys_per_loop = kKeysPerLoop + kKeysPerLoop / 4 * effort;
+  uint64_t fast_duration = kFastDurationUs + kFastDurationUs / 4 * effort;
+  size_type slow_time_perc = kSlowTimePerc + 2 * effort;
+  size_type acceptable_stale = kAcceptableStale - effort;
+
+  uint64_t start = steadyMicroseconds(), time_limit;
+  if (type == ExpireCycle::kFast) {
+    // Not worth it unless the last cycle left work behind, and never
+    // twice within two fast durations.
+    if (!expire_timed_out_ &&
+        expire_stats_.stale_perc < static_cast<double>(acceptable_stale)) {
+      return;
+    }
+    if (start < last_fast_cycle_ + fast_duration * 2) { return; }
+    last_fast_cycle_ = start;
+    time_limit = fast_duration;
+  } else {
+    size_type hz = expire_.hz < 1 ? 1 : expire_.hz;
+    time_limit = slow_time_perc * 1000000 / hz / 100;
+  }
+
+  expire_timed_out_ = false;
+  double stale_perc = 0;
+  bool repeat;
+  do {
+    size_type keys = expires_.size();
+    if (keys == 0) { break; }
+    // Under 1% of the buckets in use: scanning them costs more than the
+    // keys are worth until resizeTables() shrinks the table.
+    if (keys * 100 / expires_.buckets() < 1) { break; }
+    size_type sampled;
+    size_type expired = expireKeys(std::min(keys, keys_per_loop), mstime(),
+                                   &sampled);
+    if (sampled != 0) { stale_perc = expired * 100.0 / sampled; }
+    // Redis looks at the clock every 16 loops; a loop here deletes its
+    // keys from three dicts, which makes the clock cheap by comparison.
+    if (steadyMicroseconds() - start > time_limit) {
+      expire_timed_out_ = true;
+      expire_stats_.time_cap_reached++;
+      break;
+    }
+    repeat = sampled == 0 || expired * 100 > acceptable_stale * sampled;
+  } while (repeat);
+  if (type == ExpireCycle::kSlow) { resizeTables(); }
+
+  expire_stats_.cycles++;
+  expire_stats_.cycle_us += steadyMicroseconds() - start;
+  // A moving average, so one lucky sample does not hide a backlog.
+  expire_stats_.stale_perc = stale_perc * 0.05 +
+      expire_stats_.stale_perc * 0.95;
+}
+
+}  // namespace rd
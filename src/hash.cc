@@ -0,0 +1,202 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For memcpy
+#include <cstring>
+// For random_device
+#include <random>
+#include "hash.h"
+
+namespace rd {
+namespace {
+
+inline uint64_t rotl(uint64_t x, int b) {
+  return (x << b) | (x >> (64 - b));
+}
+
+inline uint64_t read64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline void sipRound(uint64_t &v0, uint64_t &v1, uint64_t &v2, uint64_t &v3) {
+  v0 += v1;
+  v1 = rotl(v1, 13);
+  v1 ^= v0;
+  v0 = rotl(v0, 32);
+  v2 += v3;
+  v3 = rotl(v3, 16);
+  v3 ^= v2;
+  v0 += v3;
+  v3 = rotl(v3, 21);
+  v3 ^= v0;
+  v2 += v1;
+  v1 = rotl(v1, 17);
+  v1 ^= v2;
+  v2 = rotl(v2, 32);
+}
+
+// 128-bit multiply folded to 64 bits, the core of wyhash.
+inline uint64_t wyMix(uint64_t a, uint64_t b) {
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+const uint64_t kWySecret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+    0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull,
+};
+
+struct _Seed {
+  uint8_t sip[16];
+  uint64_t wy;
+
+  _Seed() {
+    std::random_device device;
+    for (size_t i = 0; i < sizeof(sip); i += 4) {
+      uint32_t r = device();
+      memcpy(sip + i, &r, 4);
+    }
+    derive();
+  }
+  void derive() { wy = read64(sip) ^ rotl(read64(sip + 8), 29); }
+};
+
+_Seed &seed() {
+  static _Seed s;
+  return s;
+}
+
+}  // namespace
+
+template<int CRounds, int DRounds>
+uint64_t sipHash(const void *data, size_t n, const uint8_t key[16]) {
+  auto in = static_cast<const uint8_t *>(data);
+  uint64_t k0 = read64(key), k1 = read64(key + 8);
+  uint64_t v0 = 0x736f6d6570736575ull ^ k0;
+  uint64_t v1 = 0x646f72616e646f6dull ^ k1;
+  uint64_t v2 = 0x6c7967656e657261ull ^ k0;
+  uint64_t v3 = 0x7465646279746573ull ^ k1;
+  const uint8_t *end = in + n - (n % 8);
+  for (; in != end; in += 8) {
+    uint64_t m = read64(in);
+    v3 ^= m;
+    for (int i = 0; i < CRounds; i++) { sipRound(v0, v1, v2, v3); }
+    v0 ^= m;
+  }
+  uint64_t b = static_cast<uint64_t>(n) << 56;
+  for (size_t i = 0; i < n % 8; i++) {
+    b |= static_cast<uint64_t>(in[i]) << (8 * i);
+  }
+  v3 ^= b;
+  for (int i = 0; i < CRounds; i++) { sipRound(v0, v1, v2, v3); }
+  v0 ^= b;
+  v2 ^= 0xff;
+  for (int i = 0; i < DRounds; i++) { sipRound(v0, v1, v2, v3); }
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+template uint64_t sipHash<1, 2>(const void *, size_t, const uint8_t *);
+template uint64_t sipHash<2, 4>(const void *, size_t, const uint8_t *);
+
+uint64_t wyHash(const void *data, size_t n, uint64_t seed) {
+  auto p = static_cast<const uint8_t *>(data);
+  seed ^= wyMix(seed ^ kWySecret[0], kWySecret[1]);
+  uint64_t a, b;
+  if (n <= 16) {
+    if (n >= 4) {
+      a = (read32(p) << 32) | read32(p + ((n >> 3) << 2));
+      b = (read32(p + n - 4) << 32) | read32(p + n - 4 - ((n >> 3) << 2));
+    } else if (n > 0) {
+      a = (static_cast<uint64_t>(p[0]) << 16) |
+          (static_cast<uint64_t>(p[n >> 1]) << 8) | p[n - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = n;
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = wyMix(read64(p) ^ kWySecret[1], read64(p + 8) ^ seed);
+        see1 = wyMix(read64(p + 16) ^ kWySecret[2], read64(p + 24) ^ see1);
+        see2 = wyMix(read64(p + 32) ^ kWySecret[3], read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = wyMix(read64(p) ^ kWySecret[1], read64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = read64(p + i - 16);
+    b = read64(p + i - 8);
+  }
+  a ^= kWySecret[1];
+  b ^= seed;
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+  return wyMix(a ^ kWySecret[0] ^ n, b ^ kWySecret[1]);
+}
+
+// Little-endian variant of Austin Appleby's MurmurHash64A, as in Redis.
+uint64_t murmurHash64A(const void *data, size_t n, uint64_t seed) {
+  const uint64_t m = 0xc6a4a7935bd1e995ull;
+  const int r = 47;
+  auto p = static_cast<const uint8_t *>(data);
+  const uint8_t *end = p + (n & ~static_cast<size_t>(7));
+  uint64_t h = seed ^ (n * m);
+  for (; p != end; p += 8) {
+    uint64_t k = read64(p);
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+  switch (n & 7) {
+    case 7: h ^= static_cast<uint64_t>(p[6]) << 48; [[fallthrough]];
+    case 6: h ^= static_cast<uint64_t>(p[5]) << 40; [[fallthrough]];
+    case 5: h ^= static_cast<uint64_t>(p[4]) << 32; [[fallthrough]];
+    case 4: h ^= static_cast<uint64_t>(p[3]) << 24; [[fallthrough]];
+    case 3: h ^= static_cast<uint64_t>(p[2]) << 16; [[fallthrough]];
+    case 2: h ^= static_cast<uint64_t>(p[1]) << 8; [[fallthrough]];
+    case 1: h ^= static_cast<uint64_t>(p[0]);
+      h *= m;
+  }
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+uint64_t SipHash12::hash(const void *data, size_t n) {
+  return sipHash<1, 2>(data, n, seed().sip);
+}
+
+uint64_t WyHash::hash(const void *data, size_t n) {
+  return wyHash(data, n, seed().wy);
+}
+
+const uint8_t *hashSeed() {
+  return seed().sip;
+}
+
+void setHashSeed(const uint8_t s[16]) {
+  memcpy(seed().sip, s, sizeof(seed().sip));
+  seed().derive();
+}
+
+}  // namespace rd
@@ -0,0 +1,647 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For sqrt, pow, llroundl, INFINITY
+#include <cmath>
+// For memcpy, memmove, memcmp
+#include <cstring>
+#include "hash.h"
+#include "hyperloglog.h"
+#include "simd.h"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace rd {
+namespace {
+
+const int kP = 14;
+const int kQ = 64 - kP;
+const uint64_t kPMask = kHllRegisters - 1;
+const uint8_t kRegisterMax = 63;
+const uint64_t kHashSeed = 0xadc83b19ull;
+const double kAlphaInf = 0.721347520444481703680;
+const char kMagic[4] = {'H', 'Y', 'L', 'L'};
+const uint8_t kEncodingDense = 0;
+const uint8_t kEncodingSparse = 1;
+
+struct _HllHeader {
+  char magic[4];
+  uint8_t encoding;
+  uint8_t notused[3];
+  // Little-endian cardinality; the top bit of card[7] marks it stale.
+  uint8_t card[8];
+};
+static_assert(sizeof(_HllHeader) == kHllHeaderSize, "header layout");
+
+_HllHeader *header(String &hll) {
+  return reinterpret_cast<_HllHeader *>(hll.begin());
+}
+
+const _HllHeader *header(StringView hll) {
+  return reinterpret_cast<const _HllHeader *>(hll.data());
+}
+
+uint8_t *registers(String &hll) {
+  return reinterpret_cast<uint8_t *>(hll.begin()) + kHllHeaderSize;
+}
+
+const uint8_t *registers(StringView hll) {
+  return reinterpret_cast<const uint8_t *>(hll.data()) + kHllHeaderSize;
+}
+
+const uint8_t *registersEnd(StringView hll) {
+  return reinterpret_cast<const uint8_t *>(hll.data()) + hll.size();
+}
+
+bool cacheValid(const _HllHeader *hdr) {
+  return (hdr->card[7] & 0x80) == 0;
+}
+
+void invalidateCache(_HllHeader *hdr) {
+  hdr->card[7] |= 0x80;
+}
+
+uint64_t cachedCard(const _HllHeader *hdr) {
+  uint64_t card = 0;
+  for (int i = 7; i >= 0; i--) { card = (card << 8) | hdr->card[i]; }
+  return card;
+}
+
+void setCachedCard(_HllHeader *hdr, uint64_t card) {
+  for (int i = 0; i < 8; i++) {
+    hdr->card[i] = static_cast<uint8_t>(card >> (8 * i));
+  }
+}
+
+// Dense registers: 6 bits each, packed least significant bit first, so
+// register i spans bits [6i, 6i + 6) of the array. The access to byte
+// + 1 of the last register lands on the String terminator and is masked.
+
+uint8_t denseGet(const uint8_t *regs, size_t index) {
+  size_t byte = index * 6 / 8;
+  unsigned fb = index * 6 & 7;
+  unsigned b0 = regs[byte], b1 = regs[byte + 1];
+  return static_cast<uint8_t>(((b0 >> fb) | (b1 << (8 - fb))) & kRegisterMax);
+}
+
+void denseSet(uint8_t *regs, size_t index, uint8_t value) {
+  size_t byte = index * 6 / 8;
+  unsigned fb = index * 6 & 7;
+  unsigned v = value;
+  regs[byte] &= ~(kRegisterMax << fb);
+  regs[byte] |= v << fb;
+  regs[byte + 1] &= ~(kRegisterMax >> (8 - fb));
+  regs[byte + 1] |= v >> (8 - fb);
+}
+
+// Sparse opcodes, run-length coding the registers in order:
+//   00xxxxxx           ZERO   1..64 zero registers
+//   01xxxxxx yyyyyyyy  XZERO  1..16384 zero registers
+//   1vvvvvxx           VAL    1..4 registers set to 1..32
+const size_t kZeroMaxLen = 64;
+const uint8_t kValMax = 32;
+const size_t kValMaxLen = 4;
+
+bool isZero(uint8_t op) { return (op & 0xc0) == 0; }
+bool isXZero(uint8_t op) { return (op & 0xc0) == 0x40; }
+bool isVal(uint8_t op) { return (op & 0x80) != 0; }
+size_t zeroLen(uint8_t op) { return (op & 0x3f) + 1u; }
+size_t xzeroLen(const uint8_t *p) {
+  return ((static_cast<size_t>(p[0] & 0x3f) << 8) | p[1]) + 1;
+}
+uint8_t valValue(uint8_t op) { return ((op >> 2) & 0x1f) + 1; }
+size_t valLen(uint8_t op) { return (op & 3u) + 1; }
+
+uint8_t makeVal(uint8_t value, size_t len) {
+  return static_cast<uint8_t>(0x80 | ((value - 1) << 2) | (len - 1));
+}
+
+// Writes a run of len (<= kHllRegisters) zero registers, returns its size.
+size_t encodeZeros(uint8_t *out, size_t len) {
+  if (len <= kZeroMaxLen) {
+    out[0] = static_cast<uint8_t>(len - 1);
+    return 1;
+  }
+  out[0] = static_cast<uint8_t>(0x40 | ((len - 1) >> 8));
+  out[1] = static_cast<uint8_t>((len - 1) & 0xff);
+  return 2;
+}
+
+// Register index and run length (1..kQ + 1) of an element's hash.
+uint8_t patLen(StringView element, size_t *index) {
+  uint64_t hash = murmurHash64A(element.data(), element.size(), kHashSeed);
+  *index = hash & kPMask;
+  hash >>= kP;
+  // Bounds the run at kQ + 1 when the remaining bits are all zero.
+  hash |= 1ull << kQ;
+  return static_cast<uint8_t>(__builtin_ctzll(hash) + 1);
+}
+
+void createSparse(String &hll) {
+  hll.resize(kHllHeaderSize + 2);
+  _HllHeader *hdr = header(hll);
+  memcpy(hdr->magic, kMagic, sizeof(kMagic));
+  hdr->encoding = kEncodingSparse;
+  encodeZeros(registers(hll), kHllRegisters);
+}
+
+// Rewrites a sparse hll as dense; false if the opcodes are corrupt.
+bool sparseToDense(String &hll) {
+  String dense;
+  dense.resize(kHllDenseSize);
+  memcpy(dense.begin(), hll.data(), kHllHeaderSize);
+  header(dense)->encoding = kEncodingDense;
+  uint8_t *regs = registers(dense);
+  const uint8_t *p = registers(StringView(hll)), *end = registersEnd(hll);
+  size_t idx = 0;
+  while (p < end) {
+    if (isZero(*p)) {
+      idx += zeroLen(*p);
+      p++;
+    } else if (isXZero(*p)) {
+      if (p + 1 >= end) { return false; }
+      idx += xzeroLen(p);
+      p += 2;
+    } else {
+      size_t len = valLen(*p);
+      if (idx + len > kHllRegisters) { return false; }
+      for (size_t i = 0; i < len; i++) { denseSet(regs, idx++, valValue(*p)); }
+      p++;
+    }
+  }
+  if (idx != kHllRegisters) { return false; }
+  hll = std::move(dense);
+  return true;
+}
+
+int denseAdd(String &hll, size_t index, uint8_t count) {
+  uint8_t *regs = registers(hll);
+  if (denseGet(regs, index) >= count) { return 0; }
+  denseSet(regs, index, count);
+  return 1;
+}
+
+// After an edit at offset, folds neighbouring VAL opcodes holding the
+// same value, looking at a few opcodes only as an edit touches at most
+// three of them.
+void mergeAdjacentVals(String &hll, size_t offset) {
+  auto base = reinterpret_cast<uint8_t *>(hll.begin());
+  uint8_t *p = base + offset, *end = base + hll.size();
+  for (int scan = 5; p < end && scan > 0; scan--) {
+    if (isXZero(*p)) { p += 2; continue; }
+    if (isZero(*p)) { p++; continue; }
+    if (p + 1 < end && isVal(p[1]) && valValue(p[0]) == valValue(p[1]) &&
+        valLen(p[0]) + valLen(p[1]) <= kValMaxLen) {
+      *p = makeVal(valValue(p[0]), valLen(p[0]) + valLen(p[1]));
+      memmove(p + 1, p + 2, end - p - 2);
+      hll.resize(hll.size() - 1);
+      end--;
+      continue;
+    }
+    p++;
+  }
+}
+
+int promoteAndAdd(String &hll, size_t index, uint8_t count) {
+  if (!sparseToDense(hll)) { return -1; }
+  return denseAdd(hll, index, count);
+}
+
+// Sets register index to count if that raises it, splitting the opcode
+// that covers index into at most three.
+int sparseAdd(String &hll, size_t index, uint8_t count) {
+  if (count > kValMax) { return promoteAndAdd(hll, index, count); }
+  auto base = reinterpret_cast<uint8_t *>(hll.begin());
+  uint8_t *start = base + kHllHeaderSize, *end = base + hll.size();
+  uint8_t *p = start, *prev = nullptr;
+  size_t first = 0, span = 0, oplen = 0;
+  while (p < end) {
+    if (isXZero(*p)) {
+      if (p + 1 >= end) { return -1; }
+      span = xzeroLen(p);
+      oplen = 2;
+    } else {
+      span = isZero(*p) ? zeroLen(*p) : valLen(*p);
+      oplen = 1;
+    }
+    if (index < first + span) { break; }
+    prev = p;
+    first += span;
+    p += oplen;
+  }
+  if (p >= end) { return -1; }
+  size_t offset = p - base;
+  size_t mergeFrom = (prev ? prev : start) - base;
+
+  uint8_t seq[5];
+  size_t seqlen = 0, last = first + span - 1;
+  if (isVal(*p)) {
+    uint8_t old = valValue(*p);
+    if (old >= count) { return 0; }
+    if (index != first) { seq[seqlen++] = makeVal(old, index - first); }
+    seq[seqlen++] = makeVal(count, 1);
+    if (index != last) { seq[seqlen++] = makeVal(old, last - index); }
+  } else {
+    if (index != first) { seqlen += encodeZeros(seq + seqlen, index - first); }
+    seq[seqlen++] = makeVal(count, 1);
+    if (index != last) { seqlen += encodeZeros(seq + seqlen, last - index); }
+  }
+
+  size_t size = hll.size();
+  if (seqlen > oplen) {
+    if (size + seqlen - oplen > kHllSparseMaxBytes) {
+      return promoteAndAdd(hll, index, count);
+    }
+    hll.resize(size + seqlen - oplen);
+    base = reinterpret_cast<uint8_t *>(hll.begin());
+  }
+  memmove(base + offset + seqlen, base + offset + oplen,
+          size - offset - oplen);
+  memcpy(base + offset, seq, seqlen);
+  if (seqlen < oplen) { hll.resize(size - (oplen - seqlen)); }
+  mergeAdjacentVals(hll, mergeFrom);
+  return 1;
+}
+
+// Register histograms feeding the estimator; registers hold 0..63.
+
+void denseHisto(const uint8_t *regs, int *histo) {
+  for (size_t i = 0; i < kHllRegisters / 4; i++, regs += 3) {
+    uint32_t w = regs[0] | (regs[1] << 8) | (regs[2] << 16);
+    histo[w & 63]++;
+    histo[(w >> 6) & 63]++;
+    histo[(w >> 12) & 63]++;
+    histo[w >> 18]++;
+  }
+}
+
+bool sparseHisto(const uint8_t *p, const uint8_t *end, int *histo) {
+  size_t idx = 0;
+  while (p < end) {
+    if (isZero(*p)) {
+      idx += zeroLen(*p);
+      histo[0] += static_cast<int>(zeroLen(*p));
+      p++;
+    } else if (isXZero(*p)) {
+      if (p + 1 >= end) { return false; }
+      idx += xzeroLen(p);
+      histo[0] += static_cast<int>(xzeroLen(p));
+      p += 2;
+    } else {
+      idx += valLen(*p);
+      histo[valValue(*p)] += static_cast<int>(valLen(*p));
+      p++;
+    }
+  }
+  return idx == kHllRegisters;
+}
+
+// Neighbouring registers mostly share a value, so four tables split
+// the chain of increments on the same counter.
+void rawHisto(const uint8_t *raw, int *histo) {
+  int partial[4][64] = {};
+  for (size_t i = 0; i < kHllRegisters; i += 4) {
+    partial[0][raw[i]]++;
+    partial[1][raw[i + 1]]++;
+    partial[2][raw[i + 2]]++;
+    partial[3][raw[i + 3]]++;
+  }
+  for (int j = 0; j < 64; j++) {
+    histo[j] += partial[0][j] + partial[1][j] + partial[2][j] + partial[3][j];
+  }
+}
+
+double hllSigma(double x) {
+  if (x == 1.) { return INFINITY; }
+  double zPrime, y = 1, z = x;
+  do {
+    x *= x;
+    zPrime = z;
+    z += x * y;
+    y += y;
+  } while (zPrime != z);
+  return z;
+}
+
+double hllTau(double x) {
+  if (x == 0. || x == 1.) { return 0.; }
+  double zPrime, y = 1.0, z = 1 - x;
+  do {
+    x = sqrt(x);
+    zPrime = z;
+    y *= 0.5;
+    z -= pow(1 - x, 2) * y;
+  } while (zPrime != z);
+  return z / 3;
+}
+
+// Ertl's improved raw estimator ("New cardinality estimation algorithms
+// for HyperLogLog sketches"), as used by Redis; no bias tables needed.
+uint64_t estimate(const int *histo) {
+  double m = kHllRegisters;
+  double z = m * hllTau((m - histo[kQ + 1]) / m);
+  for (int j = kQ; j >= 1; --j) {
+    z += histo[j];
+    z *= 0.5;
+  }
+  z += m * hllSigma(histo[0] / m);
+  return static_cast<uint64_t>(llroundl(kAlphaInf * m * m / z));
+}
+
+// Merging works on raw registers, one byte each, keeping the maximum.
+
+void mergeDenseScalar(uint8_t *max, const uint8_t *regs) {
+  for (size_t i = 0; i < kHllRegisters; i += 4, regs += 3) {
+    uint32_t w = regs[0] | (regs[1] << 8) | (regs[2] << 16);
+    for (int k = 0; k < 4; k++) {
+      auto v = static_cast<uint8_t>((w >> (6 * k)) & 63);
+      if (v > max[i + k]) { max[i + k] = v; }
+    }
+  }
+}
+
+void packDenseScalar(uint8_t *regs, const uint8_t *raw, size_t n) {
+  for (size_t i = 0; i < n; i += 4, regs += 3) {
+    uint32_t w = raw[i] | (raw[i + 1] << 6) | (raw[i + 2] << 12) |
+                 (raw[i + 3] << 18);
+    regs[0] = static_cast<uint8_t>(w);
+    regs[1] = static_cast<uint8_t>(w >> 8);
+    regs[2] = static_cast<uint8_t>(w >> 16);
+  }
+}
+
+#if defined(__x86_64__)
+
+#define RD_AVX2 __attribute__((target("avx2")))
+
+// 24 packed bytes hold 32 registers. Each group of three bytes is
+// spread into a 32-bit lane, then the four 6-bit fields are shifted to
+// byte boundaries. vpshufb cannot cross 128-bit lanes, so the load
+// starts 4 bytes early (inside the header) to put bytes 12..23 at the
+// start of the upper lane. The last block would read past the
+// registers and is left to the scalar loop.
+RD_AVX2 void mergeDenseAvx2(uint8_t *max, const uint8_t *regs) {
+  const __m256i spread = _mm256_setr_epi8(
+      4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1,
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m256i m0 = _mm256_set1_epi32(0x3f);
+  const __m256i m1 = _mm256_set1_epi32(0x3f00);
+  const __m256i m2 = _mm256_set1_epi32(0x3f0000);
+  const __m256i m3 = _mm256_set1_epi32(0x3f000000);
+  const size_t blocks = kHllRegisters / 32 - 1;
+  for (size_t b = 0; b < blocks; b++, regs += 24, max += 32) {
+    __m256i x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(regs - 4));
+    x = _mm256_shuffle_epi8(x, spread);
+    __m256i v = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(x, m0),
+                        _mm256_and_si256(_mm256_slli_epi32(x, 2), m1)),
+        _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi32(x, 4), m2),
+                        _mm256_and_si256(_mm256_slli_epi32(x, 6), m3)));
+    auto out = reinterpret_cast<__m256i *>(max);
+    _mm256_storeu_si256(out, _mm256_max_epu8(_mm256_loadu_si256(out), v));
+  }
+  for (size_t i = 0; i < 32; i += 4, regs += 3) {
+    uint32_t w = regs[0] | (regs[1] << 8) | (regs[2] << 16);
+    for (int k = 0; k < 4; k++) {
+      auto v = static_cast<uint8_t>((w >> (6 * k)) & 63);
+      if (v > max[i + k]) { max[i + k] = v; }
+    }
+  }
+}
+
+// The inverse: four raw bytes fold into the low 24 bits of each lane,
+// vpshufb packs 12 bytes per 128-bit lane and vpermd joins the lanes.
+// Every store spills 8 bytes that the next block overwrites, so the last
+// block goes through the scalar packer.
+RD_AVX2 void packDenseAvx2(uint8_t *regs, const uint8_t *raw) {
+  const __m256i pack = _mm256_setr_epi8(
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  const __m256i join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+  const __m256i m0 = _mm256_set1_epi32(0x3f);
+  const __m256i m1 = _mm256_set1_epi32(0x3f00);
+  const __m256i m2 = _mm256_set1_epi32(0x3f0000);
+  const __m256i m3 = _mm256_set1_epi32(0x3f000000);
+  const size_t blocks = kHllRegisters / 32 - 1;
+  for (size_t b = 0; b < blocks; b++, regs += 24, raw += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(raw));
+    __m256i w = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(x, m0),
+                        _mm256_srli_epi32(_mm256_and_si256(x, m1), 2)),
+        _mm256_or_si256(_mm256_srli_epi32(_mm256_and_si256(x, m2), 4),
+                        _mm256_srli_epi32(_mm256_and_si256(x, m3), 6)));
+    w = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(w, pack), join);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(regs), w);
+  }
+  packDenseScalar(regs, raw, 32);
+}
+
+#undef RD_AVX2
+
+#endif
+
+bool useAvx2() {
+#if defined(__x86_64__)
+  return simd::level() == simd::Level::kAVX2;
+#else
+  return false;
+#endif
+}
+
+void mergeDense(uint8_t *max, const uint8_t *regs) {
+#if defined(__x86_64__)
+  if (useAvx2()) { return mergeDenseAvx2(max, regs); }
+#endif
+  mergeDenseScalar(max, regs);
+}
+
+void packDense(uint8_t *regs, const uint8_t *raw) {
+#if defined(__x86_64__)
+  if (useAvx2()) { return packDenseAvx2(regs, raw); }
+#endif
+  packDenseScalar(regs, raw, kHllRegisters);
+}
+
+bool mergeSparse(uint8_t *max, const uint8_t *p, const uint8_t *end) {
+  size_t idx = 0;
+  while (p < end) {
+    if (isZero(*p)) {
+      idx += zeroLen(*p);
+      p++;
+    } else if (isXZero(*p)) {
+      if (p + 1 >= end) { return false; }
+      idx += xzeroLen(p);
+      p += 2;
+    } else {
+      size_t len = valLen(*p);
+      if (idx + len > kHllRegisters) { return false; }
+      for (uint8_t v = valValue(*p); len > 0; len--, idx++) {
+        if (v > max[idx]) { max[idx] = v; }
+      }
+      p++;
+    }
+  }
+  return idx == kHllRegisters;
+}
+
+// Folds hll into max; empty strings stand for missing counters.
+bool mergeInto(uint8_t *max, StringView hll, bool *dense) {
+  if (hll.size() == 0) { return true; }
+  switch (hllEncoding(hll)) {
+    case HllEncoding::kDense:
+      *dense = true;
+      mergeDense(max, registers(hll));
+      return true;
+    case HllEncoding::kSparse:
+      return mergeSparse(max, registers(hll), registersEnd(hll));
+    default:
+      return false;
+  }
+}
+
+void initHeader(String &hll, uint8_t encoding) {
+  _HllHeader *hdr = header(hll);
+  memcpy(hdr->magic, kMagic, sizeof(kMagic));
+  hdr->encoding = encoding;
+  memset(hdr->notused, 0, sizeof(hdr->notused));
+  setCachedCard(hdr, 0);
+  invalidateCache(hdr);
+}
+
+// Sparse encoding of raw registers; false when it would not fit in
+// kHllSparseMaxBytes or a register is too large for a VAL opcode.
+bool rawToSparse(const uint8_t *raw, String &hll) {
+  uint8_t buf[kHllSparseMaxBytes];
+  size_t len = 0, limit = kHllSparseMaxBytes - kHllHeaderSize;
+  for (size_t i = 0; i < kHllRegisters;) {
+    if (len + 2 > limit) { return false; }
+    size_t run = 1;
+    if (raw[i] == 0) {
+      while (i + run < kHllRegisters && raw[i + run] == 0) { run++; }
+      len += encodeZeros(buf + len, run);
+    } else {
+      if (raw[i] > kValMax) { return false; }
+      while (run < kValMaxLen && i + run < kHllRegisters &&
+             raw[i + run] == raw[i]) {
+        run++;
+      }
+      buf[len++] = makeVal(raw[i], run);
+    }
+    i += run;
+  }
+  hll.resize(kHllHeaderSize + len);
+  initHeader(hll, kEncodingSparse);
+  memcpy(registers(hll), buf, len);
+  return true;
+}
+
+void rawToDense(const uint8_t *raw, String &hll) {
+  hll.resize(kHllDenseSize);
+  initHeader(hll, kEncodingDense);
+  packDense(registers(hll), raw);
+}
+
+}  // namespace
+
+HllEncoding hllEncoding(StringView hll) {
+  if (hll.size() < kHllHeaderSize) { return HllEncoding::kInvalid; }
+  const _HllHeader *hdr = header(hll);
+  if (memcmp(hdr->magic, kMagic, sizeof(kMagic)) != 0) {
+    return HllEncoding::kInvalid;
+  }
+  if (hdr->encoding == kEncodingDense) {
+    return hll.size() == kHllDenseSize ? HllEncoding::kDense
+                                       : HllEncoding::kInvalid;
+  }
+  return hdr->encoding == kEncodingSparse ? HllEncoding::kSparse
+                                          : HllEncoding::kInvalid;
+}
+
+int pfAdd(String &hll, const StringView *elements, size_t n) {
+  int updated = 0;
+  if (hll.empty()) {
+    createSparse(hll);
+    updated = 1;
+  } else if (hllEncoding(hll) == HllEncoding::kInvalid) {
+    return -1;
+  }
+  for (size_t i = 0; i < n; i++) {
+    size_t index;
+    uint8_t count = patLen(elements[i], &index);
+    int ret = header(hll)->encoding == kEncodingDense
+        ? denseAdd(hll, index, count) : sparseAdd(hll, index, count);
+    if (ret < 0) { return -1; }
+    updated |= ret;
+  }
+  if (updated) { invalidateCache(header(hll)); }
+  return updated;
+}
+
+int pfAdd(String &hll, std::initializer_list<StringView> elements) {
+  return pfAdd(hll, elements.begin(), elements.size());
+}
+
+bool pfCount(String &hll, uint64_t *card) {
+  if (hll.empty()) {
+    *card = 0;
+    return true;
+  }
+  HllEncoding encoding = hllEncoding(hll);
+  if (encoding == HllEncoding::kInvalid) { return false; }
+  _HllHeader *hdr = header(hll);
+  if (cacheValid(hdr)) {
+    *card = cachedCard(hdr);
+    return true;
+  }
+  int histo[64] = {};
+  if (encoding == HllEncoding::kDense) {
+    denseHisto(registers(hll), histo);
+  } else if (!sparseHisto(registers(hll), registersEnd(hll), histo)) {
+    return false;
+  }
+  *card = estimate(histo);
+  setCachedCard(hdr, *card);
+  return true;
+}
+
+bool pfCount(const StringView *hlls, size_t n, uint64_t *card) {
+  if (n == 1 && hllEncoding(hlls[0]) != HllEncoding::kInvalid &&
+      cacheValid(header(hlls[0]))) {
+    *card = cachedCard(header(hlls[0]));
+    return true;
+  }
+  uint8_t max[kHllRegisters] = {};
+  bool dense = false;
+  for (size_t i = 0; i < n; i++) {
+    if (!mergeInto(max, hlls[i], &dense)) { return false; }
+  }
+  int histo[64] = {};
+  rawHisto(max, histo);
+  *card = estimate(histo);
+  return true;
+}
+
+bool pfCount(std::initializer_list<StringView> hlls, uint64_t *card) {
+  return pfCount(hlls.begin(), hlls.size(), card);
+}
+
+bool pfMerge(String &dest, const StringView *srcs, size_t n) {
+  uint8_t max[kHllRegisters] = {};
+  bool dense = false;
+  if (!mergeInto(max, dest, &dense)) { return false; }
+  for (size_t i = 0; i < n; i++) {
+    if (!mergeInto(max, srcs[i], &dense)) { return false; }
+  }
+  // Sources may point into dest, so it is only written from here on.
+  if (dense || !rawToSparse(max, dest)) { rawToDense(max, dest); }
+  return true;
+}
+
+bool pfMerge(String &dest, std::initializer_list<StringView> srcs) {
+  return pfMerge(dest, srcs.begin(), srcs.size());
+}
+
+}  // namespace rd
@@ -0,0 +1,424 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For std::sort, std::unique
+#include <algorithm>
+// For memcpy
+#include <cstring>
+// For std::conditional, std::decay_t, std::is_same
+#include <type_traits>
+// For std::swap
+#include <utility>
+// For std::vector
+#include <vector>
+#include "intset.h"
+#include "simd.h"
+#include "zmalloc.h"
+
+namespace rd {
+
+namespace {
+// Searches end in a linear rank of this many bytes, two AVX2 registers:
+// wider windows measured slower on 100K-element sets.
+const size_type kRankWindow = 64;
+
+size_type rank(const int16_t *a, size_type n, int16_t key) {
+  return simd::kernels().rank16(a, n, key);
+}
+
+size_type rank(const int32_t *a, size_type n, int32_t key) {
+  return simd::kernels().rank32(a, n, key);
+}
+
+size_type rank(const int64_t *a, size_type n, int64_t key) {
+  return simd::kernels().rank64(a, n, key);
+}
+
+size_type intersectSame(const int16_t *a, size_type na,
+                        const int16_t *b, size_type nb, int16_t *out) {
+  return simd::kernels().intersect16(a, na, b, nb, out);
+}
+
+size_type intersectSame(const int32_t *a, size_type na,
+                        const int32_t *b, size_type nb, int32_t *out) {
+  return simd::kernels().intersect32(a, na, b, nb, out);
+}
+
+size_type intersectSame(const int64_t *a, size_type na,
+                        const int64_t *b, size_type nb, int64_t *out) {
+  return simd::kernels().intersect64(a, na, b, nb, out);
+}
+
+template<class A, class B>
+using Narrower = typename std::conditional<sizeof(A) <= sizeof(B), A, B>::type;
+template<class A, class B>
+using Wider = typename std::conditional<sizeof(A) <= sizeof(B), B, A>::type;
+
+// fn(const T *elements) with T the element type of encoding.
+template<class Fn>
+void visit(const char *contents, uint32_t encoding, Fn fn) {
+  if (encoding == IntSet::kEncInt64) {
+    fn(reinterpret_cast<const int64_t *>(contents));
+  } else if (encoding == IntSet::kEncInt32) {
+    fn(reinterpret_cast<const int32_t *>(contents));
+  } else {
+    fn(reinterpret_cast<const int16_t *>(contents));
+  }
+}
+
+// The first position in [lo, hi) of the sorted a whose element is not
+// less than value, or hi. The halving is branch-free, as which half holds
+// value is a coin toss, and leaves a window for the rank kernel; a value
+// of another width, which the kernel cannot take, is halved down to one
+// element.
+template<class T, class V>
+size_type lowerBound(const T *a, size_type lo, size_type hi, V value) {
+  const size_type window =
+      std::is_same<T, V>::value ? kRankWindow / sizeof(T) : 1;
+  const T *base = a + lo;
+  size_type n = hi - lo;
+  while (n > window) {
+    size_type half = n / 2;
+    base = base[half] < value ? base + half : base;
+    n -= half;
+  }
+  if constexpr (std::is_same<T, V>::value) {
+    return base - a + rank(base, n, value);
+  } else {
+    return base - a + (n == 1 && *base < value);
+  }
+}
+
+// lowerBound over [from, n) by galloping: probes from, from + 1, from + 3,
+// from + 7, ..., then searches the last gap, so finding a position d
+// elements on costs O(log d).
+template<class T, class V>
+size_type gallop(const T *a, size_type from, size_type n, V value) {
+  size_type lo = from, hi = from, step = 1;
+  while (hi < n && a[hi] < value) {
+    lo = hi + 1;
+    hi += step;
+    step <<= 1u;
+  }
+  return lowerBound(a, lo, hi < n ? hi : n, value);
+}
+
+// The set operations on the arrays a and b, writing to out and returning
+// the length written. intersectArrays and uniteArrays need na <= nb.
+
+template<class A, class B>
+size_type intersectArrays(const A *a, size_type na, const B *b, size_type nb,
+                          char *dst) {
+  auto out = reinterpret_cast<Narrower<A, B> *>(dst);
+  size_type k = 0;
+  if (na * IntSet::kGallopRatio < nb) {
+    for (size_type i = 0, j = 0; i < na; i++) {
+      j = gallop(b, j, nb, a[i]);
+      if (j == nb) { break; }
+      if (b[j] == a[i]) {
+        out[k++] = static_cast<Narrower<A, B>>(a[i]);
+        j++;
+      }
+    }
+    return k;
+  }
+  if constexpr (std::is_same<A, B>::value) {
+    return intersectSame(a, na, b, nb, out);
+  } else {
+    // Elements wider than out are cast, but only kept if equal to one
+    // that fits.
+    size_type i = 0, j = 0;
+    while (i < na && j < nb) {
+      A x = a[i];
+      B y = b[j];
+      out[k] = static_cast<Narrower<A, B>>(x);
+      k += x == y;
+      i += x <= y;
+      j += y <= x;
+    }
+    return k;
+  }
+}
+
+template<class A, class B>
+size_type uniteArrays(const A *a, size_type na, const B *b, size_type nb,
+                      char *dst) {
+  auto out = reinterpret_cast<Wider<A, B> *>(dst);
+  size_type i = 0, j = 0, k = 0;
+  if (na * IntSet::kGallopRatio < nb) {
+    // Runs of b between the elements of a are copied whole.
+    for (; i < na; i++) {
+      size_type p = gallop(b, j, nb, a[i]);
+      for (; j < p; j++) { out[k++] = b[j]; }
+      out[k++] = a[i];
+      if (j < nb && b[j] == a[i]) { j++; }
+    }
+  } else {
+    while (i < na && j < nb) {
+      Wider<A, B> x = a[i], y = b[j];
+      out[k++] = x <= y ? x : y;
+      i += x <= y;
+      j += y <= x;
+    }
+    for (; i < na; i++) { out[k++] = a[i]; }
+  }
+  for (; j < nb; j++) { out[k++] = b[j]; }
+  return k;
+}
+
+template<class A, class B>
+size_type differenceArrays(const A *a, size_type na,
+                           const B *b, size_type nb, char *dst) {
+  auto out = reinterpret_cast<A *>(dst);
+  size_type i = 0, j = 0, k = 0;
+  if (na * IntSet::kGallopRatio < nb) {
+    for (; i < na; i++) {
+      j = gallop(b, j, nb, a[i]);
+      if (j == nb || b[j] != a[i]) { out[k++] = a[i]; }
+    }
+    return k;
+  }
+  if (nb * IntSet::kGallopRatio < na) {
+    // Runs of a between the elements of b are copied whole.
+    for (; j < nb; j++) {
+      size_type p = gallop(a, i, na, b[j]);
+      for (; i < p; i++) { out[k++] = a[i]; }
+      if (i < na && a[i] == b[j]) { i++; }
+    }
+  } else {
+    while (i < na && j < nb) {
+      A x = a[i];
+      B y = b[j];
+      out[k] = x;
+      k += x < y;
+      i += x <= y;
+      j += y <= x;
+    }
+  }
+  for (; i < na; i++) { out[k++] = a[i]; }
+  return k;
+}
+}  // namespace
+
+uint32_t IntSet::valueEncoding(long long value) {
+  if (value < INT32_MIN || value > INT32_MAX) { return kEncInt64; }
+  if (value < INT16_MIN || value > INT16_MAX) { return kEncInt32; }
+  return kEncInt16;
+}
+
+IntSet::IntSet() : IntSet(kEncInt16, 0) {}
+
+IntSet::IntSet(uint32_t encoding, size_type capacity) {
+  is_ = static_cast<_Header *>(
+      zmalloc(sizeof(_Header) + capacity * encoding));
+  is_->encoding = encoding;
+  is_->length = capacity;
+}
+
+IntSet::IntSet(const long long *values, size_type n) {
+  std::vector<long long> sorted(values, values + n);
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  uint32_t encoding = kEncInt16;
+  if (!sorted.empty()) {
+    encoding = std::max(valueEncoding(sorted.front()),
+                        valueEncoding(sorted.back()));
+  }
+  is_ = static_cast<_Header *>(
+      zmalloc(sizeof(_Header) + sorted.size() * encoding));
+  is_->encoding = encoding;
+  is_->length = sorted.size();
+  for (size_type i = 0; i < sorted.size(); i++) { setEncoded(i, sorted[i]); }
+}
+
+IntSet::IntSet(IntSet &&other) noexcept : is_(other.is_) {
+  other.is_ = nullptr;
+}
+
+IntSet &IntSet::operator=(IntSet &&other) noexcept {
+  std::swap(is_, other.is_);
+  return *this;
+}
+
+IntSet::~IntSet() {
+  if (is_ != nullptr) { zfree(is_, bytes()); }
+}
+
+long long IntSet::getEncoded(const char *contents, size_type pos,
+                             uint32_t encoding) {
+  const char *p = contents + pos * encoding;
+  if (encoding == kEncInt64) {
+    int64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  } else if (encoding == kEncInt32) {
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+  int16_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+void IntSet::setEncoded(size_type pos, long long value) {
+  char *p = contents() + pos * encoding();
+  if (encoding() == kEncInt64) {
+    int64_t v = value;
+    memcpy(p, &v, sizeof(v));
+  } else if (encoding() == kEncInt32) {
+    int32_t v = static_cast<int32_t>(value);
+    memcpy(p, &v, sizeof(v));
+  } else {
+    int16_t v = static_cast<int16_t>(value);
+    memcpy(p, &v, sizeof(v));
+  }
+}
+
+bool IntSet::search(long long value, size_type *pos) const {
+  size_type n = size();
+  // Appends and prepends, the common case of a growing id set, skip the
+  // search.
+  if (n == 0 || value > get(n - 1)) {
+    *pos = n;
+    return false;
+  }
+  if (value < get(0)) {
+    *pos = 0;
+    return false;
+  }
+  // Callers only search for values that fit the encoding.
+  visit(contents(), encoding(), [&](auto elements) {
+    typedef std::decay_t<decltype(*elements)> T;
+    *pos = lowerBound(elements, 0, n, static_cast<T>(value));
+  });
+  return get(*pos) == value;
+}
+
+void IntSet::truncate(size_type length) {
+  if (length == size()) { return; }
+  _Header *old = is_;
+  is_ = static_cast<_Header *>(
+      zmalloc(sizeof(_Header) + length * old->encoding));
+  is_->encoding = old->encoding;
+  is_->length = length;
+  memcpy(contents(), old + 1, length * old->encoding);
+  zfree(old, sizeof(_Header) + old->length * old->encoding);
+}
+
+void IntSet::rebuild(uint32_t encoding, size_type length, size_type pos) {
+  _Header *old = is_;
+  size_type old_length = old->length;
+  uint32_t old_encoding = old->encoding;
+  is_ = static_cast<_Header *>(zmalloc(sizeof(_Header) + length * encoding));
+  is_->encoding = encoding;
+  is_->length = length;
+  const char *from = reinterpret_cast<const char *>(old + 1);
+  // Elements at and after pos move one slot right on a grow, and come
+  // from one slot right on a shrink.
+  size_type shift_to = length > old_length ? pos + 1 : pos;
+  size_type shift_from = length > old_length ? pos : pos + 1;
+  if (encoding == old_encoding) {
+    memcpy(contents(), from, pos * encoding);
+    memcpy(contents() + shift_to * encoding, from + shift_from * encoding,
+           (old_length - shift_from) * encoding);
+  } else {
+    // Upgrades widen every element, which memcpy cannot.
+    for (size_type i = 0; i < pos; i++) {
+      setEncoded(i, getEncoded(from, i, old_encoding));
+    }
+    for (size_type i = shift_from; i < old_length; i++) {
+      setEncoded(i - shift_from + shift_to,
+                 getEncoded(from, i, old_encoding));
+    }
+  }
+  zfree(old, sizeof(_Header) + old_length * old_encoding);
+}
+
+bool IntSet::add(long long value) {
+  uint32_t encoding = valueEncoding(value);
+  size_type pos;
+  if (encoding > this->encoding()) {
+    // Wider than every element, so smaller or larger than all of them.
+    pos = value < 0 ? 0 : size();
+  } else if (search(value, &pos)) {
+    return false;
+  } else {
+    encoding = this->encoding();
+  }
+  rebuild(encoding, size() + 1, pos);
+  setEncoded(pos, value);
+  return true;
+}
+
+bool IntSet::remove(long long value) {
+  size_type pos;
+  if (valueEncoding(value) > encoding() || !search(value, &pos)) {
+    return false;
+  }
+  rebuild(encoding(), size() - 1, pos);
+  return true;
+}
+
+bool IntSet::contains(long long value) const {
+  size_type pos;
+  return valueEncoding(value) <= encoding() && search(value, &pos);
+}
+
+IntSet IntSet::intersect(const IntSet &a, const IntSet &b) {
+  if (a.size() > b.size()) { return intersect(b, a); }
+  IntSet out(std::min(a.encoding(), b.encoding()), a.size());
+  size_type n = 0;
+  visit(a.contents(), a.encoding(), [&](auto x) {
+    visit(b.contents(), b.encoding(), [&](auto y) {
+      n = intersectArrays(x, a.size(), y, b.size(), out.contents());
+    });
+  });
+  out.truncate(n);
+  return out;
+}
+
+IntSet IntSet::intersect(const IntSet *const *sets, size_type n) {
+  if (n == 0) { return IntSet(); }
+  if (n == 1) { return intersect(*sets[0], *sets[0]); }
+  // The smallest first bounds every intermediate result, and the larger
+  // the gaps in size, the more of the work galloping skips.
+  std::vector<const IntSet *> order(sets, sets + n);
+  std::sort(order.begin(), order.end(),
+            [](const IntSet *x, const IntSet *y) {
+              return x->size() < y->size();
+            });
+  IntSet result = intersect(*order[0], *order[1]);
+  for (size_type i = 2; i < n && !result.empty(); i++) {
+    result = intersect(result, *order[i]);
+  }
+  return result;
+}
+
+IntSet IntSet::unite(const IntSet &a, const IntSet &b) {
+  if (a.size() > b.size()) { return unite(b, a); }
+  IntSet out(std::max(a.encoding(), b.encoding()), a.size() + b.size());
+  size_type n = 0;
+  visit(a.contents(), a.encoding(), [&](auto x) {
+    visit(b.contents(), b.encoding(), [&](auto y) {
+      n = uniteArrays(x, a.size(), y, b.size(), out.contents());
+    });
+  });
+  out.truncate(n);
+  return out;
+}
+
+IntSet IntSet::difference(const IntSet &a, const IntSet &b) {
+  IntSet out(a.encoding(), a.size());
+  size_type n = 0;
+  visit(a.contents(), a.encoding(), [&](auto x) {
+    visit(b.contents(), b.encoding(), [&](auto y) {
+      n = differenceArrays(x, a.size(), y, b.size(), out.contents());
+    });
+  });
+  out.truncate(n);
+  return out;
+}
+
+}  // namespace rd
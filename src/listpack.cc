@@ -0,0 +1,339 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For assert
+#include <cassert>
+// For memcpy, memcmp
+#include <cstring>
+// For std::swap
+#include <utility>
+#include "listpack.h"
+#include "util.h"
+#include "zmalloc.h"
+
+namespace rd {
+
+namespace {
+const unsigned char kEnd = 0xFF;
+// The count of a listpack with 65535 elements or more.
+const uint32_t kUnknownCount = 0xFFFF;
+
+// Element encodings, as in Redis' listpack.c.
+const unsigned char kEnc7BitUint = 0x00;
+const unsigned char kEnc6BitStr = 0x80;
+const unsigned char kEnc13BitInt = 0xC0;
+const unsigned char kEnc12BitStr = 0xE0;
+const unsigned char kEnc32BitStr = 0xF0;
+const unsigned char kEnc16BitInt = 0xF1;
+const unsigned char kEnc24BitInt = 0xF2;
+const unsigned char kEnc32BitInt = 0xF3;
+const unsigned char kEnc64BitInt = 0xF4;
+
+uint64_t readLittle(const unsigned char *p, int bytes) {
+  uint64_t v = 0;
+  for (int i = bytes - 1; i >= 0; i--) { v = v << 8u | p[i]; }
+  return v;
+}
+
+void writeLittle(unsigned char *p, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; i++, v >>= 8u) { p[i] = v & 0xFF; }
+}
+
+// A bits wide two's complement value back to a long long.
+long long signExtend(uint64_t v, int bits) {
+  if (bits < 64 && v >> (bits - 1) != 0) {
+    return static_cast<long long>(v) - (1LL << bits);
+  }
+  return static_cast<long long>(v);
+}
+
+size_type integerHeader(long long v, unsigned char *buf) {
+  uint64_t u = static_cast<uint64_t>(v);
+  if (v >= 0 && v <= 127) {
+    buf[0] = kEnc7BitUint | v;
+    return 1;
+  } else if (v >= -4096 && v <= 4095) {
+    buf[0] = kEnc13BitInt | ((u >> 8u) & 0x1F);
+    buf[1] = u & 0xFF;
+    return 2;
+  } else if (v >= -32768 && v <= 32767) {
+    buf[0] = kEnc16BitInt;
+    writeLittle(buf + 1, u, 2);
+    return 3;
+  } else if (v >= -8388608 && v <= 8388607) {
+    buf[0] = kEnc24BitInt;
+    writeLittle(buf + 1, u, 3);
+    return 4;
+  } else if (v >= -2147483648LL && v <= 2147483647LL) {
+    buf[0] = kEnc32BitInt;
+    writeLittle(buf + 1, u, 4);
+    return 5;
+  }
+  buf[0] = kEnc64BitInt;
+  writeLittle(buf + 1, u, 8);
+  return 9;
+}
+
+size_type stringHeader(size_type len, unsigned char *buf) {
+  if (len < 64) {
+    buf[0] = kEnc6BitStr | len;
+    return 1;
+  } else if (len < 4096) {
+    buf[0] = kEnc12BitStr | (len >> 8u);
+    buf[1] = len & 0xFF;
+    return 2;
+  }
+  buf[0] = kEnc32BitStr;
+  writeLittle(buf + 1, len, 4);
+  return 5;
+}
+
+size_type backlenSize(size_type len) {
+  if (len < 128) { return 1; }
+  if (len < 16384) { return 2; }
+  if (len < 2097152) { return 3; }
+  if (len < 268435456) { return 4; }
+  return 5;
+}
+
+// The length of an element, most significant 7 bits first; every byte
+// but the first has the high bit set, so reading from the right stops at
+// the first byte.
+void encodeBacklen(size_type len, unsigned char *buf) {
+  size_type n = backlenSize(len);
+  for (size_type i = 0; i < n; i++) {
+    size_type shift = 7 * (n - 1 - i);
+    buf[i] = ((len >> shift) & 127) | (i == 0 ? 0 : 128);
+  }
+}
+
+// Reads a backlen whose last byte is at p.
+size_type decodeBacklen(const unsigned char *p) {
+  size_type len = 0, shift = 0;
+  while (true) {
+    len |= static_cast<size_type>(p[0] & 127) << shift;
+    if ((p[0] & 128) == 0) { break; }
+    shift += 7;
+    p--;
+  }
+  return len;
+}
+}  // namespace
+
+StringView ListPackValue::view(char *buf) const {
+  if (sval != nullptr) { return StringView(sval, slen); }
+  return StringView(buf, ll2string(buf, kLongStrSize, lval));
+}
+
+ListPack::ListPack() {
+  lp_ = static_cast<unsigned char *>(zmalloc(kHeaderSize + 1));
+  writeLittle(lp_, kHeaderSize + 1, 4);
+  writeLittle(lp_ + 4, 0, 2);
+  lp_[kHeaderSize] = kEnd;
+}
+
+ListPack::ListPack(ListPack &&other) noexcept : lp_(other.lp_) {
+  other.lp_ = nullptr;
+}
+
+ListPack &ListPack::operator=(ListPack &&other) noexcept {
+  std::swap(lp_, other.lp_);
+  return *this;
+}
+
+ListPack::~ListPack() {
+  if (lp_ != nullptr) { zfree(lp_, totalBytes()); }
+}
+
+uint32_t ListPack::totalBytes() const {
+  return static_cast<uint32_t>(readLittle(lp_, 4));
+}
+
+size_type ListPack::entrySize(size_type p) const {
+  const unsigned char *e = lp_ + p;
+  if ((e[0] & 0x80) == kEnc7BitUint) { return 1; }
+  if ((e[0] & 0xC0) == kEnc6BitStr) { return 1 + (e[0] & 0x3F); }
+  if ((e[0] & 0xE0) == kEnc13BitInt) { return 2; }
+  if ((e[0] & 0xF0) == kEnc12BitStr) {
+    return 2 + ((e[0] & 0x0F) << 8u | e[1]);
+  }
+  switch (e[0]) {
+    case kEnc16BitInt: return 3;
+    case kEnc24BitInt: return 4;
+    case kEnc32BitInt: return 5;
+    case kEnc64BitInt: return 9;
+    case kEnc32BitStr: return 5 + readLittle(e + 1, 4);
+    default: assert(false);
+  }
+  return 0;
+}
+
+size_type ListPack::size() const {
+  uint32_t count = readLittle(lp_ + 4, 2);
+  if (count != kUnknownCount) { return count; }
+  size_type n = 0;
+  for (size_type p = first(); p != npos; p = next(p)) { n++; }
+  return n;
+}
+
+void ListPack::addCount(int delta) {
+  uint32_t count = readLittle(lp_ + 4, 2);
+  if (count == kUnknownCount) {
+    // Recount once it may fit again, so that shrinking back below the
+    // limit restores O(1) size().
+    if (delta > 0) { return; }
+    size_type n = size();
+    count = n < kUnknownCount ? n : kUnknownCount;
+  } else {
+    count += delta;
+    if (count > kUnknownCount) { count = kUnknownCount; }
+  }
+  writeLittle(lp_ + 4, count, 2);
+}
+
+size_type ListPack::first() const {
+  return lp_[kHeaderSize] == kEnd ? npos : kHeaderSize;
+}
+
+size_type ListPack::last() const {
+  return prev(terminator());
+}
+
+size_type ListPack::next(size_type p) const {
+  size_type len = entrySize(p);
+  p += len + backlenSize(len);
+  return lp_[p] == kEnd ? npos : p;
+}
+
+size_type ListPack::prev(size_type p) const {
+  if (p == kHeaderSize) { return npos; }
+  size_type len = decodeBacklen(lp_ + p - 1);
+  return p - backlenSize(len) - len;
+}
+
+size_type ListPack::seek(long long index) const {
+  size_type p;
+  if (index >= 0) {
+    for (p = first(); p != npos && index > 0; index--) { p = next(p); }
+  } else {
+    for (p = last(); p != npos && index < -1; index++) { p = prev(p); }
+  }
+  return p;
+}
+
+ListPackValue ListPack::get(size_type p) const {
+  const unsigned char *e = lp_ + p;
+  ListPackValue value{nullptr, 0, 0};
+  if ((e[0] & 0x80) == kEnc7BitUint) {
+    value.lval = e[0] & 0x7F;
+  } else if ((e[0] & 0xC0) == kEnc6BitStr) {
+    value.slen = e[0] & 0x3F;
+    value.sval = reinterpret_cast<const char *>(e + 1);
+  } else if ((e[0] & 0xE0) == kEnc13BitInt) {
+    value.lval = signExtend((e[0] & 0x1F) << 8u | e[1], 13);
+  } else if ((e[0] & 0xF0) == kEnc12BitStr) {
+    value.slen = (e[0] & 0x0F) << 8u | e[1];
+    value.sval = reinterpret_cast<const char *>(e + 2);
+  } else if (e[0] == kEnc32BitStr) {
+    value.slen = readLittle(e + 1, 4);
+    value.sval = reinterpret_cast<const char *>(e + 5);
+  } else {
+    int bytes = e[0] == kEnc16BitInt ? 2
+                : e[0] == kEnc24BitInt ? 3
+                : e[0] == kEnc32BitInt ? 4 : 8;
+    value.lval = signExtend(readLittle(e + 1, bytes), 8 * bytes);
+  }
+  return value;
+}
+
+size_type ListPack::splice(size_type p, size_type remove_len,
+                           const unsigned char *header, size_type header_len,
+                           const char *data, size_type data_len) {
+  size_type old_bytes = totalBytes();
+  size_type entry_len = header_len + data_len;
+  size_type add_len = header_len == 0 ? 0 : entry_len + backlenSize(entry_len);
+  size_type new_bytes = old_bytes - remove_len + add_len;
+  auto lp = static_cast<unsigned char *>(zmalloc(new_bytes));
+  memcpy(lp, lp_, p);
+  if (header_len != 0) {
+    memcpy(lp + p, header, header_len);
+    if (data_len != 0) { memcpy(lp + p + header_len, data, data_len); }
+    encodeBacklen(entry_len, lp + p + entry_len);
+  }
+  memcpy(lp + p + add_len, lp_ + p + remove_len, old_bytes - p - remove_len);
+  zfree(lp_, old_bytes);
+  lp_ = lp;
+  writeLittle(lp_, new_bytes, 4);
+  return p;
+}
+
+size_type ListPack::insertString(size_type p, size_type remove_len,
+                                 StringView s) {
+  long long value;
+  if (s.size() < kLongStrSize && string2ll(s.data(), s.size(), &value)) {
+    return insertInteger(p, remove_len, value);
+  }
+  unsigned char header[5];
+  size_type header_len = stringHeader(s.size(), header);
+  return splice(p, remove_len, header, header_len, s.data(), s.size());
+}
+
+size_type ListPack::insertInteger(size_type p, size_type remove_len,
+                                  long long value) {
+  unsigned char header[9];
+  size_type header_len = integerHeader(value, header);
+  return splice(p, remove_len, header, header_len, nullptr, 0);
+}
+
+size_type ListPack::insert(size_type p, StringView s) {
+  p = insertString(p == npos ? terminator() : p, 0, s);
+  addCount(1);
+  return p;
+}
+
+size_type ListPack::insert(size_type p, long long value) {
+  p = insertInteger(p == npos ? terminator() : p, 0, value);
+  addCount(1);
+  return p;
+}
+
+size_type ListPack::replace(size_type p, StringView s) {
+  size_type len = entrySize(p);
+  return insertString(p, len + backlenSize(len), s);
+}
+
+size_type ListPack::replace(size_type p, long long value) {
+  size_type len = entrySize(p);
+  return insertInteger(p, len + backlenSize(len), value);
+}
+
+size_type ListPack::remove(size_type p) {
+  size_type len = entrySize(p);
+  splice(p, len + backlenSize(len), nullptr, 0, nullptr, 0);
+  addCount(-1);
+  return lp_[p] == kEnd ? npos : p;
+}
+
+size_type ListPack::find(size_type p, StringView s, size_type skip) const {
+  long long number;
+  bool is_number =
+      s.size() < kLongStrSize && string2ll(s.data(), s.size(), &number);
+  for (size_type skipped = 0; p != npos; p = next(p)) {
+    if (skipped != 0) {
+      skipped--;
+      continue;
+    }
+    ListPackValue value = get(p);
+    if (value.sval == nullptr
+        ? is_number && value.lval == number
+        : value.slen == s.size() && memcmp(value.sval, s.data(),
+                                            s.size()) == 0) {
+      return p;
+    }
+    skipped = skip;
+  }
+  return npos;
+}
+
+}  // namespace rd
@@ -0,0 +1,188 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For std::chrono::steady_clock
+#include <chrono>
+// For LLONG_MIN, LLONG_MAX
+#include <climits>
+// For placement new
+#include <new>
+// For clock_gettime
+#include <time.h>
+#include "object.h"
+#include "util.h"
+
+namespace rd {
+
+Object::Object(long long value)
+    : encoding_(kEncodingInt), lru_(lruClock()), refcount_(1), int_(value) {}
+
+Object::Object(String &&str)
+    : encoding_(kEncodingRaw), lru_(lruClock()), refcount_(1),
+      str_(std::move(str)) {}
+
+Object::~Object() {
+  if (encoding_ == kEncodingRaw) {
+    str_.~String();
+  }
+}
+
+// Built on first use and never freed.
+Object *Object::sharedIntegers() {
+  static Object *pool = [] {
+    auto objects = static_cast<Object *>(
+        ::operator new(sizeof(Object) * kSharedIntegers));
+    for (long long i = 0; i < kSharedIntegers; i++) {
+      ::new(objects + i) Object(i);
+      objects[i].refcount_ = kSharedRefCount;
+    }
+    return objects;
+  }();
+  return pool;
+}
+
+Object *Object::createString(StringView s) {
+  long long value;
+  if (string2ll(s.data(), s.size(), &value)) {
+    return createInt(value);
+  }
+  return new Object(String(s));
+}
+
+Object *Object::createString(String &&s) {
+  long long value;
+  if (string2ll(s.data(), s.size(), &value)) {
+    return createInt(value);
+  }
+  return new Object(std::move(s));
+}
+
+Object *Object::createInt(long long value, bool shareable) {
+  if (shareable && value >= 0 && value < kSharedIntegers) {
+    return sharedIntegers() + value;
+  }
+  return new Object(value);
+}
+
+void Object::incrRef() {
+  if (!isShared()) { refcount_++; }
+}
+
+void Object::decrRef() {
+  if (isShared()) { return; }
+  if (--refcount_ == 0) { delete this; }
+}
+
+namespace {
+// Every lookup reads the clock, and ticks are seconds: the coarse clock
+// is precise enough at a fraction of the cost of steady_clock.
+uint64_t steadyMilliseconds() {
+#ifdef CLOCK_MONOTONIC_COARSE
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#else
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(
+      steady_clock::now().time_since_epoch()).count();
+#endif
+}
+}
+
+uint32_t Object::lruClock() {
+  return (steadyMilliseconds() / kLruClockResolution) & kLruClockMax;
+}
+
+uint16_t Object::lfuMinutes() {
+  return static_cast<uint16_t>(steadyMilliseconds() / 60000);
+}
+
+void Object::touchLru() {
+  if (!isShared()) { lru_ = lruClock(); }
+}
+
+// The clock wraps about every 194 days at second resolution; an object
+// idle for longer than that looks younger than it is.
+uint64_t Object::idleMilliseconds() const {
+  uint64_t ticks = (lruClock() - lru_) & kLruClockMax;
+  return ticks * kLruClockResolution;
+}
+
+void Object::initLfu() {
+  if (!isShared()) {
+    lru_ = (static_cast<uint32_t>(lfuMinutes()) << 8) | kLfuInitValue;
+  }
+}
+
+void Object::touchLfu(int log_factor, int decay_minutes) {
+  if (isShared()) { return; }
+  uint16_t now = lfuMinutes();
+  uint32_t counter = decayedCounter(now, decay_minutes);
+  if (counter < UINT8_MAX) {
+    double base = counter > kLfuInitValue ? counter - kLfuInitValue : 0;
+    double p = 1.0 / (base * log_factor + 1);
+    // 53 random bits make a uniform double in [0, 1).
+    if ((random64() >> 11) * 0x1.0p-53 < p) { counter++; }
+  }
+  lru_ = (static_cast<uint32_t>(now) << 8) | counter;
+}
+
+uint8_t Object::lfuCounter(int decay_minutes) const {
+  return decayedCounter(lfuMinutes(), decay_minutes);
+}
+
+uint8_t Object::decayedCounter(uint16_t now, int decay_minutes) const {
+  uint32_t counter = lru_ & 0xff;
+  if (decay_minutes <= 0) { return counter; }
+  // Minutes since the last access, modulo 2^16.
+  uint16_t elapsed = now - (lru_ >> 8);
+  uint32_t periods = elapsed / decay_minutes;
+  return periods >= counter ? 0 : counter - periods;
+}
+
+bool Object::getLongLong(long long *value) const {
+  if (encoding_ == kEncodingInt) {
+    *value = int_;
+    return true;
+  }
+  return string2ll(str_.data(), str_.size(), value);
+}
+
+String Object::toString() const {
+  if (encoding_ == kEncodingRaw) { return str_; }
+  char buf[kLongStrSize];
+  size_t len = ll2string(buf, sizeof(buf), int_);
+  return String(buf, len);
+}
+
+size_type Object::length() const {
+  if (encoding_ == kEncodingRaw) { return str_.size(); }
+  // -LLONG_MIN overflows, so take the magnitude in unsigned arithmetic.
+  auto magnitude = static_cast<unsigned long long>(int_);
+  if (int_ < 0) { magnitude = 0ull - magnitude; }
+  return digits10(magnitude) + (int_ < 0);
+}
+
+bool Object::incrBy(Object *&obj, long long incr) {
+  long long value;
+  if (!obj->getLongLong(&value)) { return false; }
+  if ((incr < 0 && value < 0 && incr < LLONG_MIN - value) ||
+      (incr > 0 && value > 0 && incr > LLONG_MAX - value)) {
+    return false;
+  }
+  value += incr;
+  if (obj->encoding_ == kEncodingInt && obj->refcount_ == 1) {
+    obj->int_ = value;
+    return true;
+  }
+  // An unshared input, e.g. one Db::set keeps for LRU/LFU, stays
+  // unshared along with its access history.
+  Object *updated = createInt(value, obj->isShared());
+  if (!obj->isShared()) { updated->setLru(obj->lru()); }
+  obj->decrRef();
+  obj = updated;
+  return true;
+}
+
+}  // namespace rd
@@ -2,11 +2,129 @@
 // Created by suun on 5/13/19.
 //
 
+// For assert
+#include <cassert>
 #include "sds.h"
+#include "simd.h"
+#include "zmalloc.h"
 namespace rd {
 
+void String::initInline() {
+  local_[0] = 0;
+  markInline();
+}
+unsigned char String::headerType(String::size_type capacity) {
+  if (capacity <= UINT8_MAX) { return kHeader8; }
+  if (capacity <= UINT16_MAX) { return kHeader16; }
+  if (capacity <= UINT32_MAX) { return kHeader32; }
+  return kHeader64;
+}
+String::size_type String::headerSize(unsigned char type) {
+  switch (type) {
+    case kHeader8: return sizeof(_Header<uint8_t>);
+    case kHeader16: return sizeof(_Header<uint16_t>);
+    case kHeader32: return sizeof(_Header<uint32_t>);
+    default: return sizeof(_Header<uint64_t>);
+  }
+}
+// Returns the character pointer of an empty block able to hold capacity
+// bytes plus the terminator.
+String::iterator String::allocate(String::size_type capacity) {
+  unsigned char type = headerType(capacity);
+  size_type hdr = headerSize(type);
+  iterator s = static_cast<iterator>(zmalloc(hdr + capacity + 1)) + hdr;
+  switch (type) {
+    case kHeader8:
+      *reinterpret_cast<_Header<uint8_t> *>(s - hdr) =
+          {0, static_cast<uint8_t>(capacity), type};
+      break;
+    case kHeader16:
+      *reinterpret_cast<_Header<uint16_t> *>(s - hdr) =
+          {0, static_cast<uint16_t>(capacity), type};
+      break;
+    case kHeader32:
+      *reinterpret_cast<_Header<uint32_t> *>(s - hdr) =
+          {0, static_cast<uint32_t>(capacity), type};
+      break;
+    default:
+      *reinterpret_cast<_Header<uint64_t> *>(s - hdr) =
+          {0, static_cast<uint64_t>(capacity), type};
+  }
+  s[0] = 0;
+  return s;
+}
+void String::deallocate(String::iterator s) {
+  auto type = static_cast<unsigned char>(s[-1] & kHeaderTypeMask);
+  size_type hdr = headerSize(type), capacity;
+  switch (type) {
+    case kHeader8:
+      capacity = reinterpret_cast<_Header<uint8_t> *>(s - hdr)->alloc;
+      break;
+    case kHeader16:
+      capacity = reinterpret_cast<_Header<uint16_t> *>(s - hdr)->alloc;
+      break;
+    case kHeader32:
+      capacity = reinterpret_cast<_Header<uint32_t> *>(s - hdr)->alloc;
+      break;
+    default:
+      capacity = reinterpret_cast<_Header<uint64_t> *>(s - hdr)->alloc;
+  }
+  zfree(s - hdr, hdr + capacity + 1);
+}
+
+void String::setSize(String::size_type n) {
+  if (isInline()) {
+    local_[kInlineCapacity] = static_cast<value_type>(kInlineCapacity - n);
+    local_[n] = 0;
+    return;
+  }
+  switch (static_cast<unsigned char>(sds_[-1]) & kHeaderTypeMask) {
+    case kHeader8: header<uint8_t>()->len = static_cast<uint8_t>(n);
+      break;
+    case kHeader16: header<uint16_t>()->len = static_cast<uint16_t>(n);
+      break;
+    case kHeader32: header<uint32_t>()->len = static_cast<uint32_t>(n);
+      break;
+    default: header<uint64_t>()->len = static_cast<uint64_t>(n);
+  }
+  sds_[n] = 0;
+}
+void String::adopt(String::iterator s) {
+  sds_ = s;
+  local_[kInlineCapacity] = static_cast<value_type>(kHeapTag);
+}
+void String::release() {
+  if (!isInline()) {
+    deallocate(sds_);
+  }
+  initInline();
+}
+void String::moveInline() {
+  if (isInline() || heapSize() > kInlineCapacity) { return; }
+  iterator old = sds_;
+  size_type len = heapSize();
+  std::uninitialized_copy(old, old + len, local_);
+  deallocate(old);
+  markInline();
+  setSize(len);
+}
+
+// Makes the capacity at least n bytes, without any preallocation.
+void String::reserve(String::size_type n) {
+  if (n <= capacity()) { return; }
+  size_type len = size();
+  iterator newBegin = allocate(n);
+  std::uninitialized_copy(ptr(), ptr() + len, newBegin);
+  release();
+  adopt(newBegin);
+  setSize(len);
+}
+
 String::size_type String::getNewCapacity(String::size_type n) const {
-  size_type _old = storage_end_ - begin_;
+  size_type _old = capacity();
+  if (_old >= kMaxPrealloc) {
+    return size() + n + kMaxPrealloc;
+  }
   return _old + (_old > n ? _old : n);
 }
 
@@ -14,24 +132,27 @@ String::String(const char *s) {
   allocateAndCopy(s, s + strlen(s));
 }
 String::String(const String &string) {
-  allocateAndCopy(string.begin_, string.end_);
+  allocateAndCopy(string.begin(), string.end());
+}
+String::String(String &&string) noexcept {
+  // Both modes are position independent, so moving is a bitwise copy.
+  std::memcpy(local_, string.local_, sizeof(local_));
+  string.initInline();
 }
 String::String(const char *s, String::size_type n) {
   constructAux(s, n, typename std::__is_integer<size_type>::__type());
 }
+String::String(StringView view) {
+  allocateAndCopy(view.begin(), view.end());
+}
 String::~String() {
-  if (begin_ != nullptr) {
-//    allocator_.deallocate(begin_, capacity() + 1);
-    delete[] begin_;
-    storage_end_ = end_ = begin_ = nullptr;
-  }
+  release();
 }
 void String::clear() {
-  end_ = begin_;
-  *end_ = 0;
+  setSize(0);
 }
 const char *String::data() const {
-  return begin_;
+  return ptr();
 }
 
 String &String::assign(const String &string) {
@@ -44,41 +165,93 @@ String &String::assign(const char *s, String::size_type n) {
   return assignAux(s, n, std::__is_integer<size_type>::__type());
 }
 void String::resize(String::size_type n) {
-  if (n < size()) {
-    std::uninitialized_fill(begin_ + n, end_, 0);
-  } else if (n < capacity()) {
-    end_ = std::uninitialized_fill_n(end_, n, 0);
-  } else {
-    size_type offset = n - size();
-    size_type newCapacity = getNewCapacity(offset);
-//    iterator newBegin = allocator_.allocate(newCapacity + 1);
-    auto newBegin = new value_type[newCapacity + 1];
-    end_ = std::uninitialized_copy(begin_, end_, newBegin);
-    end_ = std::uninitialized_fill_n(end_, offset, 0);
-//    allocator_.deallocate(begin_, capacity() + 1);
-    delete[] begin_;
-    begin_ = newBegin;
-    storage_end_ = begin_ + newCapacity;
-  }
-  *end_ = 0;
+  size_type len = size();
+  if (n <= len) {
+    setSize(n);
+    moveInline();
+    return;
+  }
+  if (n > capacity()) {
+    reserve(getNewCapacity(n - len));
+  }
+  std::uninitialized_fill(ptr() + len, ptr() + n, 0);
+  setSize(n);
+}
+// Guarantees n bytes of spare room after end() and returns end(), so
+// that callers such as read(2) can write straight into the string and
+// then commit the bytes with incrLen().
+String::iterator String::makeRoomFor(String::size_type n) {
+  size_type len = size();
+  if (n > capacity() - len) {
+    reserve(getNewCapacity(n));
+  }
+  return ptr() + len;
+}
+// Adjusts the length after bytes were written to (n > 0) or dropped
+// from (n < 0) the end of the buffer.
+void String::incrLen(String::difference_type n) {
+  size_type len = size() + n;
+  assert(len <= capacity());
+  setSize(len);
+}
+void String::shrinkToFit() {
+  if (isInline()) { return; }
+  size_type len = heapSize();
+  if (len <= kInlineCapacity) {
+    moveInline();
+  } else if (len < heapCapacity()) {
+    iterator buffer = allocate(len);
+    std::uninitialized_copy(sds_, sds_ + len, buffer);
+    release();
+    adopt(buffer);
+    setSize(len);
+  }
 }
 String String::substr(String::size_type pos, String::size_type offset) const {
-  return String(begin_ + pos, begin_ + pos + offset);
+  return String(begin() + pos, begin() + pos + offset);
 }
 void String::trim(const char *set) {
-  iterator newBegin, newEnd;
-  for (newBegin = begin_; newBegin != end_ && strchr(set, *newBegin);
-       newBegin++);
-  for (newEnd = end_ - 1; newEnd != begin_ - 1 && strchr(set, *newEnd);
-       newEnd--);
-  newEnd++;
-  std::uninitialized_copy(newBegin, newEnd, begin_);
-  end_ = begin_ + (newEnd - newBegin);
-  *end_ = 0;
+  const simd::Kernels &kernels = simd::kernels();
+  size_type m = strlen(set);
+  iterator first = begin(), last = end();
+  first += kernels.span(first, last - first, set, m);
+  last -= kernels.rspan(first, last - first, set, m);
+  std::copy(first, last, begin());
+  setSize(last - first);
+  moveInline();
+}
+String::size_type String::find(char c, String::size_type pos) const {
+  return StringView(*this).find(c, pos);
+}
+String::size_type String::find(StringView view,
+                               String::size_type pos) const {
+  return StringView(*this).find(view, pos);
+}
+// Orders like strcasecmp over the common prefix, then by length.
+int String::caseCompare(const String &string) const {
+  size_type l_size = size(), r_size = string.size();
+  int cmp = simd::kernels().caseCompare(
+      data(), string.data(), std::min(l_size, r_size));
+  if (cmp != 0) { return cmp; }
+  return l_size < r_size ? -1 : l_size > r_size;
 }
 String &String::operator=(const String &string) {
   return assign(string); // NOLINT(cppcoreguidelines-c-copy-assignment-signature,misc-unconventional-assign-operator)
 }
+void String::swap(String &string) noexcept {
+  value_type tmp[sizeof(local_)];
+  std::memcpy(tmp, local_, sizeof(local_));
+  std::memcpy(local_, string.local_, sizeof(local_));
+  std::memcpy(string.local_, tmp, sizeof(local_));
+}
+String &String::operator=(String &&string) noexcept {
+  if (this != &string) {
+    release();
+    std::memcpy(local_, string.local_, sizeof(local_));
+    string.initInline();
+  }
+  return *this;
+}
 String &String::operator=(const char *s) {
   return assign(s); // NOLINT(cppcoreguidelines-c-copy-assignment-signature,misc-unconventional-assign-operator)
 }
@@ -86,24 +259,35 @@ String &String::operator+=(const char *s) {
   return append(s, s + strlen(s));
 }
 String &String::operator+=(const String &string) {
-  return append(string.begin_, string.end_);
+  return append(string.begin(), string.end());
+}
+String &String::operator+=(String &&string) {
+  if (empty() && string.capacity() >= capacity()) {
+    return *this = std::move(string);
+  }
+  return append(string.begin(), string.end());
 }
 String operator+(const String &lhs, const String &rhs) {
-  String ret(lhs);
-  return ret += rhs;
+  return concat(lhs, rhs);
 }
 String operator+(const String &lhs, const char *rhs) {
-  String ret(lhs);
-  return ret += rhs;
+  return concat(lhs, rhs);
 }
 String operator+(const char *lhs, const String &rhs) {
-  String ret(lhs);
-  return ret += rhs;
+  return concat(lhs, rhs);
+}
+String operator+(String &&lhs, const String &rhs) {
+  lhs += rhs;
+  return std::move(lhs);
+}
+String operator+(String &&lhs, const char *rhs) {
+  lhs += rhs;
+  return std::move(lhs);
 }
 bool operator==(const rd::String &lhs, const rd::String &rhs) {
-  rd::String::iterator lit = lhs.begin(), rit = rhs.begin();
-  for (; lit != lhs.end() && rit != rhs.end() && *lit == *rit; lit++, rit++);
-  return (lit == lhs.end() && rit == rhs.end());
+  size_type len = lhs.size();
+  return len == rhs.size() &&
+      simd::kernels().equal(lhs.data(), rhs.data(), len);
 }
 bool operator!=(const rd::String &lhs, const rd::String &rhs) {
   return !(lhs == rhs);
@@ -115,6 +299,81 @@ bool operator<(const rd::String &lhs, const rd::String &rhs) {
   return (cmp == 0 && l_size < r_size) || cmp < 0;
 }
 std::ostream &operator<<(std::ostream &os, const rd::String &string) {
-  return os << string.begin_;
+  return os << string.data();
+}
+
+StringView StringView::substr(StringView::size_type pos,
+                              StringView::size_type n) const {
+  if (pos > size_) { pos = size_; }
+  return StringView(data_ + pos, std::min(n, size_ - pos));
+}
+StringView::size_type StringView::find(char c,
+                                       StringView::size_type pos) const {
+  if (pos >= size_) { return npos; }
+  const char *found = simd::kernels().findChar(data_ + pos, size_ - pos, c);
+  return found == nullptr ? npos : found - data_;
+}
+StringView::size_type StringView::find(StringView view,
+                                       StringView::size_type pos) const {
+  size_type n = view.size();
+  if (pos > size_ || n > size_ - pos) { return npos; }
+  if (n == 0) { return pos; }
+  if (n == 1) { return find(view[0], pos); }
+  const char *found =
+      simd::kernels().find(data_ + pos, size_ - pos, view.data(), n);
+  return found == nullptr ? npos : found - data_;
+}
+int StringView::compare(StringView view) const {
+  int cmp = memcmp(data_, view.data_, std::min(size_, view.size_));
+  if (cmp != 0) { return cmp; }
+  return size_ < view.size_ ? -1 : size_ > view.size_;
+}
+bool operator==(StringView lhs, StringView rhs) {
+  return lhs.size() == rhs.size() &&
+      simd::kernels().equal(lhs.data(), rhs.data(), lhs.size());
+}
+
+SharedString::SharedString(String str)
+    : block_(new _Block{{}, {1}, std::move(str)}) {}
+SharedString::SharedString(const SharedString &shared)
+    : block_(shared.block_) {
+  if (block_ != nullptr) {
+    block_->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+void SharedString::unref() {
+  if (block_ != nullptr &&
+      block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete block_;
+  }
+  block_ = nullptr;
+}
+SharedString &SharedString::operator=(const SharedString &shared) {
+  if (block_ != shared.block_) {
+    SharedString tmp(shared);
+    std::swap(block_, tmp.block_);
+  }
+  return *this;
+}
+SharedString &SharedString::operator=(SharedString &&shared) noexcept {
+  if (this != &shared) {
+    unref();
+    std::swap(block_, shared.block_);
+  }
+  return *this;
+}
+const String &SharedString::str() const {
+  static const String empty;
+  return block_ == nullptr ? empty : block_->str;
+}
+String &SharedString::mutate() {
+  if (block_ == nullptr) {
+    block_ = new _Block{{}, {1}, String()};
+  } else if (block_->refs.load(std::memory_order_acquire) > 1) {
+    auto copy = new _Block{{}, {1}, block_->str};
+    unref();
+    block_ = copy;
+  }
+  return block_->str;
 }
 }
@@ -0,0 +1,894 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For int16_t, int32_t, int64_t, uint64_t
+#include <cstdint>
+// For memcmp, memchr, memcpy
+#include <cstring>
+#include "simd.h"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace rd {
+namespace simd {
+namespace {
+
+inline unsigned char lowerChar(unsigned char c) {
+  return (c >= 'A' && c <= 'Z') ? c | 0x20u : c;
+}
+
+struct _CharSet {
+  bool member[256] = {};
+  _CharSet(const char *set, size_t m) {
+    member[0] = true;
+    for (size_t i = 0; i < m; i++) {
+      member[static_cast<unsigned char>(set[i])] = true;
+    }
+  }
+  bool has(char c) const { return member[static_cast<unsigned char>(c)]; }
+};
+
+// Scalar kernels, also used for the tails of the vector ones.
+
+bool equalScalar(const char *lhs, const char *rhs, size_t n) {
+  return memcmp(lhs, rhs, n) == 0;
+}
+
+const char *findCharScalar(const char *s, size_t n, char c) {
+  return static_cast<const char *>(memchr(s, c, n));
+}
+
+const char *findScalar(const char *s, size_t n,
+                       const char *needle, size_t m) {
+  if (m > n) { return nullptr; }
+  const char *last = s + n - m;
+  for (const char *p = s; p <= last; p++) {
+    p = findCharScalar(p, last - p + 1, needle[0]);
+    if (p == nullptr) { return nullptr; }
+    if (memcmp(p + 1, needle + 1, m - 1) == 0) { return p; }
+  }
+  return nullptr;
+}
+
+size_t spanScalar(const char *s, size_t n, const char *set, size_t m) {
+  _CharSet chars(set, m);
+  size_t i = 0;
+  for (; i < n && chars.has(s[i]); i++);
+  return i;
+}
+
+size_t rspanScalar(const char *s, size_t n, const char *set, size_t m) {
+  _CharSet chars(set, m);
+  size_t i = n;
+  for (; i > 0 && chars.has(s[i - 1]); i--);
+  return n - i;
+}
+
+int caseCompareScalar(const char *lhs, const char *rhs, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    int diff = lowerChar(lhs[i]) - lowerChar(rhs[i]);
+    if (diff != 0) { return diff; }
+  }
+  return 0;
+}
+
+inline uint64_t loadWord(const char *p) {
+  uint64_t word;
+  memcpy(&word, p, sizeof(word));
+  return word;
+}
+
+inline void storeWord(char *p, uint64_t word) {
+  memcpy(p, &word, sizeof(word));
+}
+
+size_t popcountScalar(const char *s, size_t n) {
+  size_t count = 0, i = 0;
+  for (; i + 8 <= n; i += 8) {
+    count += __builtin_popcountll(loadWord(s + i));
+  }
+  for (; i < n; i++) {
+    count += __builtin_popcount(static_cast<unsigned char>(s[i]));
+  }
+  return count;
+}
+
+// Word-at-a-time combine; the byte tail goes through the same op.
+template<class Op>
+inline void combineScalar(char *dst, const char *src, size_t n, Op op) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    storeWord(dst + i, op(loadWord(dst + i), loadWord(src + i)));
+  }
+  for (; i < n; i++) {
+    dst[i] = static_cast<char>(op(static_cast<unsigned char>(dst[i]),
+                                  static_cast<unsigned char>(src[i])));
+  }
+}
+
+void bitAndScalar(char *dst, const char *src, size_t n) {
+  combineScalar(dst, src, n, [](uint64_t a, uint64_t b) { return a & b; });
+}
+
+void bitOrScalar(char *dst, const char *src, size_t n) {
+  combineScalar(dst, src, n, [](uint64_t a, uint64_t b) { return a | b; });
+}
+
+void bitXorScalar(char *dst, const char *src, size_t n) {
+  combineScalar(dst, src, n, [](uint64_t a, uint64_t b) { return a ^ b; });
+}
+
+void bitNotScalar(char *dst, size_t n) {
+  for (size_t i = 0; i < n; i++) { dst[i] = static_cast<char>(~dst[i]); }
+}
+
+template<class T>
+size_t rankScalar(const T *a, size_t n, T key) {
+  size_t rank = 0;
+  for (size_t i = 0; i < n; i++) { rank += a[i] < key; }
+  return rank;
+}
+
+// Branch-free: which side advances is a coin toss on random sets.
+template<class T>
+size_t intersectScalar(const T *a, size_t na, const T *b, size_t nb, T *out) {
+  size_t i = 0, j = 0, k = 0;
+  while (i < na && j < nb) {
+    T x = a[i], y = b[j];
+    out[k] = x;
+    k += x == y;
+    i += x <= y;
+    j += y <= x;
+  }
+  return k;
+}
+
+const Kernels kScalarKernels = {
+    equalScalar, findCharScalar, findScalar,
+    spanScalar, rspanScalar, caseCompareScalar,
+    popcountScalar, bitAndScalar, bitOrScalar, bitXorScalar, bitNotScalar,
+    rankScalar<int16_t>, rankScalar<int32_t>, rankScalar<int64_t>,
+    intersectScalar<int16_t>, intersectScalar<int32_t>,
+    intersectScalar<int64_t>,
+};
+
+#if defined(__x86_64__)
+
+// A set of at most kMaxVectorSet bytes (plus the implicit '\0') is tested
+// with one compare per member; larger sets go through the scalar table.
+const size_t kMaxVectorSet = 15;
+
+// equal and findChar only run in registers for short inputs, i.e. keys.
+// Past kLibcThreshold bytes they hand over to memcmp/memchr, which glibc
+// already vectorizes and tunes per CPU with unrolled loops.
+const size_t kLibcThreshold = 256;
+
+// SSE2 is part of x86-64, so these need no target attribute.
+
+inline __m128i load128(const void *p) {
+  return _mm_loadu_si128(static_cast<const __m128i *>(p));
+}
+
+bool equalSse2(const char *lhs, const char *rhs, size_t n) {
+  if (n < 16 || n > kLibcThreshold) { return equalScalar(lhs, rhs, n); }
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i eq = _mm_cmpeq_epi8(load128(lhs + i), load128(rhs + i));
+    if (_mm_movemask_epi8(eq) != 0xFFFF) { return false; }
+  }
+  if (i == n) { return true; }
+  // Overlapping final block instead of a byte loop.
+  __m128i eq =
+      _mm_cmpeq_epi8(load128(lhs + n - 16), load128(rhs + n - 16));
+  return _mm_movemask_epi8(eq) == 0xFFFF;
+}
+
+const char *findCharSse2(const char *s, size_t n, char c) {
+  if (n > kLibcThreshold) { return findCharScalar(s, n, c); }
+  __m128i needle = _mm_set1_epi8(c);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(load128(s + i), needle));
+    if (mask != 0) { return s + i + __builtin_ctz(mask); }
+  }
+  return findCharScalar(s + i, n - i, c);
+}
+
+// Compares the first and the last needle byte against two shifted blocks
+// at once and only verifies the candidates where both match.
+const char *findSse2(const char *s, size_t n, const char *needle, size_t m) {
+  if (m > n) { return nullptr; }
+  __m128i first = _mm_set1_epi8(needle[0]);
+  __m128i last = _mm_set1_epi8(needle[m - 1]);
+  size_t i = 0;
+  for (; i + m - 1 + 16 <= n; i += 16) {
+    __m128i eq_first = _mm_cmpeq_epi8(first, load128(s + i));
+    __m128i eq_last = _mm_cmpeq_epi8(last, load128(s + i + m - 1));
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+    while (mask != 0) {
+      unsigned bit = __builtin_ctz(mask);
+      if (memcmp(s + i + bit + 1, needle + 1, m - 2) == 0) {
+        return s + i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return findScalar(s + i, n - i, needle, m);
+}
+
+// Bit i of the result is set when byte i of x is not in the set.
+inline unsigned missMask128(__m128i x, const __m128i *set, size_t k) {
+  __m128i hit = _mm_cmpeq_epi8(x, _mm_setzero_si128());
+  for (size_t j = 0; j < k; j++) {
+    hit = _mm_or_si128(hit, _mm_cmpeq_epi8(x, set[j]));
+  }
+  return ~static_cast<unsigned>(_mm_movemask_epi8(hit)) & 0xFFFFu;
+}
+
+size_t spanSse2(const char *s, size_t n, const char *set, size_t m) {
+  if (m > kMaxVectorSet) { return spanScalar(s, n, set, m); }
+  __m128i members[kMaxVectorSet];
+  for (size_t j = 0; j < m; j++) { members[j] = _mm_set1_epi8(set[j]); }
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    unsigned miss = missMask128(load128(s + i), members, m);
+    if (miss != 0) { return i + __builtin_ctz(miss); }
+  }
+  return i + spanScalar(s + i, n - i, set, m);
+}
+
+size_t rspanSse2(const char *s, size_t n, const char *set, size_t m) {
+  if (m > kMaxVectorSet) { return rspanScalar(s, n, set, m); }
+  __m128i members[kMaxVectorSet];
+  for (size_t j = 0; j < m; j++) { members[j] = _mm_set1_epi8(set[j]); }
+  size_t end = n;
+  for (; end >= 16; end -= 16) {
+    unsigned miss = missMask128(load128(s + end - 16), members, m);
+    if (miss != 0) {
+      size_t last = end - 16 + (31 - __builtin_clz(miss));
+      return n - last - 1;
+    }
+  }
+  return (n - end) + rspanScalar(s, end, set, m);
+}
+
+inline __m128i lower128(__m128i x) {
+  // Shift 'A'..'Z' to the bottom of the signed range to test it with
+  // a single signed compare.
+  __m128i shifted =
+      _mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+  __m128i upper =
+      _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+  return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+int caseCompareSse2(const char *lhs, const char *rhs, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i eq = _mm_cmpeq_epi8(lower128(load128(lhs + i)),
+                                lower128(load128(rhs + i)));
+    unsigned mask = _mm_movemask_epi8(eq);
+    if (mask != 0xFFFF) {
+      size_t k = i + __builtin_ctz(~mask);
+      return lowerChar(lhs[k]) - lowerChar(rhs[k]);
+    }
+  }
+  return caseCompareScalar(lhs + i, rhs + i, n - i);
+}
+
+// popcnt is not part of baseline x86-64, so the SSE2 level checks for it
+// at run time and otherwise falls back to the scalar bit trick.
+__attribute__((target("popcnt")))
+size_t popcountHw(const char *s, size_t n) {
+  // Four independent accumulators keep the popcnt port busy.
+  uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    c0 += _mm_popcnt_u64(loadWord(s + i));
+    c1 += _mm_popcnt_u64(loadWord(s + i + 8));
+    c2 += _mm_popcnt_u64(loadWord(s + i + 16));
+    c3 += _mm_popcnt_u64(loadWord(s + i + 24));
+  }
+  for (; i + 8 <= n; i += 8) { c0 += _mm_popcnt_u64(loadWord(s + i)); }
+  for (; i < n; i++) {
+    c0 += _mm_popcnt_u32(static_cast<unsigned char>(s[i]));
+  }
+  return c0 + c1 + c2 + c3;
+}
+
+size_t popcountSse2(const char *s, size_t n) {
+  return hasPopcnt() ? popcountHw(s, n) : popcountScalar(s, n);
+}
+
+inline void store128(char *p, __m128i x) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x);
+}
+
+#define RD_COMBINE_SSE2(name, intrinsic, scalar)              \
+  void name(char *dst, const char *src, size_t n) {           \
+    size_t i = 0;                                             \
+    for (; i + 16 <= n; i += 16) {                            \
+      store128(dst + i, intrinsic(load128(dst + i), load128(src + i))); \
+    }                                                         \
+    scalar(dst + i, src + i, n - i);                          \
+  }
+
+RD_COMBINE_SSE2(bitAndSse2, _mm_and_si128, bitAndScalar)
+RD_COMBINE_SSE2(bitOrSse2, _mm_or_si128, bitOrScalar)
+RD_COMBINE_SSE2(bitXorSse2, _mm_xor_si128, bitXorScalar)
+
+#undef RD_COMBINE_SSE2
+
+void bitNotSse2(char *dst, size_t n) {
+  const __m128i ones = _mm_set1_epi8(-1);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    store128(dst + i, _mm_xor_si128(load128(dst + i), ones));
+  }
+  bitNotScalar(dst + i, n - i);
+}
+
+// Rank kernels count per lane: cmpgt yields -1 where an element is less
+// than key, and subtracting it adds one. Lanes are summed every
+// kMaxRankRounds vectors, before a 16-bit lane can overflow.
+const size_t kMaxRankRounds = 32767;
+
+// The sum of the (non-negative) lanes of v, without leaving registers.
+inline size_t sumLanes32(__m128i v) {
+  v = _mm_add_epi32(v, _mm_srli_si128(v, 8));
+  v = _mm_add_epi32(v, _mm_srli_si128(v, 4));
+  return static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+}
+
+// Adjacent 16-bit lanes are first added into 32-bit ones, which cannot
+// overflow.
+inline size_t sumLanes16(__m128i v) {
+  return sumLanes32(_mm_madd_epi16(v, _mm_set1_epi16(1)));
+}
+
+#define RD_RANK_SSE2(name, T, L, set1, cmpgt, sub, sum)              \
+  size_t name(const T *a, size_t n, T key) {                         \
+    const __m128i k = set1(key);                                     \
+    size_t rank = 0, i = 0;                                          \
+    while (i + L <= n) {                                             \
+      size_t rounds = (n - i) / L;                                   \
+      if (rounds > kMaxRankRounds) { rounds = kMaxRankRounds; }      \
+      size_t end = i + rounds * L;                                   \
+      __m128i count = _mm_setzero_si128();                           \
+      for (; i + L <= end; i += L) {                                 \
+        count = sub(count, cmpgt(k, load128(a + i)));                \
+      }                                                              \
+      rank += sum(count);                                            \
+    }                                                                \
+    return rank + rankScalar(a + i, n - i, key);                     \
+  }
+
+RD_RANK_SSE2(rank16Sse2, int16_t, 8, _mm_set1_epi16, _mm_cmpgt_epi16,
+             _mm_sub_epi16, sumLanes16)
+RD_RANK_SSE2(rank32Sse2, int32_t, 4, _mm_set1_epi32, _mm_cmpgt_epi32,
+             _mm_sub_epi32, sumLanes32)
+
+#undef RD_RANK_SSE2
+
+// A 128-bit rotation by S bytes.
+template<int S>
+inline __m128i rotate128(__m128i v) {
+  return _mm_or_si128(_mm_srli_si128(v, S), _mm_slli_si128(v, 16 - S));
+}
+
+// Compares 8 elements of a against 8 of b per step; the lanes of a equal
+// to a lane of b are found by comparing with each rotation of b.
+size_t intersect16Sse2(const int16_t *a, size_t na,
+                       const int16_t *b, size_t nb, int16_t *out) {
+  size_t i = 0, j = 0, k = 0;
+  while (i + 8 <= na && j + 8 <= nb) {
+    __m128i va = load128(a + i);
+    __m128i vb = load128(b + j);
+    __m128i eq = _mm_cmpeq_epi16(va, vb);
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, rotate128<2>(vb)));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, rotate128<4>(vb)));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, rotate128<6>(vb)));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, rotate128<8>(vb)));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, rotate128<10>(vb)));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, rotate128<12>(vb)));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi16(va, rotate128<14>(vb)));
+    // Two mask bits per lane; keep the low one.
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq)) & 0x5555u;
+    for (; mask != 0; mask &= mask - 1) {
+      out[k++] = a[i + __builtin_ctz(mask) / 2];
+    }
+    int16_t amax = a[i + 7], bmax = b[j + 7];
+    i += 8 & -static_cast<size_t>(amax <= bmax);
+    j += 8 & -static_cast<size_t>(bmax <= amax);
+  }
+  return k + intersectScalar(a + i, na - i, b + j, nb - j, out + k);
+}
+
+size_t intersect32Sse2(const int32_t *a, size_t na,
+                       const int32_t *b, size_t nb, int32_t *out) {
+  size_t i = 0, j = 0, k = 0;
+  while (i + 4 <= na && j + 4 <= nb) {
+    __m128i va = load128(a + i);
+    __m128i vb = load128(b + j);
+    __m128i eq = _mm_cmpeq_epi32(va, vb);
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(
+        va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(
+        va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(
+        va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+    unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+    for (; mask != 0; mask &= mask - 1) {
+      out[k++] = a[i + __builtin_ctz(mask)];
+    }
+    int32_t amax = a[i + 3], bmax = b[j + 3];
+    i += 4 & -static_cast<size_t>(amax <= bmax);
+    j += 4 & -static_cast<size_t>(bmax <= amax);
+  }
+  return k + intersectScalar(a + i, na - i, b + j, nb - j, out + k);
+}
+
+// SSE2 has no 64-bit compares (SSE4.1/4.2 added them), so 64-bit elements
+// stay scalar at this level.
+const Kernels kSse2Kernels = {
+    equalSse2, findCharSse2, findSse2,
+    spanSse2, rspanSse2, caseCompareSse2,
+    popcountSse2, bitAndSse2, bitOrSse2, bitXorSse2, bitNotSse2,
+    rank16Sse2, rank32Sse2, rankScalar<int64_t>,
+    intersect16Sse2, intersect32Sse2, intersectScalar<int64_t>,
+};
+
+#define RD_AVX2 __attribute__((target("avx2")))
+
+RD_AVX2 inline __m256i load256(const void *p) {
+  return _mm256_loadu_si256(static_cast<const __m256i *>(p));
+}
+
+RD_AVX2 bool equalAvx2(const char *lhs, const char *rhs, size_t n) {
+  if (n < 32 || n > kLibcThreshold) { return equalSse2(lhs, rhs, n); }
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i eq = _mm256_cmpeq_epi8(load256(lhs + i), load256(rhs + i));
+    if (static_cast<unsigned>(_mm256_movemask_epi8(eq)) != 0xFFFFFFFFu) {
+      return false;
+    }
+  }
+  if (i == n) { return true; }
+  __m256i eq =
+      _mm256_cmpeq_epi8(load256(lhs + n - 32), load256(rhs + n - 32));
+  return static_cast<unsigned>(_mm256_movemask_epi8(eq)) == 0xFFFFFFFFu;
+}
+
+RD_AVX2 const char *findCharAvx2(const char *s, size_t n, char c) {
+  if (n > kLibcThreshold) { return findCharScalar(s, n, c); }
+  __m256i needle = _mm256_set1_epi8(c);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    unsigned mask = _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(load256(s + i), needle));
+    if (mask != 0) { return s + i + __builtin_ctz(mask); }
+  }
+  return findCharSse2(s + i, n - i, c);
+}
+
+RD_AVX2 const char *findAvx2(const char *s, size_t n,
+                             const char *needle, size_t m) {
+  if (m > n) { return nullptr; }
+  __m256i first = _mm256_set1_epi8(needle[0]);
+  __m256i last = _mm256_set1_epi8(needle[m - 1]);
+  size_t i = 0;
+  for (; i + m - 1 + 32 <= n; i += 32) {
+    __m256i eq_first = _mm256_cmpeq_epi8(first, load256(s + i));
+    __m256i eq_last = _mm256_cmpeq_epi8(last, load256(s + i + m - 1));
+    unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(eq_first, eq_last));
+    while (mask != 0) {
+      unsigned bit = __builtin_ctz(mask);
+      if (memcmp(s + i + bit + 1, needle + 1, m - 2) == 0) {
+        return s + i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return findSse2(s + i, n - i, needle, m);
+}
+
+RD_AVX2 inline unsigned missMask256(__m256i x, const __m256i *set, size_t k) {
+  __m256i hit = _mm256_cmpeq_epi8(x, _mm256_setzero_si256());
+  for (size_t j = 0; j < k; j++) {
+    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(x, set[j]));
+  }
+  return ~static_cast<unsigned>(_mm256_movemask_epi8(hit));
+}
+
+RD_AVX2 size_t spanAvx2(const char *s, size_t n, const char *set, size_t m) {
+  if (m > kMaxVectorSet) { return spanScalar(s, n, set, m); }
+  __m256i members[kMaxVectorSet];
+  for (size_t j = 0; j < m; j++) { members[j] = _mm256_set1_epi8(set[j]); }
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    unsigned miss = missMask256(load256(s + i), members, m);
+    if (miss != 0) { return i + __builtin_ctz(miss); }
+  }
+  return i + spanSse2(s + i, n - i, set, m);
+}
+
+RD_AVX2 size_t rspanAvx2(const char *s, size_t n, const char *set, size_t m) {
+  if (m > kMaxVectorSet) { return rspanScalar(s, n, set, m); }
+  __m256i members[kMaxVectorSet];
+  for (size_t j = 0; j < m; j++) { members[j] = _mm256_set1_epi8(set[j]); }
+  size_t end = n;
+  for (; end >= 32; end -= 32) {
+    unsigned miss = missMask256(load256(s + end - 32), members, m);
+    if (miss != 0) {
+      size_t last = end - 32 + (31 - __builtin_clz(miss));
+      return n - last - 1;
+    }
+  }
+  return (n - end) + rspanSse2(s, end, set, m);
+}
+
+RD_AVX2 inline __m256i lower256(__m256i x) {
+  __m256i shifted =
+      _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+  __m256i upper = _mm256_cmpgt_epi8(
+      _mm256_set1_epi8(static_cast<char>(0x80 + 26)), shifted);
+  return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+RD_AVX2 int caseCompareAvx2(const char *lhs, const char *rhs, size_t n) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i eq = _mm256_cmpeq_epi8(lower256(load256(lhs + i)),
+                                   lower256(load256(rhs + i)));
+    unsigned mask = _mm256_movemask_epi8(eq);
+    if (mask != 0xFFFFFFFFu) {
+      size_t k = i + __builtin_ctz(~mask);
+      return lowerChar(lhs[k]) - lowerChar(rhs[k]);
+    }
+  }
+  return caseCompareSse2(lhs + i, rhs + i, n - i);
+}
+
+RD_AVX2 inline void store256(char *p, __m256i x) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), x);
+}
+
+// Mula's nibble lookup: vpshufb maps each nibble to its bit count, the
+// byte counts pile up for a bounded number of rounds and vpsadbw folds
+// them into four 64-bit lanes. Beats scalar popcnt once past a few
+// hundred bytes; shorter inputs take the popcnt loop.
+const size_t kPopcountVectorMin = 256;
+
+RD_AVX2 size_t popcountAvx2(const char *s, size_t n) {
+  if (n < kPopcountVectorMin) { return popcountSse2(s, n); }
+  const __m256i table = _mm256_setr_epi8(
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0F);
+  __m256i total = _mm256_setzero_si256();
+  size_t i = 0;
+  while (i + 32 <= n) {
+    // Each round adds at most 8 per byte, so 31 rounds cannot overflow.
+    size_t rounds = (n - i) / 32;
+    if (rounds > 31) { rounds = 31; }
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t r = 0; r < rounds; r++, i += 32) {
+      __m256i v = load256(s + i);
+      __m256i lo = _mm256_and_si256(v, low);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+      acc = _mm256_add_epi8(acc, _mm256_shuffle_epi8(table, lo));
+      acc = _mm256_add_epi8(acc, _mm256_shuffle_epi8(table, hi));
+    }
+    total = _mm256_add_epi64(total,
+                             _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+  }
+  size_t count = static_cast<size_t>(_mm256_extract_epi64(total, 0)) +
+                 static_cast<size_t>(_mm256_extract_epi64(total, 1)) +
+                 static_cast<size_t>(_mm256_extract_epi64(total, 2)) +
+                 static_cast<size_t>(_mm256_extract_epi64(total, 3));
+  return count + popcountSse2(s + i, n - i);
+}
+
+#define RD_COMBINE_AVX2(name, intrinsic, tail)                \
+  RD_AVX2 void name(char *dst, const char *src, size_t n) {   \
+    size_t i = 0;                                             \
+    for (; i + 32 <= n; i += 32) {                            \
+      store256(dst + i, intrinsic(load256(dst + i), load256(src + i))); \
+    }                                                         \
+    tail(dst + i, src + i, n - i);                            \
+  }
+
+RD_COMBINE_AVX2(bitAndAvx2, _mm256_and_si256, bitAndSse2)
+RD_COMBINE_AVX2(bitOrAvx2, _mm256_or_si256, bitOrSse2)
+RD_COMBINE_AVX2(bitXorAvx2, _mm256_xor_si256, bitXorSse2)
+
+#undef RD_COMBINE_AVX2
+
+RD_AVX2 void bitNotAvx2(char *dst, size_t n) {
+  const __m256i ones = _mm256_set1_epi8(-1);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    store256(dst + i, _mm256_xor_si256(load256(dst + i), ones));
+  }
+  bitNotSse2(dst + i, n - i);
+}
+
+RD_AVX2 inline size_t sumLanes32(__m256i v) {
+  return sumLanes32(_mm_add_epi32(_mm256_castsi256_si128(v),
+                                  _mm256_extracti128_si256(v, 1)));
+}
+
+RD_AVX2 inline size_t sumLanes16(__m256i v) {
+  return sumLanes32(_mm256_madd_epi16(v, _mm256_set1_epi16(1)));
+}
+
+RD_AVX2 inline size_t sumLanes64(__m256i v) {
+  __m128i x = _mm_add_epi64(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+  x = _mm_add_epi64(x, _mm_srli_si128(x, 8));
+  return static_cast<size_t>(_mm_cvtsi128_si64(x));
+}
+
+// The tails run SSE code, which stalls on dirty upper halves of the ymm
+// registers; GCC leaves out its own vzeroupper around some of these
+// loops, so they clear them themselves.
+#define RD_RANK_AVX2(name, T, L, set1, cmpgt, sub, sum, tail)        \
+  RD_AVX2 size_t name(const T *a, size_t n, T key) {                 \
+    const __m256i k = set1(key);                                     \
+    size_t rank = 0, i = 0;                                          \
+    while (i + L <= n) {                                             \
+      size_t rounds = (n - i) / L;                                   \
+      if (rounds > kMaxRankRounds) { rounds = kMaxRankRounds; }      \
+      size_t end = i + rounds * L;                                   \
+      __m256i count = _mm256_setzero_si256();                        \
+      for (; i + L <= end; i += L) {                                 \
+        count = sub(count, cmpgt(k, load256(a + i)));                \
+      }                                                              \
+      rank += sum(count);                                            \
+    }                                                                \
+    _mm256_zeroupper();                                              \
+    return rank + tail(a + i, n - i, key);                           \
+  }
+
+RD_RANK_AVX2(rank16Avx2, int16_t, 16, _mm256_set1_epi16, _mm256_cmpgt_epi16,
+             _mm256_sub_epi16, sumLanes16, rank16Sse2)
+RD_RANK_AVX2(rank32Avx2, int32_t, 8, _mm256_set1_epi32, _mm256_cmpgt_epi32,
+             _mm256_sub_epi32, sumLanes32, rank32Sse2)
+RD_RANK_AVX2(rank64Avx2, int64_t, 4, _mm256_set1_epi64x, _mm256_cmpgt_epi64,
+             _mm256_sub_epi64, sumLanes64, rankScalar<int64_t>)
+
+#undef RD_RANK_AVX2
+
+// Shuffles that pack the lanes a mask picks to the front of a vector, so
+// that the matches of a block leave in one store: lanes32 for the 32-bit
+// lanes of permutevar8x32 (64-bit lanes go as pairs of them), bytes16 for
+// the 16-bit lanes of pshufb. count is the number of lanes picked.
+struct _PackTables {
+  alignas(32) int32_t lanes32[256][8];
+  alignas(32) int32_t lanes64[16][8];
+  alignas(16) uint8_t bytes16[256][16];
+  uint8_t count[256];
+
+  constexpr _PackTables() : lanes32(), lanes64(), bytes16(), count() {
+    for (int mask = 0; mask < 256; mask++) {
+      int n = 0;
+      for (int lane = 0; lane < 8; lane++) {
+        if ((mask >> lane & 1) == 0) { continue; }
+        lanes32[mask][n] = lane;
+        bytes16[mask][2 * n] = static_cast<uint8_t>(2 * lane);
+        bytes16[mask][2 * n + 1] = static_cast<uint8_t>(2 * lane + 1);
+        if (mask < 16) {
+          lanes64[mask][2 * n] = 2 * lane;
+          lanes64[mask][2 * n + 1] = 2 * lane + 1;
+        }
+        n++;
+      }
+      count[mask] = static_cast<uint8_t>(n);
+    }
+  }
+};
+
+const _PackTables kPack;
+
+RD_AVX2 inline __m256i loadTable(const int32_t *row) {
+  return _mm256_load_si256(reinterpret_cast<const __m256i *>(row));
+}
+
+// The eight rotations of a vector of 32-bit lanes, for permutevar8x32.
+RD_AVX2 inline __m256i rotation32(int r) {
+  return _mm256_setr_epi32(r & 7, (r + 1) & 7, (r + 2) & 7, (r + 3) & 7,
+                           (r + 4) & 7, (r + 5) & 7, (r + 6) & 7, (r + 7) & 7);
+}
+
+// The AVX2 intersections store a whole packed vector per block, and so
+// need room for a full vector past the matches so far: they do while
+// k + lanes <= min(na, nb), the room every caller gives, and pick the
+// matches out one by one for the last few.
+
+// 16 elements of a against 16 of b. AVX2 cannot rotate 16-bit lanes
+// across the 128-bit halves, so b is rotated in 32-bit units, once as is
+// and once with the halves of every unit swapped: between them, each lane
+// of a meets every lane of b.
+RD_AVX2 size_t intersect16Avx2(const int16_t *a, size_t na,
+                               const int16_t *b, size_t nb, int16_t *out) {
+  __m256i rot[8];
+  for (int r = 0; r < 8; r++) { rot[r] = rotation32(r); }
+  const size_t room = na < nb ? na : nb;
+  size_t i = 0, j = 0, k = 0;
+  while (i + 16 <= na && j + 16 <= nb) {
+    __m256i va = load256(a + i), vb = load256(b + j);
+    __m256i swapped = _mm256_or_si256(_mm256_slli_epi32(vb, 16),
+                                      _mm256_srli_epi32(vb, 16));
+    __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi16(va, vb),
+                                 _mm256_cmpeq_epi16(va, swapped));
+    for (int r = 1; r < 8; r++) {
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi16(
+          va, _mm256_permutevar8x32_epi32(vb, rot[r])));
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi16(
+          va, _mm256_permutevar8x32_epi32(swapped, rot[r])));
+    }
+    // packs narrows each half in place: lanes 0-7 land in mask bits 0-7,
+    // lanes 8-15 in bits 16-23.
+    auto mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_packs_epi16(eq, _mm256_setzero_si256())));
+    unsigned lo = mask & 0xFFu, hi = mask >> 16u & 0xFFu;
+    if (k + 16 <= room) {
+      __m128i packed = _mm_shuffle_epi8(
+          _mm256_castsi256_si128(va),
+          load128(kPack.bytes16[lo]));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), packed);
+      k += kPack.count[lo];
+      packed = _mm_shuffle_epi8(_mm256_extracti128_si256(va, 1),
+                                load128(kPack.bytes16[hi]));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), packed);
+      k += kPack.count[hi];
+    } else {
+      for (mask = lo | hi << 8u; mask != 0; mask &= mask - 1) {
+        out[k++] = a[i + __builtin_ctz(mask)];
+      }
+    }
+    int16_t amax = a[i + 15], bmax = b[j + 15];
+    i += 16 & -static_cast<size_t>(amax <= bmax);
+    j += 16 & -static_cast<size_t>(bmax <= amax);
+  }
+  _mm256_zeroupper();
+  return k + intersect16Sse2(a + i, na - i, b + j, nb - j, out + k);
+}
+
+RD_AVX2 size_t intersect32Avx2(const int32_t *a, size_t na,
+                               const int32_t *b, size_t nb, int32_t *out) {
+  __m256i rot[8];
+  for (int r = 0; r < 8; r++) { rot[r] = rotation32(r); }
+  const size_t room = na < nb ? na : nb;
+  size_t i = 0, j = 0, k = 0;
+  while (i + 8 <= na && j + 8 <= nb) {
+    __m256i va = load256(a + i), vb = load256(b + j);
+    __m256i eq = _mm256_cmpeq_epi32(va, vb);
+    for (int r = 1; r < 8; r++) {
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(
+          va, _mm256_permutevar8x32_epi32(vb, rot[r])));
+    }
+    unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+    if (k + 8 <= room) {
+      __m256i packed =
+          _mm256_permutevar8x32_epi32(va, loadTable(kPack.lanes32[mask]));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), packed);
+      k += kPack.count[mask];
+    } else {
+      for (; mask != 0; mask &= mask - 1) {
+        out[k++] = a[i + __builtin_ctz(mask)];
+      }
+    }
+    int32_t amax = a[i + 7], bmax = b[j + 7];
+    i += 8 & -static_cast<size_t>(amax <= bmax);
+    j += 8 & -static_cast<size_t>(bmax <= amax);
+  }
+  _mm256_zeroupper();
+  return k + intersect32Sse2(a + i, na - i, b + j, nb - j, out + k);
+}
+
+RD_AVX2 size_t intersect64Avx2(const int64_t *a, size_t na,
+                               const int64_t *b, size_t nb, int64_t *out) {
+  const size_t room = na < nb ? na : nb;
+  size_t i = 0, j = 0, k = 0;
+  while (i + 4 <= na && j + 4 <= nb) {
+    __m256i va = load256(a + i), vb = load256(b + j);
+    __m256i eq = _mm256_cmpeq_epi64(va, vb);
+    eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(
+        va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+    eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(
+        va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+    eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(
+        va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+    unsigned mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+    if (k + 4 <= room) {
+      __m256i packed =
+          _mm256_permutevar8x32_epi32(va, loadTable(kPack.lanes64[mask]));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), packed);
+      k += kPack.count[mask];
+    } else {
+      for (; mask != 0; mask &= mask - 1) {
+        out[k++] = a[i + __builtin_ctz(mask)];
+      }
+    }
+    int64_t amax = a[i + 3], bmax = b[j + 3];
+    i += 4 & -static_cast<size_t>(amax <= bmax);
+    j += 4 & -static_cast<size_t>(bmax <= amax);
+  }
+  _mm256_zeroupper();
+  return k + intersectScalar(a + i, na - i, b + j, nb - j, out + k);
+}
+
+#undef RD_AVX2
+
+const Kernels kAvx2Kernels = {
+    equalAvx2, findCharAvx2, findAvx2,
+    spanAvx2, rspanAvx2, caseCompareAvx2,
+    popcountAvx2, bitAndAvx2, bitOrAvx2, bitXorAvx2, bitNotAvx2,
+    rank16Avx2, rank32Avx2, rank64Avx2,
+    intersect16Avx2, intersect32Avx2, intersect64Avx2,
+};
+
+#endif
+
+Level bestLevel() {
+#if defined(__x86_64__)
+  return hasAVX2() ? Level::kAVX2 : Level::kSSE2;
+#else
+  return Level::kScalar;
+#endif
+}
+
+const Kernels *kernelsOf(Level level) {
+  switch (level) {
+#if defined(__x86_64__)
+    case Level::kAVX2: return &kAvx2Kernels;
+    case Level::kSSE2: return &kSse2Kernels;
+#endif
+    default: return &kScalarKernels;
+  }
+}
+
+Level &activeLevel() {
+  static Level level = bestLevel();
+  return level;
+}
+
+}  // namespace
+
+bool hasAVX2() {
+#if defined(__x86_64__)
+  static bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+bool hasPopcnt() {
+#if defined(__x86_64__)
+  static bool popcnt = __builtin_cpu_supports("popcnt");
+  return popcnt;
+#else
+  return false;
+#endif
+}
+
+const Kernels &kernels() {
+  return *kernelsOf(activeLevel());
+}
+
+Level level() {
+  return activeLevel();
+}
+
+bool setLevel(Level level) {
+  if (level > bestLevel()) { return false; }
+  activeLevel() = level;
+  return true;
+}
+
+}  // namespace simd
+}  // namespace rd
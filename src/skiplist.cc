@@ -2,14 +2,14 @@
 // Created by suun on 5/17/19.
 //
 
-#include <random>
 #include "skiplist.h"
+#include "util.h"
 
 namespace rd {
 
 _SkipListNode::_SkipListNode(int level_num, double score,
-                             const String &elem = String())
-    : elem(elem), score(score), prev(nullptr) {
+                             String elem = String())
+    : elem(std::move(elem)), score(score), prev(nullptr) {
   levels = new _SkipListLevel[level_num];
 }
 _SkipListNode::~_SkipListNode() { delete[] levels; }
@@ -47,9 +47,7 @@ bool _SkipListIterator::operator!=(const _SkipListIterator &it) const {
 
 SkipList::size_type SkipList::randomLevel() {
   size_type level = 1;
-  std::mt19937 gen((std::random_device()()));
-  std::uniform_int_distribution<> distribution(0, 0xFFFF);
-  while (distribution(gen) < (0xFFFFu >> kLevelShiftBits)) {
+  while ((random64() & 0xFFFFu) < (0xFFFFu >> kLevelShiftBits)) {
     level += 1;
   }
   return std::min(level, kMaxLevel);
@@ -65,8 +63,12 @@ SkipList::~SkipList() {
     delete node;
     node = next;
   }
+  delete head_;
 }
 SkipList::iterator SkipList::insert(const String &elem, double score) {
+  return insert(String(elem), score);
+}
+SkipList::iterator SkipList::insert(String &&elem, double score) {
   link_type pos[kMaxLevel], node = head_;
   size_type rank[kMaxLevel];
   for (int i = level_ - 1; i >= 0; i--) {
@@ -86,7 +88,8 @@ SkipList::iterator SkipList::insert(const String &elem, double score) {
     pos[i] = head_;
     pos[i]->levels[i].span = size_;
   }
-  node = new _SkipListNode(level, score, elem);
+  if (level > level_) { level_ = level; }
+  node = new _SkipListNode(level, score, std::move(elem));
   for (int i = 0; i < level; i++) {
     _SkipListLevel &forward = pos[i]->levels[i];
     node->levels[i].next = forward.next;
@@ -107,4 +110,42 @@ SkipList::iterator SkipList::insert(const String &elem, double score) {
   return iterator(node);
 }
 
-}  // namespace rd
\ No newline at end of file
+bool SkipList::remove(StringView elem, double score) {
+  link_type pos[kMaxLevel], node = head_;
+  for (int i = level_ - 1; i >= 0; i--) {
+    while (node->levels[i].next &&
+        (node->levels[i].next->score < score ||
+            (node->levels[i].next->score == score &&
+                StringView(node->levels[i].next->elem) < elem))) {
+      node = node->levels[i].next;
+    }
+    pos[i] = node;
+  }
+  node = node->levels[0].next;
+  if (node == nullptr || node->score != score ||
+      StringView(node->elem) != elem) {
+    return false;
+  }
+  for (int i = 0; i < level_; i++) {
+    _SkipListLevel &forward = pos[i]->levels[i];
+    if (forward.next == node) {
+      forward.span += node->levels[i].span - 1;
+      forward.next = node->levels[i].next;
+    } else {
+      forward.span--;
+    }
+  }
+  if (node->levels[0].next) {
+    node->levels[0].next->prev = node->prev;
+  } else {
+    tail_ = node->prev;
+  }
+  while (level_ > 1 && head_->levels[level_ - 1].next == nullptr) {
+    level_--;
+  }
+  size_--;
+  delete node;
+  return true;
+}
+
+}  // namespace rd
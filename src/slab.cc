@@ -0,0 +1,61 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include "slab.h"
+
+namespace rd {
+
+namespace {
+size_type roundUp(size_type n, size_type align) {
+  return (n + align - 1) / align * align;
+}
+}
+
+Slab::Slab(size_type size, size_type align,
+           std::pmr::memory_resource *upstream)
+    : upstream_(upstream),
+      align_(align < alignof(_Chunk) ? alignof(_Chunk) : align),
+      free_(nullptr), chunks_(nullptr), cursor_(nullptr), limit_(nullptr),
+      next_blocks_(kMinChunkBlocks), used_(0), capacity_(0) {
+  // A free block stores the list link in place.
+  block_size_ = roundUp(size < sizeof(_FreeBlock) ? sizeof(_FreeBlock) : size,
+                        align_);
+}
+
+Slab::~Slab() {
+  freeChunks();
+}
+
+void Slab::freeChunks() {
+  while (chunks_ != nullptr) {
+    _Chunk *next = chunks_->next;
+    upstream_->deallocate(chunks_, chunks_->bytes, align_);
+    chunks_ = next;
+  }
+}
+
+void Slab::grow() {
+  size_type header = roundUp(sizeof(_Chunk), align_);
+  size_type bytes = header + next_blocks_ * block_size_;
+  auto chunk = static_cast<_Chunk *>(upstream_->allocate(bytes, align_));
+  chunk->next = chunks_;
+  chunk->bytes = bytes;
+  chunks_ = chunk;
+  cursor_ = reinterpret_cast<char *>(chunk) + header;
+  limit_ = cursor_ + next_blocks_ * block_size_;
+  capacity_ += next_blocks_;
+  if (next_blocks_ < kMaxChunkBlocks) { next_blocks_ *= 2; }
+}
+
+bool Slab::release() {
+  if (used_ != 0) { return false; }
+  freeChunks();
+  free_ = nullptr;
+  cursor_ = limit_ = nullptr;
+  next_blocks_ = kMinChunkBlocks;
+  capacity_ = 0;
+  return true;
+}
+
+}  // namespace rd
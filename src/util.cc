@@ -0,0 +1,134 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For std::chrono::system_clock
+#include <chrono>
+// For LLONG_MIN, LLONG_MAX, ULLONG_MAX
+#include <climits>
+// For random_device
+#include <random>
+#include "util.h"
+
+namespace rd {
+
+uint32_t digits10(uint64_t v) {
+  if (v < 10) { return 1; }
+  if (v < 100) { return 2; }
+  if (v < 1000) { return 3; }
+  if (v < 1000000000000ull) {
+    if (v < 100000000ull) {
+      if (v < 1000000) {
+        if (v < 10000) { return 4; }
+        return 5 + (v >= 100000);
+      }
+      return 7 + (v >= 10000000ull);
+    }
+    if (v < 10000000000ull) { return 9 + (v >= 1000000000ull); }
+    return 11 + (v >= 100000000000ull);
+  }
+  return 12 + digits10(v / 1000000000000ull);
+}
+
+// Emits two digits per division, from the back, like Redis' ull2string.
+size_t ull2string(char *dst, size_t dstlen, unsigned long long value) {
+  static const char kDigits[] =
+      "0001020304050607080910111213141516171819"
+      "2021222324252627282930313233343536373839"
+      "4041424344454647484950515253545556575859"
+      "6061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+  uint32_t length = digits10(value);
+  if (length >= dstlen) {
+    if (dstlen > 0) { dst[0] = '\0'; }
+    return 0;
+  }
+  uint32_t next = length - 1;
+  dst[length] = '\0';
+  while (value >= 100) {
+    auto i = static_cast<uint32_t>(value % 100) * 2;
+    value /= 100;
+    dst[next] = kDigits[i + 1];
+    dst[next - 1] = kDigits[i];
+    next -= 2;
+  }
+  if (value < 10) {
+    dst[next] = static_cast<char>('0' + value);
+  } else {
+    auto i = static_cast<uint32_t>(value) * 2;
+    dst[next] = kDigits[i + 1];
+    dst[next - 1] = kDigits[i];
+  }
+  return length;
+}
+
+size_t ll2string(char *dst, size_t dstlen, long long value) {
+  if (value >= 0) {
+    return ull2string(dst, dstlen, static_cast<unsigned long long>(value));
+  }
+  if (dstlen < 2) {
+    if (dstlen > 0) { dst[0] = '\0'; }
+    return 0;
+  }
+  // -LLONG_MIN overflows, so negate in unsigned arithmetic.
+  unsigned long long magnitude = 0ull - static_cast<unsigned long long>(value);
+  dst[0] = '-';
+  size_t length = ull2string(dst + 1, dstlen - 1, magnitude);
+  if (length == 0) {
+    dst[0] = '\0';
+    return 0;
+  }
+  return length + 1;
+}
+
+bool string2ll(const char *s, size_t slen, long long *value) {
+  const char *p = s, *end = s + slen;
+  bool negative = false;
+  if (slen == 0 || slen >= kLongStrSize) { return false; }
+  if (slen == 1 && p[0] == '0') {
+    if (value != nullptr) { *value = 0; }
+    return true;
+  }
+  if (p[0] == '-') {
+    negative = true;
+    if (++p == end) { return false; }
+  }
+  if (p[0] < '1' || p[0] > '9') { return false; }
+  unsigned long long v = p[0] - '0';
+  for (p++; p != end && p[0] >= '0' && p[0] <= '9'; p++) {
+    if (v > ULLONG_MAX / 10) { return false; }
+    v *= 10;
+    if (v > ULLONG_MAX - (p[0] - '0')) { return false; }
+    v += p[0] - '0';
+  }
+  if (p != end) { return false; }
+  if (negative) {
+    if (v > static_cast<unsigned long long>(LLONG_MAX) + 1) { return false; }
+    if (value != nullptr) {
+      *value = static_cast<long long>(0ull - v);
+    }
+  } else {
+    if (v > static_cast<unsigned long long>(LLONG_MAX)) { return false; }
+    if (value != nullptr) { *value = static_cast<long long>(v); }
+  }
+  return true;
+}
+
+// splitmix64: one add and two multiplies per number, and any seed works.
+uint64_t random64() {
+  static thread_local uint64_t state =
+      (static_cast<uint64_t>(std::random_device()()) << 32) |
+          std::random_device()();
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+long long mstime() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(
+      system_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace rd
@@ -0,0 +1,62 @@
+//
+// Created by suun on 10/18/26.
+//
+
+// For std::atomic
+#include <atomic>
+// For operator new, std::align_val_t
+#include <new>
+#include "zmalloc.h"
+
+namespace rd {
+
+namespace {
+// Relaxed: the counter orders no other memory.
+std::atomic<size_t> used_memory{0};
+
+class ZmallocResource : public std::pmr::memory_resource {
+ protected:
+  void *do_allocate(size_t bytes, size_t align) override {
+    used_memory.fetch_add(bytes, std::memory_order_relaxed);
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return ::operator new(bytes, std::align_val_t(align));
+    }
+    return ::operator new(bytes);
+  }
+  void do_deallocate(void *p, size_t bytes, size_t align) override {
+    used_memory.fetch_sub(bytes, std::memory_order_relaxed);
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(p, std::align_val_t(align));
+    } else {
+      ::operator delete(p);
+    }
+  }
+  bool do_is_equal(const std::pmr::memory_resource &other)
+  const noexcept override {
+    return this == &other;
+  }
+};
+}
+
+void *zmalloc(size_t size) {
+  used_memory.fetch_add(size, std::memory_order_relaxed);
+  return ::operator new(size);
+}
+
+void zfree(void *ptr, size_t size) {
+  if (ptr == nullptr) { return; }
+  used_memory.fetch_sub(size, std::memory_order_relaxed);
+  ::operator delete(ptr);
+}
+
+size_t usedMemory() {
+  return used_memory.load(std::memory_order_relaxed);
+}
+
+std::pmr::memory_resource *zmallocResource() {
+  // Never destroyed, so dicts with static storage can free into it.
+  static auto resource = new ZmallocResource;
+  return resource;
+}
+
+}  // namespace rd
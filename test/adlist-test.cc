@@ -85,3 +85,14 @@ TEST(adlist, rotate) {
   l.rotate();
   ASSERT_THAT(l, ElementsAre(5, 3, 1, 2));
 }
+
+TEST(adlist, move) {
+  rd::List<rd::String> l;
+  rd::String s(std::string(40, 'x').c_str());
+  const char *buffer = s.data();
+  l.pushBack(std::move(s));
+  ASSERT_EQ(l.begin()->data(), buffer);
+  rd::String t = l.popFront();
+  ASSERT_EQ(t.data(), buffer);
+  ASSERT_TRUE(l.empty());
+}
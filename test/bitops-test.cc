@@ -0,0 +1,130 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <random>
+#include <string>
+#include <gmock/gmock.h>
+#include "redis.h"
+#include "simd-levels.h"
+
+namespace {
+rd::String randomBitmap(size_t n, unsigned seed) {
+  std::mt19937 gen(seed);
+  rd::String s;
+  s.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    s.begin()[i] = static_cast<char>(gen());
+  }
+  return s;
+}
+
+size_t naiveCount(const rd::String &s, size_t from, size_t to) {
+  size_t count = 0;
+  for (size_t i = from * 8; i < to * 8; i++) {
+    count += rd::getBit(s, i);
+  }
+  return count;
+}
+}
+
+TEST(bitops, setgetbit) {
+  rd::String s;
+  ASSERT_EQ(rd::getBit(s, 100), 0);
+  ASSERT_EQ(rd::setBit(s, 7, 1), 0);
+  ASSERT_EQ(s.size(), 1);
+  ASSERT_EQ(s.begin()[0], '\x01');
+  ASSERT_EQ(rd::setBit(s, 0, 1), 0);
+  ASSERT_EQ(s.begin()[0], '\x81');
+  ASSERT_EQ(rd::setBit(s, 7, 0), 1);
+  ASSERT_EQ(rd::getBit(s, 0), 1);
+  ASSERT_EQ(rd::getBit(s, 7), 0);
+  // Growing far past the inline buffer zero-fills the gap.
+  ASSERT_EQ(rd::setBit(s, 8 * 1000 + 3, 1), 0);
+  ASSERT_EQ(s.size(), 1001);
+  ASSERT_EQ(rd::bitCount(s), 2);
+  ASSERT_EQ(rd::getBit(s, 8 * 1000 + 3), 1);
+  ASSERT_EQ(rd::setBit(s, rd::kMaxBitmapSize * 8, 1), -1);
+  ASSERT_EQ(s.size(), 1001);
+}
+
+TEST(bitops, bitcount) {
+  forEachSimdLevel([] {
+    for (size_t len : {0, 1, 7, 8, 31, 32, 33, 255, 256, 257, 1000, 9999}) {
+      rd::String s = randomBitmap(len, static_cast<unsigned>(len));
+      ASSERT_EQ(rd::bitCount(s), naiveCount(s, 0, len)) << len;
+      if (len < 4) { continue; }
+      ASSERT_EQ(rd::bitCount(s, 1, -2), naiveCount(s, 1, len - 1)) << len;
+      ASSERT_EQ(rd::bitCount(s, -3, -1), naiveCount(s, len - 3, len));
+    }
+  });
+  rd::String s("foobar");
+  ASSERT_EQ(rd::bitCount(s), 26);
+  ASSERT_EQ(rd::bitCount(s, 0, 0), 4);
+  ASSERT_EQ(rd::bitCount(s, 1, 1), 6);
+  ASSERT_EQ(rd::bitCount(s, -100, 100), 26);
+  ASSERT_EQ(rd::bitCount(s, 3, 2), 0);
+  ASSERT_EQ(rd::bitCount(s, 10, 20), 0);
+}
+
+TEST(bitops, bitpos) {
+  rd::String s;
+  ASSERT_EQ(rd::bitPos(s, 1), -1);
+  ASSERT_EQ(rd::bitPos(s, 0), 0);
+  s.assign("\xff\xf0\x00", 3);
+  ASSERT_EQ(rd::bitPos(s, 0), 12);
+  s.assign("\x00\xff\xf0", 3);
+  ASSERT_EQ(rd::bitPos(s, 1, 0), 8);
+  ASSERT_EQ(rd::bitPos(s, 1, 2, -1), 16);
+  s.assign("\x00\x00\x00", 3);
+  ASSERT_EQ(rd::bitPos(s, 1), -1);
+  s.assign("\xff\xff\xff", 3);
+  ASSERT_EQ(rd::bitPos(s, 0), 24);
+  ASSERT_EQ(rd::bitPos(s, 0, 0, -1), -1);
+  ASSERT_EQ(rd::bitPos(s, 0, 2), 24);
+  ASSERT_EQ(rd::bitPos(s, 0, 5), -1);
+
+  rd::String wide;
+  wide.resize(100);
+  rd::setBit(wide, 777, 1);
+  ASSERT_EQ(rd::bitPos(wide, 1), 777);
+  ASSERT_EQ(rd::bitPos(wide, 1, 98), -1);
+}
+
+TEST(bitops, bitop) {
+  forEachSimdLevel([] {
+    for (size_t len : {1, 15, 16, 33, 100, 1000}) {
+      rd::String a = randomBitmap(len, 1), b = randomBitmap(len / 2 + 1, 2);
+      rd::String dest;
+      ASSERT_EQ(rd::bitOp(rd::BitOp::kAnd, dest, {a, b}),
+                static_cast<long long>(len));
+      for (size_t i = 0; i < len * 8; i++) {
+        ASSERT_EQ(rd::getBit(dest, i), rd::getBit(a, i) & rd::getBit(b, i));
+      }
+      rd::bitOp(rd::BitOp::kOr, dest, {a, b});
+      for (size_t i = 0; i < len * 8; i++) {
+        ASSERT_EQ(rd::getBit(dest, i), rd::getBit(a, i) | rd::getBit(b, i));
+      }
+      rd::bitOp(rd::BitOp::kXor, dest, {a, b});
+      for (size_t i = 0; i < len * 8; i++) {
+        ASSERT_EQ(rd::getBit(dest, i), rd::getBit(a, i) ^ rd::getBit(b, i));
+      }
+      rd::bitOp(rd::BitOp::kNot, dest, {a});
+      ASSERT_EQ(rd::bitCount(dest) + rd::bitCount(a), len * 8);
+    }
+  });
+  // dest aliasing a source, and NOT arity.
+  rd::String a("\x0f\xf0"), b("\xff");
+  ASSERT_EQ(rd::bitOp(rd::BitOp::kAnd, a, {a, b}), 2);
+  ASSERT_EQ(a.size(), 2);
+  ASSERT_EQ(a.begin()[0], '\x0f');
+  ASSERT_EQ(a.begin()[1], '\x00');
+  ASSERT_EQ(rd::bitOp(rd::BitOp::kNot, a, {a, b}), -1);
+  // A longer, unrelated dest is overwritten rather than merged.
+  rd::String dest(std::string(100, 'x').c_str());
+  ASSERT_EQ(rd::bitOp(rd::BitOp::kOr, dest, {b}), 1);
+  ASSERT_EQ(dest.size(), 1);
+  ASSERT_EQ(dest.begin()[0], '\xff');
+  rd::String empty;
+  ASSERT_EQ(rd::bitOp(rd::BitOp::kOr, empty, {}), 0);
+}
@@ -0,0 +1,213 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+using namespace testing;
+
+namespace {
+// Restores the default thresholds when a test is done with them.
+class ScopedEncodingConfig {
+ private:
+  rd::EncodingConfig saved_;
+
+ public:
+  ScopedEncodingConfig() : saved_(rd::encodingConfig()) {}
+  ~ScopedEncodingConfig() { rd::encodingConfig() = saved_; }
+};
+
+std::string str(const rd::String &s) { return std::string(s.data(), s.size()); }
+}  // namespace
+
+TEST(collections, size) {
+  ASSERT_EQ(sizeof(rd::HashType), 16);
+  ASSERT_EQ(sizeof(rd::SetType), 16);
+  ASSERT_EQ(sizeof(rd::ZSetType), 16);
+  ASSERT_EQ(sizeof(rd::ListType), 16);
+}
+
+TEST(collections, hash) {
+  ScopedEncodingConfig scoped;
+  rd::encodingConfig().hash_max_listpack_entries = 4;
+  rd::HashType hash;
+  ASSERT_TRUE(hash.set("name", "alice"));
+  ASSERT_TRUE(hash.set("age", "30"));
+  ASSERT_FALSE(hash.set("age", "31"));
+  ASSERT_EQ(hash.encoding(), rd::Object::kEncodingListPack);
+  rd::String value;
+  ASSERT_TRUE(hash.get("age", &value));
+  ASSERT_EQ(str(value), "31");
+  // A value that looks like a field does not match it.
+  ASSERT_TRUE(hash.set("alice", "x"));
+  ASSERT_TRUE(hash.get("alice", &value));
+  ASSERT_EQ(str(value), "x");
+  ASSERT_TRUE(hash.remove("alice"));
+  ASSERT_FALSE(hash.exists("alice"));
+  ASSERT_EQ(hash.size(), 2);
+
+  for (int i = 0; i < 2; i++) { hash.set(std::to_string(i).c_str(), "v"); }
+  ASSERT_EQ(hash.encoding(), rd::Object::kEncodingListPack);
+  hash.set("one-too-many", "v");
+  ASSERT_EQ(hash.encoding(), rd::Object::kEncodingHashTable);
+  std::map<std::string, std::string> seen;
+  hash.forEach([&](rd::StringView f, rd::StringView v) {
+    seen[std::string(f.data(), f.size())] = std::string(v.data(), v.size());
+  });
+  ASSERT_THAT(seen, ElementsAre(Pair("0", "v"), Pair("1", "v"),
+                                Pair("age", "31"), Pair("name", "alice"),
+                                Pair("one-too-many", "v")));
+  ASSERT_TRUE(hash.get("name", &value));
+  ASSERT_EQ(str(value), "alice");
+  ASSERT_FALSE(hash.set("name", "bob"));
+  ASSERT_TRUE(hash.remove("0"));
+  ASSERT_EQ(hash.size(), 4);
+
+  // So does a value longer than hash_max_listpack_value.
+  rd::HashType wide;
+  wide.set("f", std::string(65, 'x').c_str());
+  ASSERT_EQ(wide.encoding(), rd::Object::kEncodingHashTable);
+}
+
+TEST(collections, set) {
+  ScopedEncodingConfig scoped;
+  rd::encodingConfig().set_max_intset_entries = 3;
+  rd::SetType set;
+  ASSERT_TRUE(set.add("3"));
+  ASSERT_TRUE(set.add("-1"));
+  ASSERT_FALSE(set.add("3"));
+  ASSERT_EQ(set.encoding(), rd::Object::kEncodingIntSet);
+  ASSERT_NE(set.intset(), nullptr);
+  ASSERT_TRUE(set.contains("-1"));
+  ASSERT_FALSE(set.contains("03"));
+  ASSERT_TRUE(set.add("7"));
+  // Full, but adding a member already there keeps the intset.
+  ASSERT_FALSE(set.add("7"));
+  ASSERT_EQ(set.encoding(), rd::Object::kEncodingIntSet);
+  std::vector<std::string> members;
+  set.forEach([&](rd::StringView m) {
+    members.emplace_back(m.data(), m.size());
+  });
+  ASSERT_THAT(members, ElementsAre("-1", "3", "7"));
+  ASSERT_TRUE(set.add("8"));
+  ASSERT_EQ(set.encoding(), rd::Object::kEncodingHashTable);
+  ASSERT_EQ(set.intset(), nullptr);
+  ASSERT_EQ(set.size(), 4);
+  ASSERT_TRUE(set.contains("-1"));
+  ASSERT_TRUE(set.remove("3"));
+  ASSERT_FALSE(set.contains("3"));
+
+  rd::SetType words;
+  words.add("1");
+  ASSERT_TRUE(words.add("one"));
+  ASSERT_EQ(words.encoding(), rd::Object::kEncodingHashTable);
+  ASSERT_TRUE(words.contains("1"));
+  ASSERT_TRUE(words.contains("one"));
+}
+
+TEST(collections, zset) {
+  ScopedEncodingConfig scoped;
+  rd::encodingConfig().zset_max_listpack_entries = 5;
+  rd::ZSetType zset;
+  ASSERT_TRUE(zset.add("c", 3));
+  ASSERT_TRUE(zset.add("a", 1.5));
+  ASSERT_TRUE(zset.add("b", 1.5));
+  ASSERT_TRUE(zset.add("d", -1e300));
+  ASSERT_FALSE(zset.add("c", 0));
+  ASSERT_EQ(zset.encoding(), rd::Object::kEncodingListPack);
+  double score;
+  ASSERT_TRUE(zset.score("d", &score));
+  ASSERT_EQ(score, -1e300);
+  ASSERT_TRUE(zset.score("a", &score));
+  ASSERT_EQ(score, 1.5);
+  auto ordered = [&] {
+    std::vector<std::pair<std::string, double>> out;
+    zset.forEach([&](rd::StringView m, double s) {
+      out.emplace_back(std::string(m.data(), m.size()), s);
+    });
+    return out;
+  };
+  std::vector<std::pair<std::string, double>> expected = {
+      {"d", -1e300}, {"c", 0}, {"a", 1.5}, {"b", 1.5}};
+  ASSERT_EQ(ordered(), expected);
+
+  ASSERT_TRUE(zset.add("e", 2));
+  ASSERT_TRUE(zset.add("f", 0.1));
+  ASSERT_EQ(zset.encoding(), rd::Object::kEncodingSkipList);
+  expected = {{"d", -1e300}, {"c", 0}, {"f", 0.1}, {"a", 1.5},
+              {"b", 1.5}, {"e", 2}};
+  ASSERT_EQ(ordered(), expected);
+  ASSERT_FALSE(zset.add("d", 10));
+  ASSERT_TRUE(zset.remove("c"));
+  ASSERT_FALSE(zset.remove("c"));
+  expected = {{"f", 0.1}, {"a", 1.5}, {"b", 1.5}, {"e", 2}, {"d", 10}};
+  ASSERT_EQ(ordered(), expected);
+  ASSERT_TRUE(zset.score("d", &score));
+  ASSERT_EQ(score, 10);
+  ASSERT_EQ(zset.size(), 5);
+}
+
+TEST(collections, list) {
+  ScopedEncodingConfig scoped;
+  rd::encodingConfig().list_max_listpack_entries = 4;
+  rd::ListType list;
+  list.pushBack("b");
+  list.pushBack("42");
+  list.pushFront("a");
+  ASSERT_EQ(list.encoding(), rd::Object::kEncodingListPack);
+  rd::String value;
+  ASSERT_TRUE(list.index(-1, &value));
+  ASSERT_EQ(str(value), "42");
+  ASSERT_TRUE(list.popFront(&value));
+  ASSERT_EQ(str(value), "a");
+  list.pushFront("a");
+  list.pushBack("c");
+  list.pushBack("d");
+  ASSERT_EQ(list.encoding(), rd::Object::kEncodingLinkedList);
+  std::vector<std::string> values;
+  list.forEach([&](rd::StringView v) {
+    values.emplace_back(v.data(), v.size());
+  });
+  ASSERT_THAT(values, ElementsAre("a", "b", "42", "c", "d"));
+  for (int i = -5; i < 5; i++) {
+    ASSERT_TRUE(list.index(i, &value));
+    ASSERT_EQ(str(value), values[(i + 5) % 5]);
+  }
+  ASSERT_FALSE(list.index(5, &value));
+  ASSERT_FALSE(list.index(-6, &value));
+  ASSERT_TRUE(list.popBack(&value));
+  ASSERT_EQ(str(value), "d");
+  ASSERT_EQ(list.size(), 4);
+
+  rd::ListType empty;
+  ASSERT_FALSE(empty.popFront(&value));
+  ASSERT_FALSE(empty.popBack(&value));
+  ASSERT_FALSE(empty.index(0, &value));
+}
+
+TEST(collections, memory) {
+  // Everything goes back, whichever encoding a collection ended in.
+  size_t base = rd::usedMemory();
+  {
+    rd::HashType small, big;
+    rd::ZSetType zsmall, zbig;
+    for (int i = 0; i < 200; i++) {
+      std::string s = std::to_string(i);
+      if (i < 3) {
+        small.set(s.c_str(), s.c_str());
+        zsmall.add(s.c_str(), i);
+      }
+      big.set(s.c_str(), s.c_str());
+      zbig.add(s.c_str(), i);
+    }
+    ASSERT_EQ(big.encoding(), rd::Object::kEncodingHashTable);
+    ASSERT_EQ(zbig.encoding(), rd::Object::kEncodingSkipList);
+    ASSERT_GT(rd::usedMemory(), base);
+  }
+  ASSERT_EQ(rd::usedMemory(), base);
+}
@@ -0,0 +1,86 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <set>
+#include <thread>
+#include <vector>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+using namespace testing;
+
+TEST(concurrentdict, basic) {
+  rd::ConcurrentDict<int, int> ints(16);
+  const int n = 100000;
+  for (int i = 0; i < n; i++) { ASSERT_TRUE(ints.add(i, -i)); }
+  ASSERT_FALSE(ints.add(7, 0));
+  ASSERT_EQ(ints.size(), n);
+  int value;
+  ASSERT_TRUE(ints.get(7, &value));
+  ASSERT_EQ(value, -7);
+  ASSERT_FALSE(ints.get(n, &value));
+  ints.replace(7, 7);
+  ASSERT_TRUE(ints.get(7, &value));
+  ASSERT_EQ(value, 7);
+  ASSERT_TRUE(ints.remove(7));
+  ASSERT_FALSE(ints.remove(7));
+  ASSERT_EQ(ints.size(), n - 1);
+
+  std::vector<int> keys = {1, 7, 2, n, 3};
+  std::vector<int> values(keys.size());
+  bool found[5];
+  ASSERT_EQ(ints.getMany(keys.data(), keys.size(), values.data(), found), 3);
+  ASSERT_THAT(std::vector<bool>(found, found + 5),
+              ElementsAre(true, false, true, false, true));
+  ASSERT_EQ(values[4], -3);
+}
+
+TEST(concurrentdict, scan) {
+  rd::ConcurrentDict<int, int> ints(8);
+  for (int i = 0; i < 20000; i++) { ints.add(i, i); }
+  std::set<int> seen;
+  rd::size_type cursor = 0;
+  do {
+    cursor = ints.scan(cursor, [&](rd::ConcurrentDict<int, int>::pointer e) {
+      seen.insert(e->key);
+    });
+  } while (cursor != 0);
+  ASSERT_EQ(seen.size(), 20000);
+}
+
+TEST(concurrentdict, threads) {
+  rd::ConcurrentDict<rd::String, int> strings;
+  const int kThreads = 8, kKeys = 20000;
+  std::vector<std::thread> threads;
+  // Each thread writes its own keys and reads everyone's.
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&strings, t] {
+      for (int i = t; i < kThreads * kKeys; i += kThreads) {
+        std::string key = std::to_string(i);
+        strings.add(rd::String(key.c_str()), i);
+        int value;
+        ASSERT_TRUE(strings.get(rd::StringView(key.c_str()), &value));
+        ASSERT_EQ(value, i);
+        std::string other = std::to_string(i / 2);
+        if (strings.get(rd::StringView(other.c_str()), &value)) {
+          ASSERT_EQ(value, i / 2);
+        }
+        if (i % 5 == 0) { strings.remove(rd::StringView(key.c_str())); }
+        if (i % 101 == 0) {
+          std::string names[4] = {"1", "2", key, "x"};
+          rd::StringView probes[4] = {names[0].c_str(), names[1].c_str(),
+                                      names[2].c_str(), names[3].c_str()};
+          int values[4];
+          bool found[4];
+          strings.getMany(probes, 4, values, found);
+          ASSERT_FALSE(found[3]);
+          if (found[2]) { ASSERT_EQ(values[2], i); }
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) { thread.join(); }
+  strings.cron(100000);
+  ASSERT_EQ(strings.size(), kThreads * kKeys * 4 / 5);
+}
@@ -0,0 +1,25 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_TEST_DB_HELPERS_H
+#define REDIS_TEST_DB_HELPERS_H
+
+#include <string>
+#include "redis.h"
+
+// The key fill() gives its ith value.
+inline rd::String keyOf(int i) {
+  return rd::String(("key:" + std::to_string(i)).c_str());
+}
+
+// Sets n keys to values of size bytes each.
+inline void fill(rd::Db &db, int n, size_t size = 200) {
+  std::string text(size, 'v');
+  for (int i = 0; i < n; i++) {
+    db.set(keyOf(i).view(),
+           rd::Object::createString(rd::String(text.data(), text.size())));
+  }
+}
+
+#endif //REDIS_TEST_DB_HELPERS_H
@@ -0,0 +1,62 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <gmock/gmock.h>
+#include "redis.h"
+
+TEST(db, basic) {
+  size_t base = rd::usedMemory();
+  {
+    rd::Db db;
+    db.set(rd::StringView("a"), rd::Object::createString("hello"));
+    db.set(rd::StringView("b"), rd::Object::createInt(123456));
+    ASSERT_EQ(db.size(), 2);
+    ASSERT_STREQ(db.lookup(rd::StringView("a"))->toString().data(), "hello");
+    ASSERT_THAT(db.lookup(rd::StringView("c")), nullptr);
+
+    ASSERT_TRUE(db.setExpire(rd::StringView("a"), 1000));
+    ASSERT_FALSE(db.setExpire(rd::StringView("c"), 1000));
+    ASSERT_EQ(db.getExpire(rd::StringView("a")), 1000);
+    ASSERT_EQ(db.getExpire(rd::StringView("b")), -1);
+    // Overwriting a key clears its TTL.
+    db.set(rd::StringView("a"), rd::Object::createString("world"));
+    ASSERT_EQ(db.getExpire(rd::StringView("a")), -1);
+    ASSERT_STREQ(db.lookup(rd::StringView("a"))->toString().data(), "world");
+
+    ASSERT_TRUE(db.setExpire(rd::StringView("b"), 1000));
+    ASSERT_TRUE(db.remove(rd::StringView("b")));
+    ASSERT_FALSE(db.remove(rd::StringView("b")));
+    ASSERT_TRUE(db.expires().empty());
+    ASSERT_EQ(db.size(), 1);
+  }
+  // Every key, value and table went back.
+  ASSERT_EQ(rd::usedMemory(), base);
+}
+
+TEST(db, access) {
+  rd::Db db;
+  rd::MaxmemoryConfig config;
+  config.policy = rd::MaxmemoryPolicy::kAllKeysLru;
+  db.setMaxmemory(config);
+  // Shared integers cannot record accesses, so the Db keeps its own.
+  db.set(rd::StringView("n"), rd::Object::createInt(7));
+  rd::Object *n = db.lookup(rd::StringView("n"));
+  ASSERT_FALSE(n->isShared());
+  n->setLru(rd::Object::lruClock() - 100);
+  db.lookup(rd::StringView("n"));
+  ASSERT_LT(n->idleMilliseconds(), 2000);
+
+  config.policy = rd::MaxmemoryPolicy::kAllKeysLfu;
+  db.setMaxmemory(config);
+  db.set(rd::StringView("f"), rd::Object::createString("value"));
+  rd::Object *f = db.lookup(rd::StringView("f"));
+  ASSERT_GE(f->lfuCounter(1), rd::Object::kLfuInitValue);
+  for (int i = 0; i < 100; i++) { db.lookup(rd::StringView("f")); }
+  uint8_t counter = f->lfuCounter(1);
+  ASSERT_GT(counter, rd::Object::kLfuInitValue);
+  // An overwrite keeps the counter.
+  db.set(rd::StringView("f"), rd::Object::createString("other"));
+  ASSERT_EQ(db.dict().get(rd::StringView("f"))->value->lfuCounter(1),
+            counter);
+}
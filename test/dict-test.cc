@@ -2,6 +2,10 @@
 // Created by suun on 5/15/19.
 //
 
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 #include <gmock/gmock.h>
 #include "redis.h"
 
@@ -9,11 +13,11 @@ using namespace testing;
 
 using Var = std::variant<int, float>;
 
-std::shared_ptr<rd::Dict> dict;
+std::shared_ptr<rd::Dict<Var, Var>> dict;
 const int kLen = 9000;
 Var ki(5), kj(10);
 TEST(dict, constructor) {
-  dict = std::make_shared<rd::Dict>();
+  dict = std::make_shared<rd::Dict<Var, Var>>();
 }
 
 TEST(dict, add) {
@@ -67,10 +71,394 @@ TEST(dict, scan) {
   do {
     cursor = dict->scan(
         cursor,
-        [&count](rd::Dict::pointer entry) {
+        [&count](rd::Dict<Var, Var>::pointer entry) {
           count++;
         }
     );
   } while (cursor);
   ASSERT_THAT(count, dict->size());
 }
+
+TEST(dict, iterate) {
+  rd::Dict<int, int> ints;
+  int n = 0;
+  // Keep adding until a rehash is left in progress.
+  for (; n < 100 || !ints.isRehashing(); n++) { ints.add(n, -n); }
+  // Iterators visit both tables mid-rehash and stop it while alive.
+  rd::size_type count = 0, sum = 0;
+  for (auto it = ints.begin(); it != ints.end(); ++it) {
+    count++;
+    sum += it->key;
+    ASSERT_EQ(it->value, -it->key);
+    ASSERT_FALSE(ints.isRehashable());
+  }
+  ASSERT_EQ(count, n);
+  ASSERT_EQ(sum, (n - 1) * n / 2);
+  ASSERT_TRUE(ints.isRehashable());
+  ints.rehashMilliseconds(100);
+  ASSERT_FALSE(ints.isRehashing());
+}
+
+TEST(dict, stringkeys) {
+  rd::Dict<rd::String, int> strings;
+  for (int i = 0; i < 1000; i++) {
+    strings.add(rd::String(std::to_string(i).c_str()), i);
+  }
+  ASSERT_EQ(strings.size(), 1000);
+  // Probing with a view into a larger buffer builds no String.
+  const char *buf = "123456";
+  ASSERT_EQ(strings.get(rd::StringView(buf, 3))->value, 123);
+  ASSERT_EQ(strings.get(rd::StringView("999"))->value, 999);
+  ASSERT_THAT(strings.get(rd::StringView("1000")), nullptr);
+  ASSERT_EQ(strings.add(rd::String("7"), 0), strings.end());
+  strings.replace(rd::String("7"), 70);
+  ASSERT_EQ(strings.get(rd::String("7"))->value, 70);
+  ASSERT_EQ(strings.size(), 1000);
+  ASSERT_TRUE(strings.remove(rd::StringView("7")));
+  ASSERT_FALSE(strings.remove(rd::StringView("7")));
+  ASSERT_EQ(strings.size(), 999);
+}
+
+TEST(dict, getmany) {
+  rd::Dict<int, int> ints;
+  int n = 0;
+  for (; n < 100 || !ints.isRehashing(); n++) { ints.add(n, -n); }
+  // Half hits, half misses, looked up across both tables mid-rehash.
+  std::vector<int> keys;
+  for (int i = 0; i < 2 * n; i++) { keys.push_back(i * 7 % (2 * n)); }
+  std::vector<rd::Dict<int, int>::pointer> out(keys.size());
+  ints.getMany(keys.data(), keys.size(), out.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (keys[i] < n) {
+      ASSERT_NE(out[i], nullptr);
+      ASSERT_EQ(out[i]->value, -keys[i]);
+    } else {
+      ASSERT_EQ(out[i], nullptr);
+    }
+  }
+  rd::Dict<rd::String, int> strings;
+  strings.add(rd::String("a"), 1);
+  strings.add(rd::String("b"), 2);
+  rd::StringView probes[] = {"b", "c", "a"};
+  rd::Dict<rd::String, int>::pointer found[3];
+  strings.getMany(probes, 3, found);
+  ASSERT_EQ(found[0]->value, 2);
+  ASSERT_EQ(found[1], nullptr);
+  ASSERT_EQ(found[2]->value, 1);
+}
+
+namespace {
+struct CountingHasher {
+  using is_transparent = void;
+  static size_t calls;
+  size_t operator()(rd::StringView key) const {
+    calls++;
+    return rd::StringHasher<>()(key);
+  }
+};
+size_t CountingHasher::calls = 0;
+}
+
+TEST(dict, cachedhash) {
+  using Strings = rd::Dict<rd::String, int, CountingHasher>;
+  Strings strings;
+  const int n = 10000;
+  CountingHasher::calls = 0;
+  for (int i = 0; i < n; i++) {
+    strings.add(rd::String(std::to_string(i).c_str()), i);
+  }
+  strings.rehashMilliseconds(1000);
+  // One hash per add: rehashing reuses the cached ones.
+  ASSERT_EQ(CountingHasher::calls, n);
+  ASSERT_EQ(strings.get(rd::StringView("1234"))->value, 1234);
+  rd::Dict<rd::String, int, CountingHasher, std::equal_to<>, false> plain;
+  CountingHasher::calls = 0;
+  for (int i = 0; i < n; i++) {
+    plain.add(rd::String(std::to_string(i).c_str()), i);
+  }
+  plain.rehashMilliseconds(1000);
+  ASSERT_GT(CountingHasher::calls, n);
+  ASSERT_EQ(plain.get(rd::StringView("1234"))->value, 1234);
+}
+
+TEST(dict, cronrehash) {
+  rd::Dict<int, int> ints;
+  ints.setRehashMode(rd::RehashMode::kCron);
+  int n = 0;
+  for (; n < 100 || !ints.isRehashing(); n++) { ints.add(n, n); }
+  // Operations leave the rehash to the cron.
+  for (int i = 0; i < n; i++) { ASSERT_EQ(ints.get(i)->value, i); }
+  ASSERT_TRUE(ints.isRehashing());
+  ints.rehashMicroseconds(100000);
+  ASSERT_FALSE(ints.isRehashing());
+  ASSERT_EQ(ints.size(), n);
+}
+
+TEST(dict, threadrehash) {
+  rd::Dict<rd::String, int> strings;
+  strings.setRehashMode(rd::RehashMode::kThread);
+  const int n = 200000;
+  // Inserts, lookups and removes race the helper through many resizes.
+  for (int i = 0; i < n; i++) {
+    strings.add(rd::String(std::to_string(i).c_str()), i);
+    int half = i / 2;
+    auto it = strings.get(rd::StringView(std::to_string(half).c_str()));
+    if (half % 3 == 0 && half != i) {
+      ASSERT_THAT(it, nullptr);
+    } else {
+      ASSERT_EQ(it->value, half);
+    }
+    if (i % 3 == 0) {
+      ASSERT_TRUE(strings.remove(rd::StringView(std::to_string(i).c_str())));
+    }
+  }
+  while (strings.isRehashing()) {
+    strings.rehashMicroseconds(1000);
+    std::this_thread::yield();
+  }
+  ASSERT_EQ(strings.size(), n - (n + 2) / 3);
+  for (int i = 0; i < n; i++) {
+    auto it = strings.get(rd::StringView(std::to_string(i).c_str()));
+    if (i % 3 == 0) {
+      ASSERT_THAT(it, nullptr);
+    } else {
+      ASSERT_EQ(it->value, i);
+    }
+  }
+  // Iterating stops a helper; the walk sees every entry once.
+  for (int i = n; strings.isRehashing() == false; i++) {
+    strings.add(rd::String(std::to_string(i).c_str()), i);
+  }
+  rd::size_type count = 0;
+  for (auto it = strings.begin(); it != strings.end(); ++it) { count++; }
+  ASSERT_EQ(count, strings.size());
+}
+
+TEST(dict, random) {
+  rd::Dict<int, int> ints;
+  ASSERT_EQ(ints.randomEntry(), nullptr);
+  rd::Dict<int, int>::pointer out[64];
+  ASSERT_EQ(ints.sampleEntries(8, out), 0);
+  for (int i = 0; i < 16; i++) { ints.add(i, i); }
+  std::set<int> seen;
+  for (int i = 0; i < 1000; i++) { seen.insert(ints.randomEntry()->key); }
+  ASSERT_EQ(seen.size(), 16);
+  // Never more than asked for or than there are, rehashing or not.
+  int n = 16;
+  for (; !ints.isRehashing(); n++) { ints.add(n, n); }
+  rd::size_type got = ints.sampleEntries(64, out);
+  ASSERT_LE(got, 64);
+  for (rd::size_type i = 0; i < got; i++) {
+    ASSERT_EQ(ints.get(out[i]->key)->value, out[i]->value);
+  }
+}
+
+TEST(dict, randomsparse) {
+  rd::Dict<int, int> ints;
+  for (int i = 0; i < 100000; i++) { ints.add(i, i); }
+  for (int i = 10; i < 100000; i++) { ints.remove(i); }
+  // 10 entries over 128K buckets: samples stay short, random entries
+  // still turn up every key.
+  rd::Dict<int, int>::pointer out[4];
+  std::set<int> seen;
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_LE(ints.sampleEntries(4, out), 4);
+    seen.insert(ints.randomEntry()->key);
+  }
+  ASSERT_EQ(seen.size(), 10);
+}
+
+TEST(dict, randomsparsecron) {
+  rd::Dict<int, int> ints;
+  for (int i = 0; i < 100000; i++) { ints.add(i, i); }
+  ints.rehashMicroseconds(100000);
+  ints.setRehashMode(rd::RehashMode::kCron);
+  for (int i = 3; i < 100000; i++) { ints.remove(i); }
+  // The cron would shrink the table; randomEntry leaves it as it is and
+  // finds the 3 entries among 128K buckets all the same.
+  rd::size_type buckets = ints.buckets();
+  std::set<int> seen;
+  for (int i = 0; i < 1000; i++) { seen.insert(ints.randomEntry()->key); }
+  ASSERT_EQ(seen.size(), 3);
+  ASSERT_FALSE(ints.isRehashing());
+  ASSERT_EQ(ints.buckets(), buckets);
+}
+
+TEST(dict, scanpartition) {
+  const rd::size_type parts = 8;
+  rd::Dict<int, int> ints;
+  for (int i = 0; i < 10000; i++) { ints.add(i, i); }
+  ints.rehashMilliseconds(100);
+  // Without resizes the parts are disjoint: each key comes back once.
+  std::vector<int> seen(10000);
+  for (rd::size_type part = 0; part < parts; part++) {
+    rd::size_type cursor = 0;
+    do {
+      cursor = ints.scanPartition(part, parts, cursor,
+                                  [&](rd::Dict<int, int>::pointer entry) {
+        seen[entry->key]++;
+      });
+    } while (cursor);
+  }
+  for (int i = 0; i < 10000; i++) { ASSERT_EQ(seen[i], 1); }
+
+  // Parts advanced in turn while the table grows, then shrinks, still
+  // see every key present throughout.
+  std::set<int> found;
+  rd::size_type cursors[parts] = {};
+  bool done[parts] = {};
+  for (int round = 0, left = parts; left > 0; round++) {
+    for (rd::size_type part = 0; part < parts; part++) {
+      if (done[part]) { continue; }
+      cursors[part] = ints.scanPartition(
+          part, parts, cursors[part],
+          [&](rd::Dict<int, int>::pointer entry) {
+            found.insert(entry->key);
+          });
+      if (cursors[part] == 0) {
+        done[part] = true;
+        left--;
+      }
+    }
+    if (round == 10) {
+      for (int i = 10000; i < 50000; i++) { ints.add(i, i); }
+    } else if (round == 200) {
+      for (int i = 10000; i < 50000; i++) { ints.remove(i); }
+      ints.shrink();
+    }
+  }
+  for (int i = 0; i < 10000; i++) { ASSERT_EQ(found.count(i), 1); }
+}
+
+TEST(dict, scanpartitionsmall) {
+  // Fewer buckets than parts: each part filters its keys by hash.
+  rd::Dict<rd::String, int> strings;
+  for (int i = 0; i < 3; i++) {
+    strings.add(rd::String(std::to_string(i).c_str()), i);
+  }
+  int seen[3] = {};
+  for (rd::size_type part = 0; part < 64; part++) {
+    rd::size_type cursor = 0;
+    do {
+      cursor = strings.scanPartition(
+          part, 64, cursor, [&](rd::Dict<rd::String, int>::pointer entry) {
+            seen[entry->value]++;
+          });
+    } while (cursor);
+  }
+  ASSERT_THAT(seen, ElementsAre(1, 1, 1));
+}
+
+TEST(dict, scanparallel) {
+  rd::Dict<int, int> ints;
+  const int n = 200000;
+  for (int i = 0; i < n; i++) { ints.add(i, i); }
+  const rd::size_type threads = 4;
+  std::vector<long long> sums(threads), counts(threads);
+  ints.scanParallel(threads, [&](rd::Dict<int, int>::pointer entry,
+                                 rd::size_type worker) {
+    sums[worker] += entry->key;
+    counts[worker]++;
+  });
+  long long sum = 0, count = 0;
+  for (rd::size_type i = 0; i < threads; i++) {
+    sum += sums[i];
+    count += counts[i];
+  }
+  ASSERT_EQ(count, n);
+  ASSERT_EQ(sum, static_cast<long long>(n - 1) * n / 2);
+}
+
+TEST(dict, reserve) {
+  rd::Dict<int, int> ints;
+  ints.reserve(1000);
+  ASSERT_EQ(ints.buckets(), 1024);
+  for (int i = 0; i < 1024; i++) { ints.addUnique(i, i); }
+  // Sized up front: no resize along the way, nor a doubling at the end.
+  ASSERT_FALSE(ints.isRehashing());
+  ASSERT_EQ(ints.buckets(), 1024);
+  // Past the reserved size the table doubles in place.
+  ints.addUnique(1024, 1024);
+  ASSERT_FALSE(ints.isRehashing());
+  ASSERT_EQ(ints.buckets(), 2048);
+  // Reserving less is a no-op; more moves every entry now, mid-rehash
+  // ones included.
+  ints.reserve(10);
+  ASSERT_EQ(ints.buckets(), 2048);
+  for (int i = 1025; !ints.isRehashing(); i++) { ints.add(i, i); }
+  ints.reserve(100000);
+  ASSERT_FALSE(ints.isRehashing());
+  ASSERT_EQ(ints.buckets(), 131072);
+  for (int i = 0; i < static_cast<int>(ints.size()); i++) {
+    ASSERT_EQ(ints.get(i)->value, i);
+  }
+}
+
+TEST(dict, addunique) {
+  rd::Dict<rd::String, int> strings;
+  for (int i = 0; i < 5000; i++) {
+    auto it = strings.addUnique(rd::String(std::to_string(i).c_str()), i);
+    ASSERT_EQ(it->value, i);
+  }
+  ASSERT_EQ(strings.size(), 5000);
+  for (int i = 0; i < 5000; i++) {
+    ASSERT_EQ(strings.get(rd::String(std::to_string(i).c_str()))->value, i);
+  }
+  // An incremental rehash in progress goes into the new table, which
+  // grows in place too.
+  rd::Dict<int, int> ints;
+  int n = 0;
+  for (; !ints.isRehashing(); n++) { ints.add(n, n); }
+  for (int i = n; i < n + 100; i++) { ints.addUnique(i, i); }
+  for (int i = 0; i < n + 100; i++) { ASSERT_EQ(ints.get(i)->value, i); }
+  ASSERT_EQ(ints.size(), n + 100);
+}
+
+namespace {
+struct DensePolicy : rd::DictPolicy {
+  static constexpr rd::size_type kInitialSize = 64;
+  static constexpr rd::size_type kResizeRatio = 4;
+  static constexpr rd::size_type kGrowthFactor = 4;
+};
+struct CountedPolicy : rd::DictPolicy {
+  static constexpr bool kStats = true;
+};
+}  // namespace
+
+TEST(dict, policy) {
+  using Dense = rd::Dict<int, int, std::hash<int>, std::equal_to<>, false,
+                         DensePolicy>;
+  using Counted = rd::Dict<int, int, std::hash<int>, std::equal_to<>, false,
+                           CountedPolicy>;
+  // The tuning takes no room; counters take only their own.
+  ASSERT_EQ(sizeof(Dense), sizeof(rd::Dict<int, int>));
+  ASSERT_EQ(sizeof(Counted),
+            sizeof(rd::Dict<int, int>) + sizeof(rd::DictStats));
+
+  Dense dense;
+  ASSERT_EQ(dense.buckets(), 64);
+  // Four entries per bucket before growing, and then four times over.
+  for (int i = 0; i < 255; i++) { dense.add(i, i); }
+  ASSERT_FALSE(dense.isRehashing());
+  dense.add(255, 255);
+  ASSERT_TRUE(dense.isRehashing());
+  dense.rehashMilliseconds(100);
+  ASSERT_EQ(dense.buckets(), 1024);
+
+  Counted counted;
+  for (int i = 0; i < 100; i++) { counted.add(i, i); }
+  const rd::DictStats &stats = counted.stats();
+  // add looks up every key but the first, into an empty dict.
+  ASSERT_EQ(stats.lookups, 99);
+  ASSERT_GT(stats.resizes, 0);
+  ASSERT_GT(stats.rehash_steps, 0);
+  ASSERT_GT(stats.rehashed_buckets, 0);
+  uint64_t probes = stats.probes;
+  for (int i = 0; i < 100; i++) { ASSERT_EQ(counted.get(i)->value, i); }
+  ASSERT_EQ(stats.lookups, 199);
+  // Every hit compares at least its own entry.
+  ASSERT_GE(stats.probes - probes, 100);
+  ASSERT_GE(stats.max_chain, 1);
+  ASSERT_TRUE(counted.remove(5));
+  ASSERT_EQ(stats.lookups, 200);
+}
@@ -0,0 +1,120 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <gmock/gmock.h>
+#include "redis.h"
+#include "db-helpers.h"
+
+namespace {
+// Lowers maxmemory so that about n values have to go.
+void limitBelowUsage(rd::Db &db, rd::MaxmemoryPolicy policy, int n) {
+  rd::MaxmemoryConfig config;
+  config.policy = policy;
+  config.maxmemory = rd::usedMemory() - n * 200;
+  db.setMaxmemory(config);
+}
+
+rd::EvictResult evict(rd::Db &db) {
+  rd::EvictResult result;
+  while ((result = db.performEvictions()) == rd::EvictResult::kRunning) {}
+  return result;
+}
+}  // namespace
+
+TEST(evict, pool) {
+  rd::EvictionPool pool;
+  for (int i = 0; i < 100; i++) {
+    pool.insert(keyOf(i).view(), (i * 37) % 100);
+  }
+  ASSERT_EQ(pool.size(), rd::EvictionPool::kSize);
+  // The best 16 idle times, 99 down to 84, come out best first.
+  for (int idle = 99; idle >= 84; idle--) {
+    ASSERT_EQ(pool.pop(), keyOf(idle * 73 % 100));
+  }
+  ASSERT_TRUE(pool.empty());
+}
+
+TEST(evict, allkeyslru) {
+  rd::Db db;
+  fill(db, 2000);
+  // The first half was last used a quarter of an hour ago.
+  uint32_t old = rd::Object::lruClock() - 900;
+  for (int i = 0; i < 1000; i++) {
+    db.dict().get(keyOf(i).view())->value->setLru(old);
+  }
+  limitBelowUsage(db, rd::MaxmemoryPolicy::kAllKeysLru, 500);
+  ASSERT_EQ(evict(db), rd::EvictResult::kOk);
+  ASSERT_LE(rd::usedMemory(), db.maxmemory().maxmemory);
+  ASSERT_LT(db.size(), 2000);
+  int recent = 0;
+  for (int i = 1000; i < 2000; i++) {
+    recent += db.dict().get(keyOf(i).view()) != db.dict().end();
+  }
+  ASSERT_GE(recent, 990);
+}
+
+TEST(evict, allkeyslfu) {
+  rd::Db db;
+  fill(db, 2000);
+  uint32_t now = rd::Object::lfuMinutes();
+  for (int i = 0; i < 2000; i++) {
+    // Even keys are hot, odd keys cold.
+    db.dict().get(keyOf(i).view())->value->setLru(
+        now << 8 | (i % 2 == 0 ? 200 : 5));
+  }
+  limitBelowUsage(db, rd::MaxmemoryPolicy::kAllKeysLfu, 500);
+  ASSERT_EQ(evict(db), rd::EvictResult::kOk);
+  int hot = 0;
+  for (int i = 0; i < 2000; i += 2) {
+    hot += db.dict().get(keyOf(i).view()) != db.dict().end();
+  }
+  ASSERT_GE(hot, 990);
+}
+
+TEST(evict, volatilettl) {
+  rd::Db db;
+  fill(db, 2000);
+  for (int i = 0; i < 1000; i++) { db.setExpire(keyOf(i).view(), i); }
+  limitBelowUsage(db, rd::MaxmemoryPolicy::kVolatileTtl, 200);
+  ASSERT_EQ(evict(db), rd::EvictResult::kOk);
+  // Only keys with a TTL go, sooner ones first.
+  ASSERT_EQ(db.size() + 1000, 2000 + db.expires().size());
+  int evicted = 1000 - db.expires().size(), early = 0;
+  for (int i = 0; i < 500; i++) {
+    early += db.getExpire(keyOf(i).view()) == -1;
+  }
+  ASSERT_GE(early, evicted * 9 / 10);
+
+  // Once the keys with a TTL are gone, nothing else may be evicted.
+  rd::MaxmemoryConfig config = db.maxmemory();
+  config.maxmemory = 1;
+  db.setMaxmemory(config);
+  ASSERT_EQ(evict(db), rd::EvictResult::kFail);
+  ASSERT_TRUE(db.expires().empty());
+  ASSERT_EQ(db.size(), 1000);
+}
+
+TEST(evict, noeviction) {
+  rd::Db db;
+  fill(db, 100);
+  limitBelowUsage(db, rd::MaxmemoryPolicy::kNoEviction, 10);
+  ASSERT_EQ(db.performEvictions(), rd::EvictResult::kFail);
+  ASSERT_EQ(db.size(), 100);
+}
+
+TEST(evict, incremental) {
+  rd::Db db;
+  fill(db, 2000);
+  limitBelowUsage(db, rd::MaxmemoryPolicy::kAllKeysLru, 1000);
+  rd::MaxmemoryConfig config = db.maxmemory();
+  config.eviction_time_limit_us = 0;
+  db.setMaxmemory(config);
+  // Out of time after the first 16 keys, every call.
+  ASSERT_EQ(db.performEvictions(), rd::EvictResult::kRunning);
+  ASSERT_EQ(db.size(), 2000 - 16);
+  int calls = 1;
+  while (db.performEvictions() == rd::EvictResult::kRunning) { calls++; }
+  ASSERT_GT(calls, 10);
+  ASSERT_LE(rd::usedMemory(), db.maxmemory().maxmemory);
+}
@@ -0,0 +1,85 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <gmock/gmock.h>
+#include "redis.h"
+#include "db-helpers.h"
+
+namespace {
+// n keys, the even ones already expired and the odd ones without a TTL.
+void fillHalfExpired(rd::Db &db, int n) {
+  fill(db, n, 8);
+  long long past = rd::mstime() - 1000;
+  for (int i = 0; i < n; i += 2) { db.setExpire(keyOf(i).view(), past); }
+}
+}  // namespace
+
+TEST(expire, lazy) {
+  rd::Db db;
+  db.set(rd::StringView("gone"), rd::Object::createString("a"));
+  db.set(rd::StringView("later"), rd::Object::createString("b"));
+  db.setExpire(rd::StringView("gone"), rd::mstime() - 1);
+  db.setExpire(rd::StringView("later"), rd::mstime() + 100000);
+  ASSERT_THAT(db.lookup(rd::StringView("gone")), nullptr);
+  ASSERT_NE(db.lookup(rd::StringView("later")), nullptr);
+  ASSERT_EQ(db.size(), 1);
+  ASSERT_EQ(db.expires().size(), 1);
+  ASSERT_EQ(db.expireStats().expired_keys, 1);
+  ASSERT_FALSE(db.expireIfNeeded(rd::StringView("later")));
+}
+
+TEST(expire, active) {
+  rd::Db db;
+  fillHalfExpired(db, 20000);
+  size_t buckets = db.expires().buckets();
+  int cycles = 0;
+  while (!db.expires().empty()) {
+    db.activeExpireCycle(rd::ExpireCycle::kSlow);
+    ASSERT_LT(++cycles, 1000);
+  }
+  ASSERT_EQ(db.size(), 10000);
+  for (int i = 1; i < 20000; i += 2) {
+    ASSERT_NE(db.lookup(keyOf(i).view()), nullptr);
+  }
+  const rd::ExpireStats &stats = db.expireStats();
+  ASSERT_EQ(stats.expired_keys, 10000);
+  ASSERT_GE(stats.sampled_keys, 10000);
+  ASSERT_EQ(stats.cycles, cycles);
+  ASSERT_GT(stats.stale_perc, 0);
+  // The emptied expires was shrunk.
+  for (int i = 0; i < 100; i++) {
+    db.activeExpireCycle(rd::ExpireCycle::kSlow);
+  }
+  ASSERT_LT(db.expires().buckets(), buckets);
+  // Nothing stale is left, so fast cycles are skipped.
+  rd::size_type before = stats.cycles;
+  for (int i = 0; i < 200; i++) {
+    db.activeExpireCycle(rd::ExpireCycle::kFast);
+  }
+  ASSERT_LT(stats.stale_perc, 10);
+  ASSERT_EQ(stats.cycles, before);
+}
+
+TEST(expire, budget) {
+  rd::Db db;
+  fillHalfExpired(db, 200000);
+  rd::ExpireConfig config;
+  // A 25 ms slow cycle is too short for 100000 keys.
+  config.hz = 10;
+  db.setExpireConfig(config);
+  db.activeExpireCycle(rd::ExpireCycle::kSlow);
+  const rd::ExpireStats &stats = db.expireStats();
+  ASSERT_EQ(stats.time_cap_reached, 1);
+  ASSERT_GT(stats.expired_keys, 0);
+  ASSERT_LT(stats.expired_keys, 100000);
+  // The timed-out cycle makes the next fast cycle run, for about 1 ms.
+  rd::size_type expired = stats.expired_keys;
+  db.activeExpireCycle(rd::ExpireCycle::kFast);
+  ASSERT_EQ(stats.cycles, 2);
+  ASSERT_GT(stats.expired_keys, expired);
+  while (!db.expires().empty()) {
+    db.activeExpireCycle(rd::ExpireCycle::kSlow);
+  }
+  ASSERT_EQ(db.size(), 100000);
+}
@@ -0,0 +1,71 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <set>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+namespace {
+const uint8_t kKey[16] = {0, 1, 2, 3, 4, 5, 6, 7,
+                          8, 9, 10, 11, 12, 13, 14, 15};
+}
+
+TEST(hash, siphash24vector) {
+  // The reference vector from the SipHash paper: key 00..0f and the
+  // 15-byte message 00..0e.
+  uint8_t msg[15];
+  for (uint8_t i = 0; i < 15; i++) { msg[i] = i; }
+  ASSERT_EQ((rd::sipHash<2, 4>(msg, sizeof(msg), kKey)),
+            0xa129ca6149be45e5ull);
+}
+
+TEST(hash, seed) {
+  uint8_t saved[16];
+  memcpy(saved, rd::hashSeed(), sizeof(saved));
+  rd::String key("user:1000");
+  rd::setHashSeed(kKey);
+  size_t sip = std::hash<rd::String>()(key);
+  size_t wy = rd::StringHasher<rd::WyHash>()(key);
+  ASSERT_EQ(sip, (rd::sipHash<1, 2>(key.data(), key.size(), kKey)));
+  uint8_t other[16] = {1};
+  rd::setHashSeed(other);
+  ASSERT_NE(std::hash<rd::String>()(key), sip);
+  ASSERT_NE(rd::StringHasher<rd::WyHash>()(key), wy);
+  rd::setHashSeed(kKey);
+  ASSERT_EQ(std::hash<rd::String>()(key), sip);
+  ASSERT_EQ(rd::StringHasher<rd::WyHash>()(key), wy);
+  rd::setHashSeed(saved);
+}
+
+TEST(hash, lengths) {
+  // Every length up to a few blocks, and every single-byte change,
+  // must lead to a different hash in both families.
+  std::set<uint64_t> sip, wy;
+  std::string raw(130, 'a');
+  for (size_t len = 0; len <= raw.size(); len++) {
+    sip.insert(rd::SipHash12::hash(raw.data(), len));
+    wy.insert(rd::WyHash::hash(raw.data(), len));
+  }
+  for (size_t i = 0; i < raw.size(); i++) {
+    raw[i] = 'b';
+    sip.insert(rd::SipHash12::hash(raw.data(), raw.size()));
+    wy.insert(rd::WyHash::hash(raw.data(), raw.size()));
+    raw[i] = 'a';
+  }
+  ASSERT_EQ(sip.size(), 2 * raw.size() + 1);
+  ASSERT_EQ(wy.size(), 2 * raw.size() + 1);
+}
+
+TEST(hash, hashedstring) {
+  rd::HashedString s1("counter:1"), s2("counter:1"), s3("counter:2");
+  ASSERT_FALSE(s1.hashed());
+  ASSERT_EQ(std::hash<rd::HashedString>()(s1),
+            std::hash<rd::String>()(s1.str()));
+  ASSERT_TRUE(s1.hashed());
+  ASSERT_TRUE(s1 == s2);
+  s2.hash();
+  s3.hash();
+  ASSERT_TRUE(s1 == s2);
+  ASSERT_TRUE(s1 != s3);
+}
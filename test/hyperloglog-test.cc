@@ -0,0 +1,116 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <gmock/gmock.h>
+#include "redis.h"
+#include "simd-levels.h"
+
+namespace {
+void addRange(rd::String &hll, size_t from, size_t to) {
+  for (size_t i = from; i < to; i++) {
+    std::string element = "element:" + std::to_string(i);
+    ASSERT_GE(rd::pfAdd(hll, {element.c_str()}), 0);
+  }
+}
+
+uint64_t count(rd::String &hll) {
+  uint64_t card = 0;
+  EXPECT_TRUE(rd::pfCount(hll, &card));
+  return card;
+}
+
+// The union path merges raw registers, independently of the encoding.
+uint64_t countMerged(const rd::String &hll) {
+  uint64_t card = 0;
+  rd::String empty;
+  EXPECT_TRUE(rd::pfCount({hll, empty}, &card));
+  return card;
+}
+}
+
+TEST(hyperloglog, add) {
+  rd::String hll;
+  ASSERT_EQ(rd::pfAdd(hll, {}), 1);
+  ASSERT_EQ(rd::hllEncoding(hll), rd::HllEncoding::kSparse);
+  ASSERT_EQ(count(hll), 0);
+  ASSERT_EQ(rd::pfAdd(hll, {"a", "b", "c"}), 1);
+  ASSERT_EQ(rd::pfAdd(hll, {"a", "b", "c"}), 0);
+  ASSERT_EQ(count(hll), 3);
+  ASSERT_EQ(rd::pfAdd(hll, {"d"}), 1);
+  ASSERT_EQ(count(hll), 4);
+}
+
+TEST(hyperloglog, accuracy) {
+  rd::String hll;
+  size_t added = 0;
+  for (size_t n : {10, 100, 1000, 10000, 100000, 300000}) {
+    addRange(hll, added, n);
+    added = n;
+    double error = std::fabs(static_cast<double>(count(hll)) - n) / n;
+    // 0.81% standard error; 5% is over six sigma.
+    ASSERT_LT(error, 0.05) << n;
+    ASSERT_EQ(countMerged(hll), count(hll)) << n;
+  }
+  ASSERT_EQ(rd::hllEncoding(hll), rd::HllEncoding::kDense);
+  ASSERT_EQ(hll.size(), rd::kHllDenseSize);
+}
+
+TEST(hyperloglog, sparse) {
+  rd::String hll;
+  for (size_t i = 0; i < 5000; i += 50) {
+    addRange(hll, i, i + 50);
+    if (rd::hllEncoding(hll) != rd::HllEncoding::kSparse) { break; }
+    ASSERT_LE(hll.size(), rd::kHllSparseMaxBytes);
+    ASSERT_EQ(countMerged(hll), count(hll)) << i;
+  }
+  // Sparse counters promote once they outgrow kHllSparseMaxBytes.
+  ASSERT_EQ(rd::hllEncoding(hll), rd::HllEncoding::kDense);
+}
+
+TEST(hyperloglog, merge) {
+  forEachSimdLevel([] {
+    for (size_t n : {100, 20000}) {
+      rd::String a, b, both, merged;
+      addRange(a, 0, n);
+      addRange(b, n / 2, n * 2);
+      addRange(both, 0, n * 2);
+      ASSERT_TRUE(rd::pfMerge(merged, {a, b}));
+      ASSERT_EQ(rd::hllEncoding(merged), rd::hllEncoding(both));
+      ASSERT_EQ(count(merged), count(both));
+      uint64_t card;
+      ASSERT_TRUE(rd::pfCount({a, b}, &card));
+      ASSERT_EQ(card, count(both));
+      // The registers match bit for bit once both are dense.
+      if (rd::hllEncoding(both) == rd::HllEncoding::kDense) {
+        ASSERT_TRUE(rd::StringView(merged).substr(rd::kHllHeaderSize) ==
+                    rd::StringView(both).substr(rd::kHllHeaderSize));
+      }
+      // dest takes part in the union and may be one of the sources.
+      ASSERT_TRUE(rd::pfMerge(a, {a, b}));
+      ASSERT_EQ(count(a), count(both));
+    }
+  });
+}
+
+TEST(hyperloglog, invalid) {
+  rd::String text("not a counter"), hll;
+  rd::pfAdd(hll, {"x"});
+  uint64_t card;
+  ASSERT_EQ(rd::hllEncoding(text), rd::HllEncoding::kInvalid);
+  ASSERT_EQ(rd::pfAdd(text, {"x"}), -1);
+  ASSERT_FALSE(rd::pfCount(text, &card));
+  ASSERT_FALSE(rd::pfCount({hll, text}, &card));
+  rd::String dest(hll);
+  ASSERT_FALSE(rd::pfMerge(dest, {text}));
+  ASSERT_TRUE(dest == hll);
+  ASSERT_STREQ(text.data(), "not a counter");
+  // A dense header with a truncated body is rejected as well.
+  rd::String big;
+  addRange(big, 0, 20000);
+  rd::String truncated = big.substr(0, rd::kHllDenseSize - 1);
+  ASSERT_EQ(rd::hllEncoding(truncated), rd::HllEncoding::kInvalid);
+}
@@ -0,0 +1,208 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include <gmock/gmock.h>
+#include "redis.h"
+#include "simd-levels.h"
+
+using namespace testing;
+
+namespace {
+// n values drawn from [lo, lo + range), with duplicates.
+std::vector<long long> randomValues(size_t n, long long lo, long long range,
+                                    std::mt19937_64 *gen) {
+  std::vector<long long> values(n);
+  for (auto &v : values) {
+    v = lo + static_cast<long long>((*gen)() % range);
+  }
+  return values;
+}
+
+std::vector<long long> elements(const rd::IntSet &is) {
+  std::vector<long long> values;
+  for (rd::size_type i = 0; i < is.size(); i++) {
+    values.push_back(is.get(i));
+  }
+  return values;
+}
+}  // namespace
+
+TEST(intset, add) {
+  rd::IntSet is;
+  ASSERT_TRUE(is.empty());
+  for (long long v : {5, 1, 3, -2, 3, 5}) { is.add(v); }
+  ASSERT_EQ(is.size(), 4);
+  ASSERT_EQ(is.encoding(), rd::IntSet::kEncInt16);
+  ASSERT_EQ(is.bytes(), 8 + 4 * 2);
+  std::vector<long long> values;
+  for (rd::size_type i = 0; i < is.size(); i++) {
+    values.push_back(is.get(i));
+  }
+  ASSERT_THAT(values, ElementsAre(-2, 1, 3, 5));
+  ASSERT_FALSE(is.add(3));
+  ASSERT_TRUE(is.contains(-2));
+  ASSERT_FALSE(is.contains(2));
+  ASSERT_FALSE(is.contains(1LL << 40));
+}
+
+TEST(intset, upgrade) {
+  rd::IntSet is;
+  for (int i = 0; i < 10; i++) { is.add(i); }
+  ASSERT_TRUE(is.add(100000));
+  ASSERT_EQ(is.encoding(), rd::IntSet::kEncInt32);
+  ASSERT_TRUE(is.add(-(1LL << 40)));
+  ASSERT_EQ(is.encoding(), rd::IntSet::kEncInt64);
+  ASSERT_EQ(is.size(), 12);
+  ASSERT_EQ(is.get(0), -(1LL << 40));
+  ASSERT_EQ(is.get(11), 100000);
+  for (int i = 0; i < 10; i++) { ASSERT_EQ(is.get(i + 1), i); }
+  // Removals keep the encoding.
+  ASSERT_TRUE(is.remove(-(1LL << 40)));
+  ASSERT_TRUE(is.remove(100000));
+  ASSERT_FALSE(is.remove(100000));
+  ASSERT_EQ(is.encoding(), rd::IntSet::kEncInt64);
+  ASSERT_EQ(is.size(), 10);
+  ASSERT_EQ(is.bytes(), 8 + 10 * 8);
+}
+
+TEST(intset, random) {
+  rd::IntSet is;
+  std::set<long long> expected;
+  for (int i = 0; i < 5000; i++) {
+    long long v = static_cast<long long>(rd::random64() % 2000) - 1000;
+    if (i % 1000 == 999) { v *= 1LL << 33; }
+    ASSERT_EQ(is.add(v), expected.insert(v).second);
+    long long r = static_cast<long long>(rd::random64() % 2000) - 1000;
+    if (i % 3 == 0) { ASSERT_EQ(is.remove(r), expected.erase(r) == 1); }
+  }
+  ASSERT_EQ(is.size(), expected.size());
+  rd::size_type i = 0;
+  for (long long v : expected) {
+    ASSERT_EQ(is.get(i++), v);
+    ASSERT_TRUE(is.contains(v));
+  }
+}
+
+TEST(intset, memory) {
+  size_t base = rd::usedMemory();
+  {
+    rd::IntSet is;
+    for (int i = 0; i < 100; i++) { is.add(i * 1000); }
+    ASSERT_EQ(rd::usedMemory(), base + is.bytes());
+  }
+  ASSERT_EQ(rd::usedMemory(), base);
+}
+
+TEST(intset, build) {
+  long long values[] = {7, -3, 7, 40000, -3, 0};
+  rd::IntSet is(values, 6);
+  ASSERT_THAT(elements(is), ElementsAre(-3, 0, 7, 40000));
+  ASSERT_EQ(is.encoding(), rd::IntSet::kEncInt32);
+  ASSERT_EQ(is.bytes(), 8 + 4 * 4);
+  rd::IntSet empty(values, 0);
+  ASSERT_TRUE(empty.empty());
+  ASSERT_EQ(empty.encoding(), rd::IntSet::kEncInt16);
+}
+
+TEST(intset, search) {
+  // Long enough for the binary search to hand over to the rank kernel at
+  // every width.
+  std::mt19937_64 gen(7);
+  for (long long scale : {1LL, 1000LL, 1LL << 36}) {
+    auto values = randomValues(3000, -3000 * scale, 6000 * scale, &gen);
+    for (auto &v : values) { v -= v % scale; }
+    rd::IntSet is(values.data(), values.size());
+    std::set<long long> expected(values.begin(), values.end());
+    forEachSimdLevel([&] {
+      for (long long v = -3000 * scale; v < 3000 * scale; v += scale) {
+        ASSERT_EQ(is.contains(v), expected.count(v) == 1);
+        if (scale > 1) { ASSERT_FALSE(is.contains(v + scale / 2)); }
+      }
+    });
+  }
+}
+
+TEST(intset, algebra) {
+  std::mt19937_64 gen(11);
+  struct Case {
+    size_t na, nb;
+    long long lo_a, lo_b, range;
+  };
+  // Similar and skewed sizes, across and within encodings; ranges are
+  // about twice the sizes, so that half or so of the elements are shared.
+  std::vector<Case> cases = {
+      {0, 100, 0, 0, 200}, {3, 10, 0, 0, 20}, {1000, 1000, -1000, -1000, 2000},
+      {1000, 1200, 0, 200, 2500}, {50, 20000, 0, 0, 30000},
+      {20000, 50, 0, 0, 30000}, {3000, 3000, 0, 0, 200000},
+      {3000, 3000, 1LL << 40, 1LL << 40, 6000},
+      {2000, 2000, 0, 0, 4000}, {500, 30000, 0, 0, 40000},
+  };
+  forEachSimdLevel([&] {
+    for (const Case &c : cases) {
+      auto va = randomValues(c.na, c.lo_a, c.range, &gen);
+      auto vb = randomValues(c.nb, c.lo_b, c.range, &gen);
+      // A few wide elements, to mix encodings.
+      if (c.na % 3 == 1) { va.push_back(1LL << 50); }
+      rd::IntSet a(va.data(), va.size()), b(vb.data(), vb.size());
+      std::set<long long> sa(va.begin(), va.end()), sb(vb.begin(), vb.end());
+      std::vector<long long> inter, uni, diff_ab, diff_ba;
+      std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                            std::back_inserter(inter));
+      std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                     std::back_inserter(uni));
+      std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(),
+                          std::back_inserter(diff_ab));
+      std::set_difference(sb.begin(), sb.end(), sa.begin(), sa.end(),
+                          std::back_inserter(diff_ba));
+      ASSERT_EQ(elements(rd::IntSet::intersect(a, b)), inter);
+      ASSERT_EQ(elements(rd::IntSet::intersect(b, a)), inter);
+      // Every element matches: the vector kernels run out of room to
+      // store whole vectors.
+      ASSERT_EQ(elements(rd::IntSet::intersect(a, a)), elements(a));
+      ASSERT_EQ(elements(rd::IntSet::unite(a, b)), uni);
+      ASSERT_EQ(elements(rd::IntSet::unite(b, a)), uni);
+      ASSERT_EQ(elements(rd::IntSet::difference(a, b)), diff_ab);
+      ASSERT_EQ(elements(rd::IntSet::difference(b, a)), diff_ba);
+      ASSERT_EQ(rd::IntSet::intersect(a, b).encoding(),
+                std::min(a.encoding(), b.encoding()));
+      ASSERT_EQ(rd::IntSet::unite(a, b).encoding(),
+                std::max(a.encoding(), b.encoding()));
+      ASSERT_EQ(rd::IntSet::difference(a, b).encoding(), a.encoding());
+    }
+  });
+}
+
+TEST(intset, intersectmany) {
+  std::mt19937_64 gen(13);
+  std::vector<rd::IntSet> sets;
+  std::vector<long long> expected;
+  for (size_t n : {5000, 300, 20000, 1000}) {
+    auto values = randomValues(n, 0, 4000, &gen);
+    sets.emplace_back(values.data(), values.size());
+  }
+  expected = elements(sets[0]);
+  for (size_t i = 1; i < sets.size(); i++) {
+    std::vector<long long> next, cur = elements(sets[i]);
+    std::set_intersection(expected.begin(), expected.end(), cur.begin(),
+                          cur.end(), std::back_inserter(next));
+    expected.swap(next);
+  }
+  ASSERT_FALSE(expected.empty());
+  std::vector<const rd::IntSet *> ptrs;
+  for (const auto &is : sets) { ptrs.push_back(&is); }
+  ASSERT_EQ(elements(rd::IntSet::intersect(ptrs.data(), ptrs.size())),
+            expected);
+  ASSERT_EQ(elements(rd::IntSet::intersect(ptrs.data(), 1)),
+            elements(sets[0]));
+  ASSERT_TRUE(rd::IntSet::intersect(ptrs.data(), 0).empty());
+  rd::IntSet disjoint;
+  disjoint.add(-1);
+  ptrs.push_back(&disjoint);
+  ASSERT_TRUE(rd::IntSet::intersect(ptrs.data(), ptrs.size()).empty());
+}
@@ -0,0 +1,136 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <string>
+#include <vector>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+using namespace testing;
+
+namespace {
+std::string text(const rd::ListPack &lp, rd::size_type p) {
+  char buf[rd::kLongStrSize];
+  rd::StringView view = lp.get(p).view(buf);
+  return std::string(view.data(), view.size());
+}
+
+std::vector<std::string> forward(const rd::ListPack &lp) {
+  std::vector<std::string> out;
+  for (auto p = lp.first(); p != rd::ListPack::npos; p = lp.next(p)) {
+    out.push_back(text(lp, p));
+  }
+  return out;
+}
+
+std::vector<std::string> backward(const rd::ListPack &lp) {
+  std::vector<std::string> out;
+  for (auto p = lp.last(); p != rd::ListPack::npos; p = lp.prev(p)) {
+    out.insert(out.begin(), text(lp, p));
+  }
+  return out;
+}
+}  // namespace
+
+TEST(listpack, empty) {
+  rd::ListPack lp;
+  ASSERT_TRUE(lp.empty());
+  ASSERT_EQ(lp.size(), 0);
+  ASSERT_EQ(lp.bytes(), rd::ListPack::kHeaderSize + 1);
+  ASSERT_EQ(lp.first(), rd::ListPack::npos);
+  ASSERT_EQ(lp.last(), rd::ListPack::npos);
+  ASSERT_EQ(lp.seek(0), rd::ListPack::npos);
+}
+
+TEST(listpack, encodings) {
+  // Every integer width, both signs, and every string length class,
+  // whose lengths also need backlens of 1 to 3 bytes.
+  std::vector<std::string> values = {
+      "0", "127", "128", "-1", "4095", "-4096", "4096", "32767", "-32768",
+      "8388607", "-8388608", "2147483647", "-2147483648",
+      "9223372036854775807", "-9223372036854775808",
+      "", "a", "007", "-0", "1.5", std::string(63, 'x'),
+      std::string(64, 'y'), std::string(4095, 'z'), std::string(4096, 'w'),
+      std::string(20000, 'v')};
+  rd::ListPack lp;
+  for (const std::string &v : values) {
+    lp.append(rd::StringView(v.data(), v.size()));
+  }
+  ASSERT_EQ(lp.size(), values.size());
+  ASSERT_EQ(forward(lp), values);
+  ASSERT_EQ(backward(lp), values);
+  // Canonical integers come back as integers, the rest as strings.
+  ASSERT_EQ(lp.get(lp.seek(13)).sval, nullptr);
+  ASSERT_EQ(lp.get(lp.seek(13)).lval, INT64_MAX);
+  ASSERT_EQ(lp.get(lp.seek(14)).lval, INT64_MIN);
+  ASSERT_NE(lp.get(lp.seek(17)).sval, nullptr);
+  ASSERT_NE(lp.get(lp.seek(18)).sval, nullptr);
+  ASSERT_EQ(text(lp, lp.seek(-1)), values.back());
+  ASSERT_EQ(text(lp, lp.seek(-3)), values[values.size() - 3]);
+  ASSERT_EQ(lp.seek(100), rd::ListPack::npos);
+  ASSERT_EQ(lp.seek(-100), rd::ListPack::npos);
+}
+
+TEST(listpack, compact) {
+  // One byte of data plus one of backlen for small integers.
+  rd::ListPack lp;
+  for (int i = 0; i < 100; i++) { lp.append(i); }
+  ASSERT_EQ(lp.bytes(), rd::ListPack::kHeaderSize + 1 + 200);
+}
+
+TEST(listpack, modify) {
+  rd::ListPack lp;
+  lp.append("b");
+  lp.append("d");
+  auto p = lp.insert(lp.first(), "a");
+  ASSERT_EQ(p, lp.first());
+  lp.insert(lp.seek(2), "c");
+  lp.insert(rd::ListPack::npos, 5);
+  ASSERT_THAT(forward(lp), ElementsAre("a", "b", "c", "d", "5"));
+  lp.replace(lp.seek(1), std::string(300, 'B').c_str());
+  lp.replace(lp.seek(2), -70000);
+  ASSERT_THAT(forward(lp),
+              ElementsAre("a", std::string(300, 'B'), "-70000", "d", "5"));
+  ASSERT_EQ(backward(lp), forward(lp));
+  p = lp.remove(lp.seek(1));
+  ASSERT_EQ(text(lp, p), "-70000");
+  ASSERT_EQ(lp.remove(lp.last()), rd::ListPack::npos);
+  ASSERT_THAT(forward(lp), ElementsAre("a", "-70000", "d"));
+  ASSERT_EQ(lp.size(), 3);
+}
+
+TEST(listpack, find) {
+  rd::ListPack lp;
+  for (const char *s : {"f1", "v1", "12", "f1", "f3", "12"}) { lp.append(s); }
+  ASSERT_EQ(lp.find(lp.first(), "f1"), lp.seek(0));
+  // With a skip of 1 only fields are compared: "f1" at index 3 is a
+  // value, and so is the integer 12 at index 5.
+  ASSERT_EQ(lp.find(lp.first(), "12", 1), lp.seek(2));
+  ASSERT_EQ(lp.find(lp.next(lp.first()), "f1"), lp.seek(3));
+  ASSERT_EQ(lp.find(lp.first(), "f3", 1), lp.seek(4));
+  ASSERT_EQ(lp.find(lp.first(), "v1", 1), rd::ListPack::npos);
+  ASSERT_EQ(lp.find(lp.first(), "012"), rd::ListPack::npos);
+}
+
+TEST(listpack, count) {
+  // The 16-bit count saturates, and comes back once it fits again.
+  rd::ListPack lp;
+  const int n = 70000;
+  for (int i = 0; i < n; i++) { lp.append(1); }
+  ASSERT_EQ(lp.size(), n);
+  for (int i = 0; i < n - 10; i++) { lp.remove(lp.first()); }
+  ASSERT_EQ(lp.size(), 10);
+}
+
+TEST(listpack, memory) {
+  size_t base = rd::usedMemory();
+  {
+    rd::ListPack lp;
+    lp.append("hello");
+    ASSERT_EQ(rd::usedMemory(), base + lp.bytes());
+    rd::ListPack moved = std::move(lp);
+    ASSERT_EQ(rd::usedMemory(), base + moved.bytes());
+  }
+  ASSERT_EQ(rd::usedMemory(), base);
+}
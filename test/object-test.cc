@@ -0,0 +1,132 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <climits>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+TEST(object, encoding) {
+  rd::Object *raw = rd::Object::createString("hello");
+  ASSERT_EQ(raw->encoding(), rd::Object::kEncodingRaw);
+  ASSERT_STREQ(raw->toString().data(), "hello");
+  raw->decrRef();
+
+  rd::Object *num = rd::Object::createString("-12345");
+  ASSERT_EQ(num->encoding(), rd::Object::kEncodingInt);
+  ASSERT_FALSE(num->isShared());
+  ASSERT_STREQ(num->toString().data(), "-12345");
+  ASSERT_EQ(num->length(), 6);
+  num->decrRef();
+
+  // Texts that would not round-trip stay raw.
+  rd::Object *padded = rd::Object::createString(rd::String("0042"));
+  ASSERT_EQ(padded->encoding(), rd::Object::kEncodingRaw);
+  padded->decrRef();
+}
+
+TEST(object, shared) {
+  rd::Object *a = rd::Object::createString("42");
+  rd::Object *b = rd::Object::createInt(42);
+  ASSERT_EQ(a, b);
+  ASSERT_TRUE(a->isShared());
+  a->incrRef();
+  a->decrRef();
+  a->decrRef();
+  ASSERT_EQ(b->refCount(), rd::Object::kSharedRefCount);
+  rd::Object *big = rd::Object::createInt(rd::Object::kSharedIntegers);
+  ASSERT_FALSE(big->isShared());
+  big->decrRef();
+}
+
+TEST(object, incrby) {
+  rd::Object *obj = rd::Object::createInt(9998);
+  ASSERT_TRUE(obj->isShared());
+  ASSERT_TRUE(rd::Object::incrBy(obj, 1));
+  ASSERT_TRUE(obj->isShared());
+  ASSERT_TRUE(rd::Object::incrBy(obj, 1));
+  ASSERT_FALSE(obj->isShared());
+  rd::Object *owned = obj;
+  ASSERT_TRUE(rd::Object::incrBy(obj, 100));
+  ASSERT_EQ(obj, owned);
+  long long value;
+  ASSERT_TRUE(obj->getLongLong(&value));
+  ASSERT_EQ(value, 10100);
+  // Back in the pool's range, an unshared object stays unshared.
+  ASSERT_TRUE(rd::Object::incrBy(obj, -10100));
+  ASSERT_EQ(obj, owned);
+  ASSERT_STREQ(obj->toString().data(), "0");
+  obj->decrRef();
+
+  rd::Object *max = rd::Object::createInt(LLONG_MAX);
+  ASSERT_FALSE(rd::Object::incrBy(max, 1));
+  ASSERT_TRUE(max->getLongLong(&value));
+  ASSERT_EQ(value, LLONG_MAX);
+  max->decrRef();
+
+  rd::Object *text = rd::Object::createString("abc");
+  ASSERT_FALSE(rd::Object::incrBy(text, 1));
+  text->decrRef();
+}
+
+TEST(object, incrbyunshared) {
+  // As Db::set stores integers under LRU/LFU: the result keeps recording
+  // accesses, and its last access is the input's.
+  rd::Object *obj = rd::Object::createInt(5, false);
+  obj->setLru(1234);
+  obj->incrRef();
+  rd::Object *held = obj;
+  ASSERT_TRUE(rd::Object::incrBy(obj, 1));
+  ASSERT_NE(obj, held);
+  ASSERT_FALSE(obj->isShared());
+  ASSERT_STREQ(obj->toString().data(), "6");
+  ASSERT_EQ(obj->lru(), 1234);
+  obj->decrRef();
+  held->decrRef();
+}
+
+TEST(object, lru) {
+  rd::Object *obj = rd::Object::createString("hello");
+  ASSERT_LT(obj->idleMilliseconds(), 2000);
+  uint32_t now = rd::Object::lruClock();
+  obj->setLru(now - 10);
+  ASSERT_GE(obj->idleMilliseconds(), 10000);
+  ASSERT_LT(obj->idleMilliseconds(), 12000);
+  obj->touchLru();
+  ASSERT_LT(obj->idleMilliseconds(), 2000);
+  // Accesses from before the clock wrapped.
+  obj->setLru(now + 5);
+  ASSERT_GT(obj->idleMilliseconds(), 1000000000ull);
+  obj->decrRef();
+}
+
+TEST(object, lfu) {
+  rd::Object *obj = rd::Object::createString("hello");
+  obj->initLfu();
+  ASSERT_EQ(obj->lfuCounter(1), rd::Object::kLfuInitValue);
+  // Close to the init value every access counts, then ever fewer do.
+  for (int i = 0; i < 1000; i++) { obj->touchLfu(10, 1); }
+  uint8_t counter = obj->lfuCounter(1);
+  ASSERT_GT(counter, rd::Object::kLfuInitValue + 5);
+  ASSERT_LT(counter, 40);
+  for (int i = 0; i < 300; i++) { obj->touchLfu(0, 1); }
+  ASSERT_EQ(obj->lfuCounter(1), 255);
+  // Three minutes idle take three off at one per minute.
+  uint32_t minutes = rd::Object::lfuMinutes();
+  obj->setLru(((minutes - 3) & 0xffff) << 8 | 100);
+  ASSERT_EQ(obj->lfuCounter(1), 97);
+  ASSERT_EQ(obj->lfuCounter(2), 99);
+  ASSERT_EQ(obj->lfuCounter(0), 100);
+  obj->setLru(((minutes - 300) & 0xffff) << 8 | 100);
+  ASSERT_EQ(obj->lfuCounter(1), 0);
+  obj->decrRef();
+
+  // Shared objects record nothing.
+  rd::Object *shared = rd::Object::createInt(1);
+  uint32_t lru = shared->lru();
+  shared->touchLfu(10, 1);
+  ASSERT_EQ(shared->lru(), lru);
+  rd::Object *own = rd::Object::createInt(1, false);
+  ASSERT_FALSE(own->isShared());
+  own->decrRef();
+}
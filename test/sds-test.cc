@@ -3,7 +3,9 @@
 //
 
 #include "redis.h"
+#include <unistd.h>
 #include <gmock/gmock.h>
+#include "simd-levels.h"
 
 const char *ptr = "what";
 const char *secondPtr = "ip";
@@ -21,7 +23,7 @@ TEST(sds, sdsnew) {
 
 TEST(sds, sdsempty) {
   rd::String s2;
-  ASSERT_STREQ(s2.begin(), nullptr);
+  ASSERT_STREQ(s2.begin(), "");
   testing::internal::CaptureStdout();
   std::cout << s2;
   ASSERT_STREQ("", testing::internal::GetCapturedStdout().c_str());
@@ -30,7 +32,7 @@ TEST(sds, sdsempty) {
 TEST(sds, sdsfree) {
   rd::String s1(ptr);
   s1.~String();
-  ASSERT_STREQ(s1.begin(), nullptr);
+  ASSERT_STREQ(s1.begin(), "");
   testing::internal::CaptureStdout();
   std::cout << s1;
   ASSERT_STREQ("", testing::internal::GetCapturedStdout().c_str());
@@ -45,17 +47,22 @@ TEST(sds, sdslen) {
 
 TEST(sds, sdsavail) {
   rd::String s1(ptr);
-  ASSERT_EQ(s1.capacity(), 4);
+  ASSERT_EQ(s1.capacity(), rd::String::kInlineCapacity);
   s1 += secondPtr;
-  ASSERT_EQ(s1.capacity(), 8);
+  ASSERT_EQ(s1.capacity(), rd::String::kInlineCapacity);
   s1 += thirdPtr;
-  ASSERT_EQ(s1.capacity(), 21);
+  ASSERT_EQ(s1.capacity(), 2 * rd::String::kInlineCapacity);
+  s1 += thirdPtr;
+  ASSERT_EQ(s1.size(), 32);
+  ASSERT_EQ(s1.capacity(), 4 * rd::String::kInlineCapacity);
+  s1 += s1;
+  ASSERT_EQ(s1.capacity(), 8 * rd::String::kInlineCapacity);
 }
 
 TEST(sds, sdsdmp) {
   rd::String s1(ptr), s2(secondPtr), s3(thirdPtr);
   s1 = s2;
-  ASSERT_EQ(s1.capacity(), 4);
+  ASSERT_EQ(s1.capacity(), rd::String::kInlineCapacity);
   ASSERT_EQ(s1.size(), 2);
   ASSERT_STREQ(s1.begin(), secondPtr);
 
@@ -86,7 +93,15 @@ TEST(sds, sdsgrowzero) {
   rd::String s1(ptr);
   s1.resize(10);
   ASSERT_STREQ(s1.begin(), ptr);
-  ASSERT_EQ(s1.capacity(), 10);
+  ASSERT_EQ(s1.size(), 10);
+  ASSERT_EQ(s1.capacity(), rd::String::kInlineCapacity);
+  s1.resize(30);
+  ASSERT_EQ(s1.size(), 30);
+  ASSERT_FALSE(s1.isInline());
+  ASSERT_EQ(s1.begin()[29], 0);
+  s1.resize(2);
+  ASSERT_STREQ(s1.begin(), "wh");
+  ASSERT_TRUE(s1.isInline());
 }
 
 TEST(sds, sdsrange) {
@@ -107,4 +122,240 @@ TEST(sds, sdscmp) {
   rd::String s1(ptr), s2(ptr), s3(secondPtr);
   ASSERT_TRUE(s1 == s2);
   ASSERT_TRUE(s1 != s3);
-}
\ No newline at end of file
+}
+TEST(sds, sdsinline) {
+  ASSERT_EQ(sizeof(rd::String), 2 * sizeof(void *));
+  std::string boundary(rd::String::kInlineCapacity, 'x');
+  rd::String s1(boundary.c_str());
+  ASSERT_TRUE(s1.isInline());
+  ASSERT_EQ(s1.size(), rd::String::kInlineCapacity);
+  ASSERT_STREQ(s1.data(), boundary.c_str());
+  ASSERT_GE(s1.data(), reinterpret_cast<const char *>(&s1));
+  ASSERT_LT(s1.data(), reinterpret_cast<const char *>(&s1 + 1));
+  s1 += "y";
+  ASSERT_FALSE(s1.isInline());
+  ASSERT_STREQ(s1.data(), (boundary + "y").c_str());
+  rd::String s2(s1);
+  ASSERT_FALSE(s2.isInline());
+  ASSERT_TRUE(s1 == s2);
+  s2 = ptr;
+  ASSERT_TRUE(s2.isInline());
+  ASSERT_STREQ(s2.data(), ptr);
+  s1.assign(s1.begin() + 1, s1.end());
+  ASSERT_TRUE(s1.isInline());
+  ASSERT_EQ(s1.size(), rd::String::kInlineCapacity);
+}
+
+TEST(sds, sdstrimspill) {
+  rd::String s1("                        what                    ");
+  ASSERT_FALSE(s1.isInline());
+  s1.trim(" ");
+  ASSERT_TRUE(s1.isInline());
+  ASSERT_STREQ(s1.data(), ptr);
+}
+
+TEST(sds, sdsmove) {
+  rd::String s1(thirdPtr), s2(std::string(40, 'x').c_str());
+  rd::String s3(std::move(s1));
+  ASSERT_STREQ(s3.data(), thirdPtr);
+  ASSERT_TRUE(s1.empty());
+  const char *buffer = s2.data();
+  rd::String s4(std::move(s2));
+  ASSERT_EQ(s4.data(), buffer);
+  ASSERT_TRUE(s2.isInline());
+  s3 = std::move(s4);
+  ASSERT_EQ(s3.data(), buffer);
+  ASSERT_TRUE(s4.empty());
+  s3.swap(s4);
+  ASSERT_EQ(s4.data(), buffer);
+  ASSERT_TRUE(s3.empty());
+}
+
+TEST(sds, sdsconcat) {
+  rd::String s1(thirdPtr), s2(secondPtr);
+  rd::String s3 = rd::concat(s1, " ", s2, " ", s1);
+  ASSERT_STREQ(s3.data(), "what the fuck ip what the fuck");
+  ASSERT_EQ(s3.capacity(), s3.size());
+
+  rd::String s4 = s1 + s2 + s1;
+  ASSERT_FALSE(s4.isInline());
+  const char *buffer = s4.data();
+  rd::String s5 = std::move(s4) + s2;
+  ASSERT_EQ(s5.data(), buffer);
+  ASSERT_STREQ(s5.data(), "what the fuckipwhat the fuckip");
+  ASSERT_STREQ((ptr + s2).data(), firstAndSecondPtr);
+  ASSERT_STREQ((rd::String(ptr) + secondPtr).data(), firstAndSecondPtr);
+}
+
+TEST(sds, sdsheader) {
+  // Crossing 255 and 65535 bytes of capacity switches to a wider header.
+  rd::String s1(std::string(200, 'a').c_str());
+  ASSERT_EQ(s1.capacity(), 200);
+  s1 += std::string(100, 'b').c_str();
+  ASSERT_EQ(s1.size(), 300);
+  ASSERT_EQ(s1.capacity(), 400);
+  ASSERT_EQ(s1.data()[199], 'a');
+  ASSERT_EQ(s1.data()[200], 'b');
+  s1.resize(70000);
+  ASSERT_EQ(s1.size(), 70000);
+  ASSERT_GE(s1.capacity(), 70000);
+  ASSERT_EQ(s1.data()[299], 'b');
+  ASSERT_EQ(s1.data()[69999], 0);
+  rd::String s2(s1);
+  ASSERT_TRUE(s1 == s2);
+  s2.resize(300);
+  ASSERT_EQ(s2.size(), 300);
+  ASSERT_TRUE(s2 == s1.substr(0, 300));
+}
+
+TEST(sds, sdsreserve) {
+  rd::String s1(ptr);
+  s1.reserve(100);
+  ASSERT_EQ(s1.capacity(), 100);
+  ASSERT_STREQ(s1.data(), ptr);
+  s1.shrinkToFit();
+  ASSERT_TRUE(s1.isInline());
+  ASSERT_STREQ(s1.data(), ptr);
+  s1.assign(std::string(40, 'x').c_str());
+  s1.reserve(300);
+  s1.shrinkToFit();
+  ASSERT_EQ(s1.capacity(), 40);
+  ASSERT_EQ(s1.size(), 40);
+}
+
+TEST(sds, sdsincrlen) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_EQ(write(fds[1], thirdPtr, strlen(thirdPtr)), strlen(thirdPtr));
+  rd::String s1(ptr);
+  char *room = s1.makeRoomFor(64);
+  ASSERT_EQ(room, s1.end());
+  ASSERT_GE(s1.capacity() - s1.size(), 64);
+  ssize_t nread = read(fds[0], room, 64);
+  ASSERT_EQ(nread, strlen(thirdPtr));
+  s1.incrLen(nread);
+  ASSERT_STREQ(s1.data(), "whatwhat the fuck");
+  s1.incrLen(-9);
+  ASSERT_STREQ(s1.data(), "whatwhat");
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(sds, sdsmaxprealloc) {
+  rd::String s1;
+  s1.reserve(rd::String::kMaxPrealloc);
+  s1.resize(rd::String::kMaxPrealloc);
+  ASSERT_EQ(s1.capacity(), rd::String::kMaxPrealloc);
+  s1 += ptr;
+  ASSERT_EQ(s1.capacity(), 2 * rd::String::kMaxPrealloc + 4);
+  s1 += ptr;
+  ASSERT_EQ(s1.capacity(), 2 * rd::String::kMaxPrealloc + 4);
+}
+
+TEST(sds, sdssimdcmp) {
+  forEachSimdLevel([] {
+    for (size_t len : {0, 1, 15, 16, 17, 31, 32, 33, 100}) {
+      std::string raw(len, 'k');
+      rd::String s1(raw.begin(), raw.end()), s2(s1);
+      ASSERT_TRUE(s1 == s2);
+      for (size_t i = 0; i < len; i++) {
+        s2.begin()[i] = 'j';
+        ASSERT_TRUE(s1 != s2);
+        s2.begin()[i] = 'k';
+      }
+      s2 += "k";
+      ASSERT_TRUE(s1 != s2);
+    }
+    rd::String s3("Hello, World! The Quick Brown Fox"),
+        s4("hello, world! the quick brown fox"),
+        s5("hello, world! the quick brown foy");
+    ASSERT_EQ(s3.caseCompare(s4), 0);
+    ASSERT_LT(s4.caseCompare(s5), 0);
+    ASSERT_GT(s5.caseCompare(s3), 0);
+    ASSERT_LT(rd::String("@").caseCompare(rd::String("a")), 0);
+    ASSERT_GT(rd::String("hello").caseCompare(rd::String("HELL")), 0);
+  });
+}
+
+TEST(sds, sdsfind) {
+  forEachSimdLevel([] {
+    std::string raw;
+    for (int i = 0; i < 200; i++) { raw += static_cast<char>('a' + i % 26); }
+    rd::String s1(raw.begin(), raw.end());
+    ASSERT_EQ(s1.find('c'), 2);
+    ASSERT_EQ(s1.find('c', 3), 28);
+    ASSERT_EQ(s1.find('#'), rd::String::npos);
+    ASSERT_EQ(s1.find("xyzab"), 23);
+    ASSERT_EQ(s1.find("xyzab", 24), 49);
+    ASSERT_EQ(s1.find(rd::String("qrs"), 190), rd::String::npos);
+    ASSERT_EQ(s1.find("ab", 180), 182);
+    ASSERT_EQ(s1.find("xyza"), raw.find("xyza"));
+    ASSERT_EQ(s1.find("mno", 199), rd::String::npos);
+    ASSERT_EQ(s1.find(""), 0);
+    ASSERT_EQ(s1.find("rqp"), rd::String::npos);
+  });
+}
+
+TEST(sds, sdssimdtrim) {
+  forEachSimdLevel([] {
+    std::string pad(40, ' ');
+    rd::String s1((pad + ":a:" + std::string(50, '.') + "b" + pad).c_str());
+    s1.trim(" :");
+    ASSERT_EQ(s1.size(), 53);
+    ASSERT_EQ(s1.data()[0], 'a');
+    ASSERT_EQ(s1.data()[52], 'b');
+    rd::String s2((pad + pad).c_str());
+    s2.trim(" ");
+    ASSERT_TRUE(s2.empty());
+    rd::String s3("xxabcdefghijklmnopqrstuvwxyzxx");
+    s3.trim("xabcdefghijklmnop");
+    ASSERT_STREQ(s3.data(), "qrstuvwxyz");
+  });
+}
+
+TEST(sds, sdsview) {
+  rd::String s1(std::string(20, 'x').c_str());
+  s1 += thirdPtr;
+  rd::StringView v1 = s1.view(20);
+  ASSERT_EQ(v1.data(), s1.data() + 20);
+  ASSERT_TRUE(v1 == thirdPtr);
+  ASSERT_TRUE(v1.substr(9) == "fuck");
+  ASSERT_TRUE(v1.substr(5, 3) == rd::String("the"));
+  ASSERT_EQ(v1.find("the"), 5);
+  ASSERT_EQ(v1.find('f'), 9);
+  ASSERT_TRUE(rd::StringView("abc") < rd::StringView("abd"));
+  ASSERT_TRUE(rd::StringView("ab") < rd::StringView("abc"));
+  rd::StringView v2(ptr);
+  v2.removePrefix(1);
+  v2.removeSuffix(1);
+  ASSERT_TRUE(v2 == "ha");
+  rd::String s2(v1.substr(0, 4));
+  ASSERT_STREQ(s2.data(), ptr);
+  ASSERT_EQ(std::hash<rd::StringView>()(v1),
+            std::hash<rd::String>()(rd::String(v1)));
+  ASSERT_STREQ(rd::concat(v2, "-", s2).data(), "ha-what");
+}
+
+TEST(sds, sdsshared) {
+  rd::SharedString empty;
+  ASSERT_EQ(empty.size(), 0);
+  ASSERT_EQ(empty.useCount(), 0);
+  rd::SharedString s1(rd::String(std::string(64, 'v').c_str()));
+  rd::SharedString s2(s1), s3;
+  s3 = s2;
+  ASSERT_EQ(s1.useCount(), 3);
+  ASSERT_EQ(s1.data(), s3.data());
+  s3.mutate() += "!";
+  ASSERT_EQ(s1.useCount(), 2);
+  ASSERT_EQ(s3.useCount(), 1);
+  ASSERT_EQ(s3.size(), 65);
+  ASSERT_EQ(s1.size(), 64);
+  const char *buffer = s3.data();
+  s3.mutate() += "!";
+  ASSERT_EQ(s3.data(), buffer);
+  rd::SharedString s4(std::move(s2));
+  ASSERT_EQ(s2.useCount(), 0);
+  ASSERT_EQ(s4.useCount(), 2);
+  s1 = rd::SharedString();
+  ASSERT_EQ(s4.useCount(), 1);
+}
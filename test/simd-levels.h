@@ -0,0 +1,21 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#ifndef REDIS_TEST_SIMD_LEVELS_H
+#define REDIS_TEST_SIMD_LEVELS_H
+
+#include "simd.h"
+
+// Runs fn once for every kernel level the CPU supports.
+template<class Fn>
+void forEachSimdLevel(Fn fn) {
+  rd::simd::Level best = rd::simd::level();
+  for (auto level : {rd::simd::Level::kScalar, rd::simd::Level::kSSE2,
+                     rd::simd::Level::kAVX2}) {
+    if (rd::simd::setLevel(level)) { fn(); }
+  }
+  rd::simd::setLevel(best);
+}
+
+#endif //REDIS_TEST_SIMD_LEVELS_H
@@ -0,0 +1,106 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <set>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+namespace {
+// Counts the bytes outstanding upstream.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t bytes = 0;
+  size_t calls = 0;
+
+ private:
+  void *do_allocate(size_t n, size_t align) override {
+    bytes += n;
+    calls++;
+    return std::pmr::new_delete_resource()->allocate(n, align);
+  }
+  void do_deallocate(void *p, size_t n, size_t align) override {
+    bytes -= n;
+    std::pmr::new_delete_resource()->deallocate(p, n, align);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+}
+
+TEST(slab, reuse) {
+  CountingResource upstream;
+  {
+    rd::Slab slab(24, 8, &upstream);
+    ASSERT_EQ(slab.blockSize(), 24);
+    std::set<void *> blocks;
+    for (int i = 0; i < 100; i++) {
+      void *p = slab.allocate();
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % 8, 0);
+      ASSERT_TRUE(blocks.insert(p).second);
+    }
+    ASSERT_EQ(slab.used(), 100);
+    size_t chunks = upstream.calls;
+    // Freed blocks come back before any new chunk is taken.
+    for (void *p : blocks) { slab.deallocate(p); }
+    ASSERT_EQ(slab.used(), 0);
+    for (int i = 0; i < 100; i++) {
+      ASSERT_EQ(blocks.count(slab.allocate()), 1);
+    }
+    ASSERT_EQ(upstream.calls, chunks);
+    ASSERT_FALSE(slab.release());
+  }
+  ASSERT_EQ(upstream.bytes, 0);
+}
+
+TEST(slab, release) {
+  CountingResource upstream;
+  rd::Slab slab(1, 1, &upstream);
+  // Blocks are at least large enough for the free-list link.
+  ASSERT_GE(slab.blockSize(), sizeof(void *));
+  void *p = slab.allocate();
+  ASSERT_GT(upstream.bytes, 0);
+  slab.deallocate(p);
+  ASSERT_TRUE(slab.release());
+  ASSERT_EQ(upstream.bytes, 0);
+  ASSERT_EQ(slab.capacity(), 0);
+  slab.deallocate(slab.allocate());
+  ASSERT_EQ(slab.capacity(), rd::Slab::kMinChunkBlocks);
+}
+
+TEST(slab, dict) {
+  CountingResource upstream;
+  {
+    rd::Dict<rd::String, int> dict(&upstream);
+    ASSERT_EQ(dict.resource(), &upstream);
+    for (int i = 0; i < 10000; i++) {
+      dict.add(rd::String(std::to_string(i).c_str()), i);
+    }
+    ASSERT_GT(upstream.bytes,
+              10000 * sizeof(rd::Dict<rd::String, int>::entry_type));
+    size_t capacity = dict.entryCapacity();
+    for (int i = 0; i < 10000; i++) {
+      dict.remove(rd::String(std::to_string(i).c_str()));
+    }
+    for (int i = 0; i < 10000; i++) {
+      dict.add(rd::String(std::to_string(-i).c_str()), i);
+    }
+    // Churn reuses freed entries instead of growing the slab.
+    ASSERT_EQ(dict.entryCapacity(), capacity);
+    ASSERT_EQ(dict.get(rd::StringView("-9999"))->value, 9999);
+  }
+  ASSERT_EQ(upstream.bytes, 0);
+
+  // A monotonic arena for a bulk load that is dropped as a whole.
+  std::pmr::monotonic_buffer_resource arena(&upstream);
+  {
+    rd::Dict<int, int> ints(&arena);
+    for (int i = 0; i < 10000; i++) { ints.add(i, i); }
+    ints.rehashMilliseconds(100);
+    ASSERT_EQ(ints.get(1234)->value, 1234);
+  }
+  ASSERT_GT(upstream.bytes, 0);
+  arena.release();
+  ASSERT_EQ(upstream.bytes, 0);
+}
@@ -0,0 +1,171 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <set>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+using namespace testing;
+
+TEST(swisstable, basic) {
+  rd::SwissDict<int, int> ints;
+  const int n = 100000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_NE(ints.add(i, -i), ints.end());
+  }
+  ASSERT_EQ(ints.size(), n);
+  ASSERT_EQ(ints.add(5, 0), ints.end());
+  for (int i = 0; i < n; i++) {
+    auto it = ints.get(i);
+    ASSERT_NE(it, nullptr);
+    ASSERT_EQ(it->value, -i);
+  }
+  ASSERT_THAT(ints.get(n), nullptr);
+  for (int i = 0; i < n; i += 3) {
+    ints.replace(i, i);
+  }
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_TRUE(ints.remove(i));
+  }
+  ASSERT_FALSE(ints.remove(0));
+  for (int i = 0; i < n; i++) {
+    auto it = ints.get(i);
+    if (i % 2 == 0) {
+      ASSERT_THAT(it, nullptr);
+    } else {
+      ASSERT_EQ(it->value, i % 3 == 0 ? i : -i);
+    }
+  }
+  ASSERT_EQ(ints.size(), n / 2);
+}
+
+TEST(swisstable, rehash) {
+  rd::SwissDict<int, int> ints;
+  int n = 0;
+  for (; n < 100 || !ints.isRehashing(); n++) { ints.add(n, n); }
+  // Both tables answer lookups while keys move across.
+  for (int i = 0; i < n; i++) { ASSERT_EQ(ints.get(i)->value, i); }
+  rd::size_type count = 0, sum = 0;
+  for (auto &entry : ints) {
+    count++;
+    sum += entry.key;
+  }
+  ASSERT_EQ(count, n);
+  ASSERT_EQ(sum, (n - 1) * n / 2);
+  ints.rehashMilliseconds(100);
+  ASSERT_FALSE(ints.isRehashing());
+  for (int i = 0; i < n; i++) { ASSERT_EQ(ints.get(i)->value, i); }
+}
+
+TEST(swisstable, tombstones) {
+  rd::SwissDict<int, int> ints;
+  // Churn through many keys with few live: tombstones are reclaimed by
+  // rebuilding for twice the live keys instead of growing without bound.
+  for (int i = 0; i < 1000000; i++) {
+    ints.add(i, i);
+    if (i >= 1000) { ASSERT_TRUE(ints.remove(i - 1000)); }
+  }
+  ASSERT_EQ(ints.size(), 1000);
+  ASSERT_LE(ints.capacity(), 8192);
+  for (int i = 999000; i < 1000000; i++) {
+    ASSERT_EQ(ints.get(i)->value, i);
+  }
+  ints.shrink();
+  ints.rehashMilliseconds(100);
+  ASSERT_LE(ints.capacity(), 2048);
+  ASSERT_EQ(ints.size(), 1000);
+}
+
+TEST(swisstable, shrink) {
+  // Small sets, and sizes that exactly fill the smallest fitting table:
+  // the shrink must run to the end and leave every key in place.
+  for (int live : {1, 13, 14, 15, 28, 56, 112, 1000}) {
+    rd::SwissDict<int, int> ints;
+    const int n = live + 30;
+    for (int i = 0; i < n; i++) { ints.add(i, i); }
+    for (int i = live; i < n; i++) { ASSERT_TRUE(ints.remove(i)); }
+    ints.rehashMilliseconds(100);
+    ints.shrink();
+    ints.rehashMilliseconds(50);
+    ASSERT_FALSE(ints.isRehashing()) << live;
+    ASSERT_EQ(ints.size(), live);
+    for (int i = 0; i < live; i++) { ASSERT_EQ(ints.get(i)->value, i); }
+    ASSERT_THAT(ints.get(live), nullptr);
+  }
+}
+
+TEST(swisstable, shrinknearlyfull) {
+  // Tombstones in a nearly full table: rebuilding without them would take
+  // a table twice as big, so shrink leaves it alone.
+  rd::SwissDict<int, int> ints;
+  for (int i = 0; i < 220; i++) { ints.add(i, i); }
+  ints.rehashMilliseconds(100);
+  rd::size_type capacity = ints.capacity();
+  ASSERT_EQ(capacity, 256);
+  for (int i = 210; i < 220; i++) { ASSERT_TRUE(ints.remove(i)); }
+  ints.shrink();
+  ints.rehashMilliseconds(50);
+  ASSERT_FALSE(ints.isRehashing());
+  ASSERT_EQ(ints.capacity(), capacity);
+  ASSERT_EQ(ints.size(), 210);
+  for (int i = 0; i < 210; i++) { ASSERT_EQ(ints.get(i)->value, i); }
+}
+
+TEST(swisstable, shrinkthenadd) {
+  // Inserts during a shrink fill the new table; the rehash still ends.
+  rd::SwissDict<int, int> ints;
+  for (int i = 0; i < 1000; i++) { ints.add(i, i); }
+  for (int i = 100; i < 1000; i++) { ASSERT_TRUE(ints.remove(i)); }
+  ints.rehashMilliseconds(100);
+  ints.shrink();
+  ASSERT_TRUE(ints.isRehashing());
+  for (int i = 1000; i < 1100; i++) { ints.add(i, i); }
+  ints.rehashMilliseconds(50);
+  ASSERT_FALSE(ints.isRehashing());
+  ASSERT_EQ(ints.size(), 200);
+  for (int i = 0; i < 100; i++) { ASSERT_EQ(ints.get(i)->value, i); }
+  for (int i = 1000; i < 1100; i++) { ASSERT_EQ(ints.get(i)->value, i); }
+}
+
+TEST(swisstable, scan) {
+  rd::SwissDict<int, int> ints;
+  for (int i = 0; i < 5000; i++) { ints.add(i, i); }
+  std::set<int> seen;
+  rd::size_type cursor = 0, calls = 0;
+  do {
+    cursor = ints.scan(cursor, [&](rd::SwissDict<int, int>::pointer slot) {
+      seen.insert(slot->key);
+    });
+    // Growing halfway through must not lose the keys present throughout.
+    if (++calls == 8) {
+      for (int i = 5000; i < 20000; i++) { ints.add(i, i); }
+    }
+  } while (cursor);
+  for (int i = 0; i < 5000; i++) { ASSERT_EQ(seen.count(i), 1); }
+}
+
+TEST(swisstable, stringkeys) {
+  rd::SwissDict<rd::String, int> strings;
+  for (int i = 0; i < 1000; i++) {
+    strings.add(rd::String(std::to_string(i).c_str()), i);
+  }
+  const char *buf = "123456";
+  ASSERT_EQ(strings.get(rd::StringView(buf, 3))->value, 123);
+  ASSERT_THAT(strings.get(rd::StringView("1000")), nullptr);
+  ASSERT_TRUE(strings.remove(rd::StringView("7")));
+  ASSERT_FALSE(strings.remove(rd::StringView("7")));
+  ASSERT_EQ(strings.size(), 999);
+}
+
+TEST(swisstable, engine) {
+  rd::DictOf<rd::DictEngine::kChained, int, int> chained;
+  rd::DictOf<rd::DictEngine::kSwiss, int, int> swiss;
+  static_assert(std::is_same_v<decltype(chained), rd::Dict<int, int>>);
+  static_assert(std::is_same_v<decltype(swiss), rd::SwissDict<int, int>>);
+  for (int i = 0; i < 100; i++) {
+    chained.add(i, i);
+    swiss.add(i, i);
+  }
+  ASSERT_EQ(chained.get(42)->value, swiss.get(42)->value);
+}
@@ -0,0 +1,62 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <climits>
+#include <set>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+namespace {
+bool parse(const char *s, long long *value) {
+  return rd::string2ll(s, strlen(s), value);
+}
+}
+
+TEST(util, string2ll) {
+  long long value;
+  ASSERT_TRUE(parse("0", &value));
+  ASSERT_EQ(value, 0);
+  ASSERT_TRUE(parse("12345", &value));
+  ASSERT_EQ(value, 12345);
+  ASSERT_TRUE(parse("-1", &value));
+  ASSERT_EQ(value, -1);
+  ASSERT_TRUE(parse("9223372036854775807", &value));
+  ASSERT_EQ(value, LLONG_MAX);
+  ASSERT_TRUE(parse("-9223372036854775808", &value));
+  ASSERT_EQ(value, LLONG_MIN);
+  for (const char *bad : {"", "-", "-0", "007", "+1", " 1", "1 ", "1a",
+                          "9223372036854775808", "-9223372036854775809",
+                          "99999999999999999999"}) {
+    ASSERT_FALSE(parse(bad, &value)) << bad;
+  }
+}
+
+TEST(util, ll2string) {
+  char buf[rd::kLongStrSize];
+  for (long long v : {0LL, 7LL, 10LL, 99LL, 100LL, 12345LL, -1LL, -100LL,
+                      LLONG_MAX, LLONG_MIN}) {
+    size_t len = rd::ll2string(buf, sizeof(buf), v);
+    ASSERT_STREQ(buf, std::to_string(v).c_str());
+    ASSERT_EQ(len, strlen(buf));
+    long long back;
+    ASSERT_TRUE(rd::string2ll(buf, len, &back));
+    ASSERT_EQ(back, v);
+  }
+  ASSERT_EQ(rd::ll2string(buf, 3, 12345), 0);
+  ASSERT_EQ(rd::ll2string(buf, 4, -123), 0);
+  ASSERT_EQ(rd::ll2string(buf, 5, -123), 4);
+}
+
+TEST(util, random64) {
+  std::set<uint64_t> values;
+  uint64_t ones = 0;
+  for (int i = 0; i < 1000; i++) {
+    uint64_t v = rd::random64();
+    values.insert(v);
+    ones += __builtin_popcountll(v);
+  }
+  ASSERT_EQ(values.size(), 1000);
+  // About half of the 64000 bits are set.
+  ASSERT_NEAR(static_cast<double>(ones), 32000, 1000);
+}
@@ -0,0 +1,53 @@
+//
+// Created by suun on 10/18/26.
+//
+
+#include <string>
+#include <gmock/gmock.h>
+#include "redis.h"
+
+TEST(zmalloc, string) {
+  size_t base = rd::usedMemory();
+  std::string text(1000, 'x');
+  {
+    rd::String s(text.data(), text.size());
+    ASSERT_GE(rd::usedMemory(), base + 1000);
+    s.reserve(3000);
+    ASSERT_GE(rd::usedMemory(), base + 3000);
+  }
+  ASSERT_EQ(rd::usedMemory(), base);
+  {
+    // Inline strings take no heap at all.
+    rd::String s("short");
+    ASSERT_EQ(rd::usedMemory(), base);
+  }
+}
+
+TEST(zmalloc, containers) {
+  size_t base = rd::usedMemory();
+  {
+    rd::List<int> list;
+    for (int i = 0; i < 100; i++) { list.pushBack(i); }
+    ASSERT_GE(rd::usedMemory(), base + 100 * sizeof(rd::_ListNode<int>));
+  }
+  ASSERT_EQ(rd::usedMemory(), base);
+  {
+    rd::SkipList list;
+    for (int i = 0; i < 100; i++) {
+      list.insert(rd::String(std::to_string(i).c_str()), i);
+    }
+    ASSERT_GE(rd::usedMemory(), base + 100 * sizeof(rd::_SkipListNode));
+  }
+  ASSERT_EQ(rd::usedMemory(), base);
+  {
+    rd::Dict<int, int> dict;
+    for (int i = 0; i < 1000; i++) { dict.add(i, i); }
+    ASSERT_GE(rd::usedMemory(),
+              base + 1000 * sizeof(rd::Dict<int, int>::entry_type));
+    std::string text(100, 'v');
+    rd::Object *obj =
+        rd::Object::createString(rd::String(text.data(), text.size()));
+    obj->decrRef();
+  }
+  ASSERT_EQ(rd::usedMemory(), base);
+}